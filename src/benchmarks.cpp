@@ -1,11 +1,14 @@
 // benchmarks.cpp
 #include <benchmark/benchmark.h>
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <random>
 #include "type/value.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/buffer/buffer_pool_manager.h"
+#include "storage/buffer/buffer_access_strategy.h"
+#include "storage/buffer/two_queue_replacer.h"
 
 using namespace tetodb;
 
@@ -52,8 +55,8 @@ public:
         if (std::filesystem::exists(db_path_)) std::filesystem::remove(db_path_);
         std::filesystem::path fl = db_path_; fl.replace_extension(".freelist");
         if (std::filesystem::exists(fl)) std::filesystem::remove(fl);
-        std::filesystem::path log = db_path_; log.replace_extension(".log");
-        if (std::filesystem::exists(log)) std::filesystem::remove(log);
+        std::filesystem::path log = db_path_; log.replace_extension(".wal");
+        std::filesystem::remove_all(log);
     }
 
     std::filesystem::path db_path_;
@@ -78,10 +81,12 @@ BENCHMARK_F(DiskManagerFixture, BM_DiskManagerSequentialWrite)(benchmark::State&
 class BPMFixture : public benchmark::Fixture {
 public:
     void SetUp(const ::benchmark::State& state) {
+        // Multi-threaded runs share one pool; only thread 0 builds it.
+        if (state.thread_index() != 0) return;
         db_path_ = "bm_bpm.db";
         Cleanup();
         dm_ = std::make_unique<DiskManager>(db_path_);
-        replacer_ = std::make_unique<TwoQueueReplacer>(POOL_SIZE);
+        replacer_ = MakeReplacer(Policy(), POOL_SIZE);
         bpm_ = std::make_unique<BufferPoolManager>(POOL_SIZE, dm_.get(), replacer_.get());
         
         // Pre-allocate pages
@@ -93,6 +98,7 @@ public:
     }
 
     void TearDown(const ::benchmark::State& state) {
+        if (state.thread_index() != 0) return;
         bpm_ = nullptr;
         replacer_ = nullptr;
         dm_ = nullptr;
@@ -103,43 +109,83 @@ public:
         if (std::filesystem::exists(db_path_)) std::filesystem::remove(db_path_);
         std::filesystem::path fl = db_path_; fl.replace_extension(".freelist");
         if (std::filesystem::exists(fl)) std::filesystem::remove(fl);
-        std::filesystem::path log = db_path_; log.replace_extension(".log");
-        if (std::filesystem::exists(log)) std::filesystem::remove(log);
+        std::filesystem::path log = db_path_; log.replace_extension(".wal");
+        std::filesystem::remove_all(log);
     }
 
+    // Fetch and unpin the same POOL_SIZE pages over and over
+    void CacheHit100(benchmark::State& state) {
+        // Load first 100 pages into cache
+        for(size_t i = 0; i < POOL_SIZE; i++) {
+            bpm_->FetchPage(i);
+            bpm_->UnpinPage(i, false);
+        }
+
+        // Now just fetch and unpin the exact same pages over and over
+        for (auto _ : state) {
+            for(size_t i = 0; i < POOL_SIZE; i++) {
+                Page* p = bpm_->FetchPage(i);
+                benchmark::DoNotOptimize(p);
+                bpm_->UnpinPage(i, false);
+            }
+        }
+    }
+
+    // Uniform random fetches over NUM_PAGES, mostly misses
+    void RandomAccess(benchmark::State& state) {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_int_distribution<> distr(0, NUM_PAGES - 1);
+
+        for (auto _ : state) {
+            page_id_t pid = distr(gen);
+            Page* p = bpm_->FetchPage(pid);
+            benchmark::DoNotOptimize(p);
+            if (p != nullptr) {
+                bpm_->UnpinPage(pid, false);
+            }
+        }
+    }
+
+    virtual ReplacerPolicy Policy() const { return ReplacerPolicy::TWO_QUEUE; }
+
     std::filesystem::path db_path_;
     std::unique_ptr<DiskManager> dm_;
-    std::unique_ptr<TwoQueueReplacer> replacer_;
+    std::unique_ptr<Replacer> replacer_;
     std::unique_ptr<BufferPoolManager> bpm_;
     
     const size_t POOL_SIZE = 100;
     const size_t NUM_PAGES = 1000;
 };
 
+// Same pool driven by the array-based CLOCK replacer instead of 2Q
+class BPMClockFixture : public BPMFixture {
+public:
+    ReplacerPolicy Policy() const override { return ReplacerPolicy::CLOCK; }
+};
+
 // Benchmark 100% Cache Hits
 BENCHMARK_F(BPMFixture, BM_BPM_CacheHit100)(benchmark::State& state) {
-    // Load first 100 pages into cache
-    for(size_t i = 0; i < POOL_SIZE; i++) {
-        Page* p = bpm_->FetchPage(i);
-        bpm_->UnpinPage(i, false);
-    }
-    
-    // Now just fetch and unpin the exact same pages over and over
-    for (auto _ : state) {
-        for(size_t i = 0; i < POOL_SIZE; i++) {
-            Page* p = bpm_->FetchPage(i);
-            benchmark::DoNotOptimize(p);
-            bpm_->UnpinPage(i, false);
-        }
-    }
+    CacheHit100(state);
+}
+BENCHMARK_F(BPMClockFixture, BM_BPM_CacheHit100_Clock)(benchmark::State& state) {
+    CacheHit100(state);
 }
 
 // Benchmark Cache Misses with random eviction
 BENCHMARK_F(BPMFixture, BM_BPM_RandomAccess)(benchmark::State& state) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    RandomAccess(state);
+}
+BENCHMARK_F(BPMClockFixture, BM_BPM_RandomAccess_Clock)(benchmark::State& state) {
+    RandomAccess(state);
+}
+
+// Same miss-heavy workload, but from several sessions at once. With the
+// pread/pwrite backend, misses no longer queue behind a single file offset.
+BENCHMARK_DEFINE_F(BPMFixture, BM_BPM_RandomAccessMT)(benchmark::State& state) {
+    std::mt19937 gen(static_cast<uint32_t>(state.thread_index()) * 7919u + 1u);
     std::uniform_int_distribution<> distr(0, NUM_PAGES - 1);
-    
+
     for (auto _ : state) {
         page_id_t pid = distr(gen);
         Page* p = bpm_->FetchPage(pid);
@@ -149,6 +195,193 @@ BENCHMARK_F(BPMFixture, BM_BPM_RandomAccess)(benchmark::State& state) {
         }
     }
 }
+BENCHMARK_REGISTER_F(BPMFixture, BM_BPM_RandomAccessMT)->ThreadRange(1, 8)->UseRealTime();
+
+// Cache-hit scaling across sessions. Arg = number of pool partitions; with
+// one partition every fetch/unpin meets on the same latch.
+static std::unique_ptr<DiskManager> scaling_dm;
+static std::unique_ptr<BufferPoolManager> scaling_bpm;
+static const size_t SCALING_PAGES = 2048;
+
+static void BM_BPM_PartitionScaling(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        std::filesystem::remove("bm_bpm_scaling.db");
+        scaling_dm = std::make_unique<DiskManager>("bm_bpm_scaling.db");
+        scaling_bpm = std::make_unique<BufferPoolManager>(
+            SCALING_PAGES * 2, scaling_dm.get(), static_cast<size_t>(state.range(0)));
+        for (size_t i = 0; i < SCALING_PAGES; i++) {
+            page_id_t pid;
+            scaling_bpm->NewPage(&pid);
+            scaling_bpm->UnpinPage(pid, false);
+        }
+    }
+
+    std::mt19937 gen(static_cast<uint32_t>(state.thread_index()) + 17u);
+    std::uniform_int_distribution<> distr(0, SCALING_PAGES - 1);
+    for (auto _ : state) {
+        page_id_t pid = distr(gen);
+        Page* p = scaling_bpm->FetchPage(pid);
+        benchmark::DoNotOptimize(p);
+        scaling_bpm->UnpinPage(pid, false);
+    }
+
+    if (state.thread_index() == 0) {
+        scaling_bpm = nullptr;
+        scaling_dm = nullptr;
+        std::filesystem::remove("bm_bpm_scaling.db");
+        std::filesystem::remove_all("bm_bpm_scaling.wal");
+    }
+}
+BENCHMARK(BM_BPM_PartitionScaling)->Arg(1)->Arg(16)->ThreadRange(1, 16)->UseRealTime();
+
+// Write back a fully dirty pool. Arg 0 = one pwrite per page, Arg 1 = the
+// io_uring engine, which submits the whole pool as one batch.
+static void BM_BPM_FlushAllDirty(benchmark::State& state) {
+    const size_t pool_size = 256;
+    std::filesystem::path db_path = "bm_bpm_flush.db";
+    DiskOptions options;
+    options.io_engine = state.range(0) == 1 ? IoEngine::IO_URING : IoEngine::SYNC;
+
+    {
+        DiskManager dm(db_path, options);
+        TwoQueueReplacer replacer(pool_size);
+        BufferPoolManager bpm(pool_size, &dm, &replacer);
+
+        std::vector<page_id_t> pids;
+        for (size_t i = 0; i < pool_size; i++) {
+            page_id_t pid;
+            bpm.NewPage(&pid);
+            bpm.UnpinPage(pid, true);
+            pids.push_back(pid);
+        }
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            for (page_id_t pid : pids) {
+                bpm.FetchPage(pid);
+                bpm.UnpinPage(pid, true);
+            }
+            state.ResumeTiming();
+            bpm.FlushAllPages();
+        }
+        state.SetBytesProcessed(int64_t(state.iterations()) * pool_size * PAGE_SIZE);
+        state.SetLabel(dm.GetIoEngine() == IoEngine::IO_URING ? "io_uring" : "sync");
+    }
+
+    std::filesystem::remove(db_path);
+    std::filesystem::path log = db_path; log.replace_extension(".wal");
+    std::filesystem::remove_all(log);
+}
+BENCHMARK(BM_BPM_FlushAllDirty)->Arg(0)->Arg(1);
+
+// Walk a chain of 1024 pages through a cold pool, the way a heap scan does.
+// O_DIRECT keeps the OS page cache out of it. Arg 0 = plain FetchPage,
+// Arg 1 = with the ReadAhead hint, so later pages load behind the scan.
+static void BM_BPM_ColdSequentialScan(benchmark::State& state) {
+    const size_t num_pages = 1024;
+    std::filesystem::path db_path = "bm_bpm_scan.db";
+    DiskOptions options;
+    options.io_engine = IoEngine::IO_URING;
+    options.direct_io = true;
+
+    {
+        DiskManager dm(db_path, options);
+        {
+            BufferPoolManager bpm(num_pages, &dm, static_cast<size_t>(1));
+            for (size_t i = 0; i < num_pages; i++) {
+                page_id_t pid;
+                bpm.NewPage(&pid);
+                bpm.UnpinPage(pid, true);
+            }
+            bpm.FlushAllPages();
+        }
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            BufferPoolManager bpm(num_pages / 4, &dm, static_cast<size_t>(1));
+            ReadAheadState read_ahead;
+            state.ResumeTiming();
+
+            for (page_id_t pid = 0; pid < static_cast<page_id_t>(num_pages); pid++) {
+                if (state.range(0) == 1) {
+                    bpm.ReadAhead(&read_ahead, pid);
+                }
+                Page* page = bpm.FetchPage(pid);
+                benchmark::DoNotOptimize(page->GetData()[0]);
+                bpm.UnpinPage(pid, false);
+            }
+        }
+        state.SetBytesProcessed(int64_t(state.iterations()) * num_pages * PAGE_SIZE);
+        state.SetLabel(state.range(0) == 1 ? "read-ahead" : "no read-ahead");
+    }
+
+    std::filesystem::remove(db_path);
+    std::filesystem::path log = db_path; log.replace_extension(".wal");
+    std::filesystem::remove_all(log);
+}
+BENCHMARK(BM_BPM_ColdSequentialScan)->Arg(0)->Arg(1);
+
+// Point lookups on a hot set while a full scan sweeps a table 16x the
+// pool. The two are interleaved (one lookup per scanned page) so that every
+// lookup miss can be attributed. Arg 0 = plain scan, Arg 1 = BULK_READ ring.
+// hit_ratio is for the lookups only.
+static void BM_BPM_HitRatioUnderScan(benchmark::State& state) {
+    const size_t pool_size = 256;
+    const size_t hot_pages = pool_size / 2;
+    const size_t table_pages = pool_size * 16;
+    std::filesystem::path db_path = "bm_bpm_ring.db";
+
+    {
+        DiskManager dm(db_path);
+        BufferPoolManager bpm(pool_size, &dm, static_cast<size_t>(1));
+        for (size_t i = 0; i < table_pages; i++) {
+            page_id_t pid;
+            bpm.NewPage(&pid);
+            bpm.UnpinPage(pid, true);
+        }
+        for (int round = 0; round < 2; round++) {
+            for (page_id_t pid = 0; pid < static_cast<page_id_t>(hot_pages); pid++) {
+                bpm.FetchPage(pid);
+                bpm.UnpinPage(pid, false);
+            }
+        }
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<page_id_t> pick(0, static_cast<page_id_t>(hot_pages) - 1);
+        auto strategy = std::make_unique<BufferAccessStrategy>(&bpm, AccessStrategyType::BULK_READ);
+        page_id_t scan_pos = static_cast<page_id_t>(hot_pages);
+        uint64_t lookups = 0, misses = 0;
+
+        for (auto _ : state) {
+            page_id_t pid = pick(rng);
+            uint64_t before = bpm.GetStats().fetch_misses;
+            bpm.FetchPage(pid);
+            bpm.UnpinPage(pid, false);
+            misses += bpm.GetStats().fetch_misses - before;
+            lookups++;
+
+            // Twice per page, as SeqScanExecutor does (iterator, then GetTuple)
+            BufferAccessStrategy* scan = state.range(0) == 1 ? strategy.get() : nullptr;
+            for (int twice = 0; twice < 2; twice++) {
+                bpm.FetchPage(scan_pos, scan);
+                bpm.UnpinPage(scan_pos, false);
+            }
+            if (++scan_pos == static_cast<page_id_t>(table_pages)) {
+                scan_pos = static_cast<page_id_t>(hot_pages);
+                strategy = std::make_unique<BufferAccessStrategy>(&bpm, AccessStrategyType::BULK_READ);
+            }
+        }
+        strategy.reset();
+
+        state.counters["hit_ratio"] = lookups == 0 ? 0.0 : 1.0 - double(misses) / double(lookups);
+        state.SetLabel(state.range(0) == 1 ? "ring" : "shared pool");
+    }
+
+    std::filesystem::remove(db_path);
+    std::filesystem::path log = db_path; log.replace_extension(".wal");
+    std::filesystem::remove_all(log);
+}
+BENCHMARK(BM_BPM_HitRatioUnderScan)->Arg(0)->Arg(1);
 
 #include "index/generic_key.h"
 #include "common/record_id.h"
@@ -164,10 +397,13 @@ typedef GenericComparator<4> KeyComparator;
 }
 
 #include "index/b_plus_tree.h"
+#include "index/b_plus_tree_index.h"
 
 class BPlusTreeFixture : public benchmark::Fixture {
 public:
     void SetUp(const ::benchmark::State& state) {
+        // Multi-threaded runs share one tree; only thread 0 builds it.
+        if (state.thread_index() != 0) return;
         db_path_ = "bm_bpt.db";
         Cleanup();
         dm_ = std::make_unique<tetodb::DiskManager>(db_path_);
@@ -191,6 +427,7 @@ public:
     }
 
     void TearDown(const ::benchmark::State& state) {
+        if (state.thread_index() != 0) return;
         tree_ = nullptr;
         bpm_ = nullptr;
         replacer_ = nullptr;
@@ -202,8 +439,8 @@ public:
         if (std::filesystem::exists(db_path_)) std::filesystem::remove(db_path_);
         std::filesystem::path fl = db_path_; fl.replace_extension(".freelist");
         if (std::filesystem::exists(fl)) std::filesystem::remove(fl);
-        std::filesystem::path log = db_path_; log.replace_extension(".log");
-        if (std::filesystem::exists(log)) std::filesystem::remove(log);
+        std::filesystem::path log = db_path_; log.replace_extension(".wal");
+        std::filesystem::remove_all(log);
     }
 
     std::filesystem::path db_path_;
@@ -231,6 +468,140 @@ BENCHMARK_F(BPlusTreeFixture, BM_BTree_RandomLookups)(benchmark::State& state) {
     }
 }
 
+// Same lookups from several sessions at once. Inner nodes are read under
+// page version checks, so readers never write to the shared root latch.
+BENCHMARK_DEFINE_F(BPlusTreeFixture, BM_BTree_RandomLookupsMT)(benchmark::State& state) {
+    std::mt19937 gen(static_cast<uint32_t>(state.thread_index()) * 7919u + 1u);
+    std::uniform_int_distribution<> distr(0, 999);
+
+    for (auto _ : state) {
+        tetodb::KeyType k;
+        k.SetFromValue(tetodb::Value(tetodb::TypeId::INTEGER, distr(gen)));
+        std::vector<tetodb::ValueType> result;
+        tree_->GetValue(k, &result, nullptr);
+
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK_REGISTER_F(BPlusTreeFixture, BM_BTree_RandomLookupsMT)->ThreadRange(1, 8)->UseRealTime();
+
+// Index size after delete/update churn: 50k keys, then 9 in 10 deleted in
+// random order while the survivors are re-inserted under new RIDs (what an
+// UPDATE does to an index). Deletes merge and refill nodes, so the tree
+// shrinks with its entries and Compact() (REINDEX) finds little left to do.
+// Timed: the churn.
+static void BM_BTree_SizeAfterChurn(benchmark::State& state) {
+    using Tree = tetodb::BPlusTree<tetodb::KeyType, tetodb::ValueType, tetodb::KeyComparator>;
+    const int32_t num_keys = 50000;
+    std::filesystem::path db_path = "bm_bpt_churn.db";
+
+    auto make_key = [](int32_t v) {
+        tetodb::KeyType k;
+        k.SetFromValue(tetodb::Value(tetodb::TypeId::INTEGER, v));
+        return k;
+    };
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto dm = std::make_unique<tetodb::DiskManager>(db_path);
+        auto bpm = std::make_unique<tetodb::BufferPoolManager>(1024, dm.get(), static_cast<size_t>(1));
+        Tree tree("bm_churn_index", bpm.get(), tetodb::KeyComparator(tetodb::TypeId::INTEGER),
+                  Tree::DefaultLeafMaxSize(), Tree::DefaultInternalMaxSize());
+
+        tetodb::Transaction txn(0);
+        std::vector<int32_t> order(num_keys);
+        for (int32_t i = 0; i < num_keys; i++) {
+            order[i] = i;
+            tree.Insert(make_key(i), tetodb::RID(i, 0), &txn);
+        }
+        uint32_t full_pages = tree.GetPageCount();
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+        state.ResumeTiming();
+
+        for (int32_t k : order) {
+            tree.Remove(make_key(k), tetodb::RID(k, 0), &txn);
+            if (k % 10 == 0) {
+                tree.Insert(make_key(k), tetodb::RID(k, 1), &txn);
+            }
+        }
+
+        state.PauseTiming();
+        uint32_t churned_pages = tree.GetPageCount();
+        tree.Compact(&txn);
+        state.counters["pages_full"] = full_pages;
+        state.counters["pages_after_churn"] = churned_pages;
+        state.counters["pages_after_compact"] = tree.GetPageCount();
+        tree.Destroy();
+        bpm = nullptr;
+        dm = nullptr;
+        std::filesystem::remove(db_path);
+        std::filesystem::path log = db_path; log.replace_extension(".wal");
+        std::filesystem::remove_all(log);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_BTree_SizeAfterChurn)->Unit(benchmark::kMillisecond)->Iterations(3);
+
+// Building an index over 200k rows in scrambled order: Arg 0 inserts them
+// one by one (CREATE INDEX before bulk builds), Arg 1 bulk-loads them at
+// the default fill factor, sort included. Counters: pages in the result.
+static void BM_BTree_BuildIndex(benchmark::State& state) {
+    using Index = tetodb::BPlusTreeIndex<tetodb::KeyType, tetodb::ValueType, tetodb::KeyComparator>;
+    using Tree = tetodb::BPlusTree<tetodb::KeyType, tetodb::ValueType, tetodb::KeyComparator>;
+    const bool bulk = state.range(0) != 0;
+    const int32_t num_rows = 200000;
+    std::filesystem::path db_path = "bm_bpt_build.db";
+    std::vector<tetodb::Column> cols = {tetodb::Column("key", tetodb::TypeId::INTEGER)};
+    tetodb::Schema key_schema(cols);
+
+    std::vector<int32_t> rows(num_rows);
+    for (int32_t i = 0; i < num_rows; i++) rows[i] = i;
+    std::shuffle(rows.begin(), rows.end(), std::mt19937(42));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto dm = std::make_unique<tetodb::DiskManager>(db_path);
+        auto bpm = std::make_unique<tetodb::BufferPoolManager>(4096, dm.get(), static_cast<size_t>(1));
+        Index index("bm_build_index", bpm.get(), tetodb::KeyComparator(tetodb::TypeId::INTEGER),
+                    Tree::DefaultLeafMaxSize(), Tree::DefaultInternalMaxSize(),
+                    std::make_unique<tetodb::Schema>(cols));
+        tetodb::Transaction txn(INVALID_TRANSACTION_ID);
+        state.ResumeTiming();
+
+        if (bulk) {
+            size_t next = 0;
+            index.BulkLoad(
+                [&](tetodb::Tuple* key_tuple, tetodb::RID* rid) {
+                    if (next == rows.size()) return false;
+                    int32_t row = rows[next++];
+                    *key_tuple = tetodb::Tuple({tetodb::Value(tetodb::TypeId::INTEGER, row)}, &key_schema);
+                    *rid = tetodb::RID(row, 0);
+                    return true;
+                },
+                90, 16 * 1024 * 1024, &txn);
+        } else {
+            for (int32_t row : rows) {
+                index.InsertEntry(tetodb::Tuple({tetodb::Value(tetodb::TypeId::INTEGER, row)}, &key_schema),
+                                  tetodb::RID(row, 0), &txn);
+            }
+        }
+
+        state.PauseTiming();
+        // Walk the tree the index built over the same buffer pool
+        Tree tree("bm_build_index", bpm.get(), tetodb::KeyComparator(tetodb::TypeId::INTEGER),
+                  Tree::DefaultLeafMaxSize(), Tree::DefaultInternalMaxSize(), index.GetRootPageId());
+        state.counters["pages"] = tree.GetPageCount();
+        index.Destroy();
+        bpm = nullptr;
+        dm = nullptr;
+        std::filesystem::remove(db_path);
+        std::filesystem::path log = db_path; log.replace_extension(".wal");
+        std::filesystem::remove_all(log);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_BTree_BuildIndex)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->Iterations(3);
+
 // ==========================================
 // 5. Join Executor Stress Benchmarks
 // ==========================================
@@ -267,3 +638,231 @@ static void BM_HashJoin_CorePressure(benchmark::State& state) {
     }
 }
 BENCHMARK(BM_HashJoin_CorePressure);
+
+// ==========================================
+// 6. Commit Benchmarks
+// ==========================================
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "recovery/log_manager.h"
+
+// Commit throughput across sessions: each iteration is a one-row
+// transaction (one INSERT record plus its COMMIT). Commits that wait on the
+// log together share its writes.
+static std::unique_ptr<DiskManager> commit_dm;
+static std::unique_ptr<LogManager> commit_log_mgr;
+static std::unique_ptr<LockManager> commit_lock_mgr;
+static std::unique_ptr<TransactionManager> commit_txn_mgr;
+
+static void BM_Log_CommitThroughput(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        std::filesystem::remove("bm_commit.db");
+        std::filesystem::remove_all("bm_commit.wal");
+        commit_dm = std::make_unique<DiskManager>("bm_commit.db");
+        commit_log_mgr = std::make_unique<LogManager>(commit_dm.get());
+        commit_log_mgr->RunFlushThread();
+        commit_lock_mgr = std::make_unique<LockManager>();
+        commit_txn_mgr = std::make_unique<TransactionManager>(commit_lock_mgr.get(), commit_log_mgr.get());
+    }
+
+    std::vector<Column> cols = {Column("A", TypeId::INTEGER)};
+    Schema schema(cols);
+    Tuple tuple({Value(TypeId::INTEGER, state.thread_index())}, &schema);
+    for (auto _ : state) {
+        Transaction* txn = commit_txn_mgr->Begin();
+        LogRecord insert_log(txn->GetTransactionId(), txn->GetPrevLSN(),
+                             LogRecordType::INSERT, RID(0, 0), tuple);
+        txn->SetPrevLSN(commit_log_mgr->AppendLogRecord(&insert_log));
+        commit_txn_mgr->Commit(txn);
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        commit_txn_mgr = nullptr;
+        commit_lock_mgr = nullptr;
+        commit_log_mgr = nullptr;
+        commit_dm = nullptr;
+        std::filesystem::remove("bm_commit.db");
+        std::filesystem::remove_all("bm_commit.wal");
+    }
+}
+BENCHMARK(BM_Log_CommitThroughput)->ThreadRange(1, 64)->UseRealTime();
+
+// Raw append throughput: each iteration appends one INSERT record, with no
+// commit to wait for. Appenders only meet on the reservation word.
+static void BM_Log_AppendThroughput(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        std::filesystem::remove("bm_append.db");
+        std::filesystem::remove_all("bm_append.wal");
+        commit_dm = std::make_unique<DiskManager>("bm_append.db");
+        commit_log_mgr = std::make_unique<LogManager>(commit_dm.get());
+        commit_log_mgr->RunFlushThread();
+    }
+
+    std::vector<Column> cols = {Column("A", TypeId::INTEGER), Column("B", TypeId::VARCHAR, 64)};
+    Schema schema(cols);
+    Tuple tuple({Value(TypeId::INTEGER, state.thread_index()), Value(TypeId::VARCHAR, std::string(48, 'x'))}, &schema);
+    lsn_t prev_lsn = INVALID_LSN;
+    for (auto _ : state) {
+        LogRecord insert_log(state.thread_index() + 1, prev_lsn, LogRecordType::INSERT, RID(0, 0), tuple);
+        prev_lsn = commit_log_mgr->AppendLogRecord(&insert_log);
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        commit_log_mgr = nullptr;
+        commit_dm = nullptr;
+        std::filesystem::remove("bm_append.db");
+        std::filesystem::remove_all("bm_append.wal");
+    }
+}
+BENCHMARK(BM_Log_AppendThroughput)->ThreadRange(1, 16)->UseRealTime();
+
+// WAL bytes per transaction for a one-column update of a wide row (an
+// INTEGER counter next to a 200-byte VARCHAR). Args: compressed log,
+// synchronous commit. Compression only pays off once a flush carries many
+// transactions, as it does with asynchronous commits.
+// full_image_bytes_per_txn is what logging both tuple images would take.
+#include "storage/table/table_heap.h"
+
+static void BM_Log_UpdateBytesPerTxn(benchmark::State& state) {
+    std::filesystem::remove("bm_delta.db");
+    std::filesystem::remove_all("bm_delta.wal");
+    {
+        DiskManager dm("bm_delta.db");
+        BufferPoolManager bpm(256, &dm, static_cast<size_t>(1));
+        LogManager log_mgr(&dm, LOG_BUFFER_SIZE, state.range(0) != 0);
+        log_mgr.RunFlushThread();
+        bpm.SetLogManager(&log_mgr);
+        LockManager lock_mgr;
+        TransactionManager txn_mgr(&lock_mgr, &log_mgr);
+        TableHeap heap(&bpm, &log_mgr, nullptr);
+
+        std::vector<Column> cols = {Column("A", TypeId::INTEGER), Column("B", TypeId::VARCHAR, 256)};
+        Schema schema(cols);
+        const std::string payload(200, 'x');
+        constexpr int32_t kRows = 1000;
+        std::vector<RID> rids(kRows);
+        for (int32_t i = 0; i < kRows; i++) {
+            heap.InsertTuple(Tuple({Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, payload)}, &schema), &rids[i]);
+        }
+
+        log_mgr.Flush();
+        uint64_t written_before = log_mgr.GetBytesWritten();
+        uint64_t full_image_bytes = 0;
+        int32_t counter = 0;
+        for (auto _ : state) {
+            int32_t row = counter % kRows;
+            Tuple old_tuple({Value(TypeId::INTEGER, row + (counter / kRows) * kRows), Value(TypeId::VARCHAR, payload)}, &schema);
+            Tuple new_tuple({Value(TypeId::INTEGER, row + (counter / kRows + 1) * kRows), Value(TypeId::VARCHAR, payload)}, &schema);
+            counter++;
+
+            Transaction* txn = txn_mgr.Begin();
+            txn->SetSynchronousCommit(state.range(1) != 0);
+            RID rid = rids[row];
+            heap.UpdateTuple(new_tuple, &rid, txn);
+            txn_mgr.Commit(txn);
+            full_image_bytes += LogRecord::CalculateSize(LogRecordType::UPDATE, old_tuple, new_tuple) +
+                2 * LogRecord::CalculateSize(LogRecordType::BEGIN, Tuple(), Tuple());
+        }
+        log_mgr.Flush();
+
+        double txns = static_cast<double>(state.iterations());
+        state.counters["wal_bytes_per_txn"] = (log_mgr.GetBytesWritten() - written_before) / txns;
+        state.counters["full_image_bytes_per_txn"] = full_image_bytes / txns;
+        log_mgr.StopFlushThread();
+    }
+    std::filesystem::remove("bm_delta.db");
+    std::filesystem::remove_all("bm_delta.wal");
+}
+BENCHMARK(BM_Log_UpdateBytesPerTxn)->Args({0, 1})->Args({0, 0})->Args({1, 0})->Iterations(20000);
+
+// ==========================================
+// 7. Recovery Benchmarks
+// ==========================================
+#include "recovery/recovery_manager.h"
+
+// Crashed databases built so far; deleted at exit
+static struct CrashedDatabases {
+    std::vector<std::string> names;
+    ~CrashedDatabases() {
+        for (const auto& name : names) {
+            std::filesystem::remove(name + ".db");
+            std::filesystem::remove_all(name + ".wal");
+        }
+    }
+} crashed_databases;
+
+// Builds a crashed database once per size: `rows` committed inserts plus an
+// update of every other row, all in the log and none on the data pages
+static void BuildCrashedDatabase(int64_t rows, const std::string& name) {
+    std::filesystem::remove(name + ".db");
+    std::filesystem::remove_all(name + ".wal");
+    DiskManager dm(name + ".db");
+    BufferPoolManager bpm(static_cast<size_t>(rows / 40 + 64), &dm, static_cast<size_t>(1));
+    LogManager log_mgr(&dm);
+    log_mgr.RunFlushThread();
+    bpm.SetLogManager(&log_mgr);
+    LockManager lock_mgr;
+    TransactionManager txn_mgr(&lock_mgr, &log_mgr);
+    TableHeap heap(&bpm, &log_mgr, nullptr);
+
+    std::vector<Column> cols = {Column("A", TypeId::INTEGER), Column("B", TypeId::VARCHAR, 64)};
+    Schema schema(cols);
+    std::vector<RID> rids(rows);
+    Transaction* txn = txn_mgr.Begin();
+    for (int64_t i = 0; i < rows; i++) {
+        heap.InsertTuple(Tuple({Value(TypeId::INTEGER, static_cast<int32_t>(i)), Value(TypeId::VARCHAR, std::string(40, 'r'))}, &schema), &rids[i], txn);
+    }
+    for (int64_t i = 0; i < rows; i += 2) {
+        RID rid = rids[i];
+        heap.UpdateTuple(Tuple({Value(TypeId::INTEGER, static_cast<int32_t>(-i)), Value(TypeId::VARCHAR, std::string(40, 'u'))}, &schema), &rid, txn);
+    }
+    txn_mgr.Commit(txn);
+    log_mgr.StopFlushThread(); // Crash: pages are never written
+}
+
+// Time to replay the log after a crash. Args: rows in the log, redo threads
+static void BM_Recovery_Redo(benchmark::State& state) {
+    int64_t rows = state.range(0);
+    std::string source = "bm_recovery_" + std::to_string(rows);
+    if (!std::filesystem::exists(source + ".db")) {
+        BuildCrashedDatabase(rows, source);
+        crashed_databases.names.push_back(source);
+    }
+
+    uint64_t log_bytes = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(source + ".wal")) {
+        log_bytes += entry.file_size();
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::filesystem::remove("bm_recovery_run.db");
+        std::filesystem::remove_all("bm_recovery_run.wal");
+        std::filesystem::copy_file(source + ".db", "bm_recovery_run.db");
+        std::filesystem::copy(source + ".wal", "bm_recovery_run.wal");
+        {
+            DiskManager dm("bm_recovery_run.db");
+            BufferPoolManager bpm(256, &dm, static_cast<size_t>(1));
+            LogManager log_mgr(&dm);
+            bpm.SetLogManager(&log_mgr);
+            RecoveryManager recovery(&dm, &bpm, &log_mgr, static_cast<size_t>(state.range(1)));
+            state.ResumeTiming();
+
+            recovery.Redo();
+
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+    state.counters["log_MB"] = log_bytes / (1024.0 * 1024.0);
+    state.SetBytesProcessed(static_cast<int64_t>(log_bytes) * state.iterations());
+
+    std::filesystem::remove("bm_recovery_run.db");
+    std::filesystem::remove_all("bm_recovery_run.wal");
+}
+BENCHMARK(BM_Recovery_Redo)
+    ->ArgsProduct({{20000, 200000}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
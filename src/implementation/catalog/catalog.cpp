@@ -5,6 +5,7 @@
 
 #include "catalog/catalog.h"
 #include "common/config.h"
+#include "storage/buffer/buffer_access_strategy.h"
 
 namespace tetodb {
 
@@ -141,89 +142,80 @@ IndexMetadata *Catalog::CreateIndex(const std::string &index_name,
 
   auto key_schema = std::make_unique<Schema>(key_cols);
 
+  if (key_schema->GetColumnCount() > MAX_KEY_COLUMNS) {
+    throw std::runtime_error("Index key has more than " +
+                             std::to_string(MAX_KEY_COLUMNS) + " columns!");
+  }
+
+  // Every key column gets its own slot in the key, in key order
+  std::vector<KeyColumn> key_layout;
   uint32_t key_size = 0;
   for (const auto &col : key_schema->GetColumns()) {
-    if (col.IsInlined()) {
-      key_size += col.GetFixedLength();
-    } else {
-      key_size += col.GetStorageLimit();
-    }
+    uint32_t width =
+        col.IsInlined() ? col.GetFixedLength() : col.GetStorageLimit();
+    key_layout.push_back({col.GetTypeId(), static_cast<uint16_t>(key_size),
+                          static_cast<uint16_t>(width)});
+    key_size += width;
   }
 
   std::unique_ptr<Index> index = nullptr;
 
-  TypeId key_type = key_schema->GetColumn(0).GetTypeId();
-
   if (key_size <= 4) {
-    GenericComparator<4> comparator(key_type);
-    uint32_t leaf_max =
-        (PAGE_SIZE - 28) / (sizeof(GenericKey<4>) + sizeof(RID)) - 1;
-    uint32_t internal_max =
-        (PAGE_SIZE - 24) / (sizeof(GenericKey<4>) + sizeof(page_id_t)) - 1;
+    GenericComparator<4> comparator(key_layout);
+    using Tree = BPlusTree<GenericKey<4>, RID, GenericComparator<4>>;
     index = std::make_unique<
         BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>>(
-        index_name, bpm_, comparator, leaf_max, internal_max,
-        std::move(key_schema), root_page_id);
+        index_name, bpm_, comparator, Tree::DefaultLeafMaxSize(),
+        Tree::DefaultInternalMaxSize(), std::move(key_schema), root_page_id,
+        log_manager_);
   } else if (key_size <= 8) {
-    GenericComparator<8> comparator(key_type);
-    uint32_t leaf_max =
-        (PAGE_SIZE - 28) / (sizeof(GenericKey<8>) + sizeof(RID)) - 1;
-    uint32_t internal_max =
-        (PAGE_SIZE - 24) / (sizeof(GenericKey<8>) + sizeof(page_id_t)) - 1;
+    GenericComparator<8> comparator(key_layout);
+    using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
     index = std::make_unique<
         BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>>(
-        index_name, bpm_, comparator, leaf_max, internal_max,
-        std::move(key_schema), root_page_id);
+        index_name, bpm_, comparator, Tree::DefaultLeafMaxSize(),
+        Tree::DefaultInternalMaxSize(), std::move(key_schema), root_page_id,
+        log_manager_);
   } else if (key_size <= 16) {
-    GenericComparator<16> comparator(key_type);
-    uint32_t leaf_max =
-        (PAGE_SIZE - 28) / (sizeof(GenericKey<16>) + sizeof(RID)) - 1;
-    uint32_t internal_max =
-        (PAGE_SIZE - 24) / (sizeof(GenericKey<16>) + sizeof(page_id_t)) - 1;
+    GenericComparator<16> comparator(key_layout);
+    using Tree = BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
     index = std::make_unique<
         BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>>(
-        index_name, bpm_, comparator, leaf_max, internal_max,
-        std::move(key_schema), root_page_id);
+        index_name, bpm_, comparator, Tree::DefaultLeafMaxSize(),
+        Tree::DefaultInternalMaxSize(), std::move(key_schema), root_page_id,
+        log_manager_);
   } else if (key_size <= 32) {
-    GenericComparator<32> comparator(key_type);
-    uint32_t leaf_max =
-        (PAGE_SIZE - 28) / (sizeof(GenericKey<32>) + sizeof(RID)) - 1;
-    uint32_t internal_max =
-        (PAGE_SIZE - 24) / (sizeof(GenericKey<32>) + sizeof(page_id_t)) - 1;
+    GenericComparator<32> comparator(key_layout);
+    using Tree = BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
     index = std::make_unique<
         BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>>(
-        index_name, bpm_, comparator, leaf_max, internal_max,
-        std::move(key_schema), root_page_id);
+        index_name, bpm_, comparator, Tree::DefaultLeafMaxSize(),
+        Tree::DefaultInternalMaxSize(), std::move(key_schema), root_page_id,
+        log_manager_);
   } else if (key_size <= 64) {
-    GenericComparator<64> comparator(key_type);
-    uint32_t leaf_max =
-        (PAGE_SIZE - 28) / (sizeof(GenericKey<64>) + sizeof(RID)) - 1;
-    uint32_t internal_max =
-        (PAGE_SIZE - 24) / (sizeof(GenericKey<64>) + sizeof(page_id_t)) - 1;
+    GenericComparator<64> comparator(key_layout);
+    using Tree = BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
     index = std::make_unique<
         BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>>(
-        index_name, bpm_, comparator, leaf_max, internal_max,
-        std::move(key_schema), root_page_id);
+        index_name, bpm_, comparator, Tree::DefaultLeafMaxSize(),
+        Tree::DefaultInternalMaxSize(), std::move(key_schema), root_page_id,
+        log_manager_);
   } else if (key_size <= 128) {
-    GenericComparator<128> comparator(key_type);
-    uint32_t leaf_max =
-        (PAGE_SIZE - 28) / (sizeof(GenericKey<128>) + sizeof(RID)) - 1;
-    uint32_t internal_max =
-        (PAGE_SIZE - 24) / (sizeof(GenericKey<128>) + sizeof(page_id_t)) - 1;
+    GenericComparator<128> comparator(key_layout);
+    using Tree = BPlusTree<GenericKey<128>, RID, GenericComparator<128>>;
     index = std::make_unique<
         BPlusTreeIndex<GenericKey<128>, RID, GenericComparator<128>>>(
-        index_name, bpm_, comparator, leaf_max, internal_max,
-        std::move(key_schema), root_page_id);
+        index_name, bpm_, comparator, Tree::DefaultLeafMaxSize(),
+        Tree::DefaultInternalMaxSize(), std::move(key_schema), root_page_id,
+        log_manager_);
   } else if (key_size <= 256) {
-    GenericComparator<256> comparator(key_type);
-    uint32_t leaf_max =
-        (PAGE_SIZE - 28) / (sizeof(GenericKey<256>) + sizeof(RID)) - 1;
-    uint32_t internal_max =
-        (PAGE_SIZE - 24) / (sizeof(GenericKey<256>) + sizeof(page_id_t)) - 1;
+    GenericComparator<256> comparator(key_layout);
+    using Tree = BPlusTree<GenericKey<256>, RID, GenericComparator<256>>;
     index = std::make_unique<
         BPlusTreeIndex<GenericKey<256>, RID, GenericComparator<256>>>(
-        index_name, bpm_, comparator, leaf_max, internal_max,
-        std::move(key_schema), root_page_id);
+        index_name, bpm_, comparator, Tree::DefaultLeafMaxSize(),
+        Tree::DefaultInternalMaxSize(), std::move(key_schema), root_page_id,
+        log_manager_);
   } else {
     throw std::runtime_error(
         "Index key size exceeds maximum supported 256 bytes!");
@@ -320,12 +312,11 @@ void Catalog::PopulateIndex(TableMetadata *table_meta,
                             IndexMetadata *index_meta, Transaction *txn) {
   std::unique_lock<std::shared_mutex> table_lock(table_meta->table_latch_);
 
-  // Use the caller's transaction, or create a local one for boot-time
-  // index rebuilds (e.g., after crash recovery). A single Transaction
-  // is safe because InsertIntoLeaf calls UnlockUnpinPages() after each
-  // insert, which clears the page set between inserts.
-  Transaction boot_txn(0);
-  Transaction *effective_txn = (txn != nullptr) ? txn : &boot_txn;
+  // The table is read as the caller's transaction, if any. The index pages
+  // are written as system changes: they are redone after a crash but never
+  // undone, since the index exists from here on whatever becomes of `txn`.
+  Transaction index_txn(INVALID_TRANSACTION_ID);
+  Transaction *effective_txn = (txn != nullptr) ? txn : &index_txn;
 
   std::vector<Column> key_cols;
   for (uint32_t col_idx : index_meta->key_attrs_) {
@@ -333,22 +324,32 @@ void Catalog::PopulateIndex(TableMetadata *table_meta,
   }
   Schema key_schema(key_cols);
 
-  auto iter = table_meta->table_->Begin();
-  while (iter != table_meta->table_->End()) {
-    RID rid = iter.GetRid();
-    Tuple tuple;
-    if (table_meta->table_->GetTuple(rid, &tuple, effective_txn)) {
-
-      std::vector<Value> key_values;
-      for (uint32_t col_idx : index_meta->key_attrs_) {
-        key_values.push_back(tuple.GetValue(&table_meta->schema_, col_idx));
+  // Index builds read the whole table once; keep it out of the shared pool.
+  // The entries are sorted and the tree is built bottom-up, rather than
+  // inserted one by one: leaves come out packed to the fill factor instead
+  // of half full from splits, and written in key order.
+  BufferAccessStrategy strategy(bpm_, AccessStrategyType::BULK_READ);
+  auto iter = table_meta->table_->Begin(effective_txn, &strategy);
+  auto next = [&](Tuple *key_tuple, RID *rid) {
+    while (iter != table_meta->table_->End()) {
+      *rid = iter.GetRid();
+      Tuple tuple;
+      bool found =
+          table_meta->table_->GetTuple(*rid, &tuple, effective_txn, &strategy);
+      ++iter;
+      if (found) {
+        std::vector<Value> key_values;
+        for (uint32_t col_idx : index_meta->key_attrs_) {
+          key_values.push_back(tuple.GetValue(&table_meta->schema_, col_idx));
+        }
+        *key_tuple = Tuple(key_values, &key_schema);
+        return true;
       }
-
-      Tuple key_tuple(key_values, &key_schema);
-      index_meta->index_->InsertEntry(key_tuple, rid, effective_txn);
     }
-    ++iter;
-  }
+    return false;
+  };
+  index_meta->index_->BulkLoad(next, index_fill_factor_,
+                               INDEX_BUILD_SORT_MEMORY, &index_txn);
 }
 
 bool Catalog::DropTable(const std::string &table_name) {
@@ -547,8 +548,7 @@ void Catalog::SaveCatalog(const std::string &file_path) {
   }
 }
 
-void Catalog::LoadCatalog(const std::string &file_path,
-                          bool force_index_rebuild) {
+void Catalog::LoadCatalog(const std::string &file_path) {
   struct LoadingGuard {
     bool &flag_;
     LoadingGuard(bool &flag) : flag_(flag) { flag_ = true; }
@@ -600,12 +600,10 @@ void Catalog::LoadCatalog(const std::string &file_path,
 
       TableMetadata *t_meta = GetTable(tbl_oid);
       if (t_meta) {
-        // After crash recovery, B+Tree pages may be stale (recovery modified
-        // table pages without updating indexes). Force a full rebuild.
-        page_id_t effective_root =
-            force_index_rebuild ? INVALID_PAGE_ID : root_page_id;
+        // Recovery redoes and undoes index pages along with table pages, so
+        // the saved root is good and the tree is opened, not rebuilt
         CreateIndex(idx_name, t_meta->oid_, attrs, is_unique, nullptr,
-                    effective_root);
+                    root_page_id);
       }
     } else if (token == "FK") {
       std::string child_table, fk_name, parent_table;
@@ -649,13 +647,6 @@ void Catalog::LoadCatalog(const std::string &file_path,
                   std::vector<ForeignKeyDef>{});
     }
   }
-
-  if (force_index_rebuild) {
-    // The flag is still true here, but we can temporarily disable it to allow saving
-    is_loading_ = false;
-    SaveCatalog(file_path);
-    is_loading_ = true;
-  }
 }
 
 } // namespace tetodb
\ No newline at end of file
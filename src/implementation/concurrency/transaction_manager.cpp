@@ -45,8 +45,12 @@ void TransactionManager::Commit(Transaction *txn) {
     txn->SetPrevLSN(lsn);
 
     // CRITICAL: Block until the background thread writes this to the physical
-    // file!
-    log_manager_->Flush();
+    // file! Only our own records count: later appends are not waited for.
+    // An asynchronous commit leaves it to the flush thread's next round; a
+    // crash before then loses the transaction as a whole, never half of it.
+    if (txn->IsSynchronousCommit()) {
+      log_manager_->WaitForLSN(lsn);
+    }
   }
 
   txn->SetState(TransactionState::COMMITTED);
@@ -15,14 +15,13 @@ void IndexScanExecutor::Init() {
   IndexMetadata *index_meta =
       exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
 
-  // Cache search metadata to check boundaries while iterating
-  search_key_ = plan_->GetSearchKey();
   index_key_schema_ = index_meta->index_->GetKeySchema();
 
   // Initialize the Iterator from the Index wrapper
   // This physically locks the first matching Leaf Page in the BufferPool
   // via a ReadLatch, preventing concurrent ghost inserts (Phantom Reads).
-  iterator_ = index_meta->index_->GetBeginIterator(search_key_);
+  iterator_ = index_meta->index_->GetRangeIterator(plan_->GetLowerBound(),
+                                                   plan_->GetUpperBound());
 }
 
 bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
@@ -31,8 +30,8 @@ bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
   }
 
   while (!iterator_->IsEnd()) {
-    // Boundary condition: Since the B+Tree is sorted, if we hit a key greater
-    // than our search key, we are done.
+    // Boundary condition: Since the B+Tree is sorted, if we hit a key past
+    // the upper bound, we are done.
     if (iterator_->IsPastSearchBound()) {
       break;
     }
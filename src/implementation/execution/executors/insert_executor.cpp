@@ -16,6 +16,8 @@ void InsertExecutor::Init() {
   table_indexes_ =
       exec_ctx_->GetCatalog()->GetTableIndexes(plan_->GetTableOid());
   cursor_ = 0;
+  strategy_ = std::make_unique<BufferAccessStrategy>(
+      exec_ctx_->GetBufferPoolManager(), AccessStrategyType::BULK_WRITE);
 }
 
 bool InsertExecutor::Next(Tuple *tuple, RID *rid) {
@@ -102,7 +104,8 @@ bool InsertExecutor::Next(Tuple *tuple, RID *rid) {
   // ==========================================
   RID new_rid;
 
-  if (table_info_->table_->InsertTuple(to_insert, &new_rid, txn, lock_mgr)) {
+  if (table_info_->table_->InsertTuple(to_insert, &new_rid, txn, lock_mgr,
+                                       strategy_.get())) {
 
     TableWriteRecord write_record(new_rid, WType::INSERT,
                                   table_info_->table_.get());
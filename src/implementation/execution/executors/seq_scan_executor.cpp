@@ -13,7 +13,11 @@ SeqScanExecutor::SeqScanExecutor(ExecutionContext *exec_ctx,
 void SeqScanExecutor::Init() {
   metadata_ =
       exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid()); // O(1) Lookup!
-  iter_ = std::make_unique<TableIterator>(metadata_->table_->Begin());
+  iter_.reset(); // Drop the old iterator before the strategy it uses
+  strategy_ = std::make_unique<BufferAccessStrategy>(
+      exec_ctx_->GetBufferPoolManager(), AccessStrategyType::BULK_READ);
+  iter_ = std::make_unique<TableIterator>(
+      metadata_->table_->Begin(exec_ctx_->GetTransaction(), strategy_.get()));
 }
 
 bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
@@ -42,7 +46,8 @@ bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
     // ==========================================================
     // 3. FETCH THE TUPLE (Safely protected by the lock)
     // ==========================================================
-    bool fetch_success = metadata_->table_->GetTuple(*rid, tuple, txn);
+    bool fetch_success =
+        metadata_->table_->GetTuple(*rid, tuple, txn, strategy_.get());
 
     // 4. Advance the iterator NOW so `continue` statements don't cause infinite
     // loops!
@@ -2,6 +2,10 @@
 
 #include "execution/executors/sort_executor.h"
 #include <algorithm>
+#include <numeric>
+#include <string>
+
+#include "type/key_encoding.h"
 
 namespace tetodb {
 
@@ -27,7 +31,14 @@ namespace tetodb {
         const Schema* schema = child_executor_->GetOutputSchema();
         const auto& order_bys = plan_->GetOrderBys();
 
-        // 2. Sort: Use std::sort with a custom comparison lambda
+        // 2. Sort: each row gets one normalized key (its ORDER BY values, each
+        // encoded so bytes order like the values) and rows sort by memcmp of
+        // the keys, evaluating each expression once per row
+        if (SortByNormalizedKeys(schema)) {
+            return;
+        }
+
+        // Values no single encoding orders: compare them pairwise instead
         std::sort(sorted_tuples_.begin(), sorted_tuples_.end(),
             [schema, &order_bys](const Tuple& a, const Tuple& b) {
 
@@ -57,6 +68,76 @@ namespace tetodb {
         );
     }
 
+    // The type one ORDER BY column's values are encoded as, so that encoded
+    // keys order like CompareLessThan: their own type if they share one, or
+    // BIGINT / DECIMAL for a mix of integer / numeric types. INVALID if no
+    // single encoding orders them.
+    static TypeId SortKeyType(const std::vector<Value>& values) {
+        TypeId type = TypeId::INVALID;
+        bool mixed = false;
+        bool numeric = true;
+        bool has_decimal = false;
+        for (const auto& val : values) {
+            if (val.IsNull()) continue;
+            TypeId val_type = val.GetTypeId();
+            if (val_type == TypeId::CHAR) val_type = TypeId::VARCHAR;
+            if (type == TypeId::INVALID) type = val_type;
+            if (val_type != type) mixed = true;
+            numeric = numeric && Value::IsNumeric(val_type);
+            has_decimal = has_decimal || val_type == TypeId::DECIMAL;
+        }
+        if (type == TypeId::INVALID) return TypeId::BIGINT; // All NULL
+        if (!mixed) return type;
+        if (!numeric) return TypeId::INVALID;
+        return has_decimal ? TypeId::DECIMAL : TypeId::BIGINT;
+    }
+
+    bool SortExecutor::SortByNormalizedKeys(const Schema* schema) {
+        const auto& order_bys = plan_->GetOrderBys();
+        size_t num_rows = sorted_tuples_.size();
+
+        std::vector<std::string> keys(num_rows);
+        std::vector<Value> values(num_rows);
+        for (const auto& order_pair : order_bys) {
+            for (size_t i = 0; i < num_rows; i++) {
+                values[i] = order_pair.second->Evaluate(&sorted_tuples_[i], schema);
+            }
+            TypeId key_type = SortKeyType(values);
+            if (key_type == TypeId::INVALID) return false;
+
+            for (size_t i = 0; i < num_rows; i++) {
+                std::string& key = keys[i];
+                size_t start = key.size();
+                // NULLs sort last ascending and first descending
+                if (values[i].IsNull()) {
+                    key.push_back('\x01');
+                } else {
+                    key.push_back('\0');
+                    key_encoding::AppendKeyValue(key_type, values[i], &key);
+                }
+                if (order_pair.first == OrderByType::DESC) {
+                    for (size_t j = start; j < key.size(); j++) {
+                        key[j] = static_cast<char>(~key[j]);
+                    }
+                }
+            }
+        }
+
+        // std::string compares bytes as unsigned, like memcmp
+        std::vector<size_t> order(num_rows);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+            [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+        std::vector<Tuple> sorted;
+        sorted.reserve(num_rows);
+        for (size_t i : order) {
+            sorted.push_back(std::move(sorted_tuples_[i]));
+        }
+        sorted_tuples_ = std::move(sorted);
+        return true;
+    }
+
     bool SortExecutor::Next(Tuple* tuple, RID* rid) {
         // 3. Emit: Hand the perfectly sorted tuples up the pipeline one by one
         if (cursor_ < sorted_tuples_.size()) {
@@ -18,6 +18,12 @@ namespace tetodb {
                 Value val_a = order_by.second->Evaluate(&a, schema);
                 Value val_b = order_by.second->Evaluate(&b, schema);
 
+                // NULLs sort last ascending and first descending, as in Sort
+                if (val_a.IsNull() || val_b.IsNull()) {
+                    if (val_a.IsNull() && val_b.IsNull()) continue;
+                    return (type == OrderByType::DESC) ? val_a.IsNull() : val_b.IsNull();
+                }
+
                 if (val_a.CompareEquals(val_b)) continue;
 
                 // Priority Queue maintains the "worst" of the Top-N at the top so it can be popped easily.
@@ -1,6 +1,7 @@
 // fk_constraint_handler.cpp
 
 #include "execution/fk_constraint_handler.h"
+#include "storage/buffer/buffer_access_strategy.h"
 #include <stdexcept>
 
 namespace tetodb {
@@ -46,11 +47,15 @@ void FKConstraintHandler::EnforceOnDelete(
         fk_index->index_->ScanKey(search_key, &dependent_rids, txn);
       } else {
         // SLOW PATH: O(N) Sequential Heap Scan
-        auto child_iter = child_meta->table_->Begin(txn);
+        BufferAccessStrategy strategy(
+            child_meta->table_->GetBufferPoolManager(),
+            AccessStrategyType::BULK_READ);
+        auto child_iter = child_meta->table_->Begin(txn, &strategy);
         while (child_iter != child_meta->table_->End()) {
           RID child_rid = child_iter.GetRid();
           Tuple child_tuple;
-          if (child_meta->table_->GetTuple(child_rid, &child_tuple, txn)) {
+          if (child_meta->table_->GetTuple(child_rid, &child_tuple, txn,
+                                          &strategy)) {
             bool match = true;
             for (size_t i = 0; i < fk.parent_key_attrs_.size(); i++) {
               Value parent_val = deleted_tuple.GetValue(
@@ -239,11 +244,15 @@ void FKConstraintHandler::EnforceOnUpdate(
         Tuple search_key(key_vals, &key_schema);
         fk_index->index_->ScanKey(search_key, &dependent_rids, txn);
       } else {
-        auto child_iter = child_meta->table_->Begin(txn);
+        BufferAccessStrategy strategy(
+            child_meta->table_->GetBufferPoolManager(),
+            AccessStrategyType::BULK_READ);
+        auto child_iter = child_meta->table_->Begin(txn, &strategy);
         while (child_iter != child_meta->table_->End()) {
           RID child_rid = child_iter.GetRid();
           Tuple child_tuple;
-          if (child_meta->table_->GetTuple(child_rid, &child_tuple, txn)) {
+          if (child_meta->table_->GetTuple(child_rid, &child_tuple, txn,
+                                          &strategy)) {
             bool match = true;
             for (size_t i = 0; i < fk.parent_key_attrs_.size(); i++) {
               Value old_parent_val =
@@ -391,10 +400,13 @@ void FKConstraintHandler::ValidateForeignKey(
       }
     }
   } else {
-    auto p_iter = parent_meta->table_->Begin(txn);
+    BufferAccessStrategy strategy(parent_meta->table_->GetBufferPoolManager(),
+                                  AccessStrategyType::BULK_READ);
+    auto p_iter = parent_meta->table_->Begin(txn, &strategy);
     while (p_iter != parent_meta->table_->End()) {
       Tuple p_tuple;
-      if (parent_meta->table_->GetTuple(p_iter.GetRid(), &p_tuple, txn)) {
+      if (parent_meta->table_->GetTuple(p_iter.GetRid(), &p_tuple, txn,
+                                        &strategy)) {
         bool match = true;
         for (size_t i = 0; i < fk.parent_key_attrs_.size(); i++) {
           Value p_val = p_tuple.GetValue(&parent_meta->schema_,
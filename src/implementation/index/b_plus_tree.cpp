@@ -1,5 +1,6 @@
 // b_plus_tree.cpp
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -17,10 +18,14 @@ BPLUSTREE_TYPE::BPlusTree(std::string name,
                           BufferPoolManager *buffer_pool_manager,
                           const KeyComparator &comparator,
                           uint32_t leaf_max_size, uint32_t internal_max_size,
-                          page_id_t root_page_id)
+                          page_id_t root_page_id, LogManager *log_manager)
     : index_name_(std::move(name)), root_page_id_(root_page_id),
       buffer_pool_manager_(buffer_pool_manager), comparator_(comparator),
-      leaf_max_size_(leaf_max_size), internal_max_size_(internal_max_size) {}
+      leaf_max_size_(leaf_max_size), internal_max_size_(internal_max_size),
+      log_manager_(log_manager) {
+  if (root_page_id_ == INVALID_PAGE_ID)
+    StartNewTree();
+}
 
 /*****************************************************************************
  * SEARCH
@@ -33,7 +38,15 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
     if (IsEmpty())
       return false;
 
-    Page *page = FindLeafPage(key);
+    for (int attempt = 0; attempt < OPTIMISTIC_RETRIES; attempt++) {
+      bool restart = false;
+      bool found = GetValueOptimistic(key, result, &restart);
+      if (!restart)
+        return found;
+    }
+
+    // Writers kept getting in the way; crab down with read latches instead
+    Page *page = FindLeafPage(key, false, Operation::READ, nullptr, false);
     if (page == nullptr)
       return false;
 
@@ -85,16 +98,176 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
     throw;
   }
 }
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::GetValueOptimistic(const KeyType &key,
+                                        std::vector<ValueType> *result,
+                                        bool *restart) {
+  uint64_t version;
+  Page *page = FindLeafPageOptimistic(key, false, false, &version, restart);
+  if (page == nullptr)
+    return false;
+
+  // Anything appended under a snapshot that fails is taken back out
+  size_t first_match = result->size();
+  uint32_t idx = UINT32_MAX;
+  while (true) {
+    auto *leaf_page = reinterpret_cast<
+        BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(
+        page->GetData());
+
+    if (idx == UINT32_MAX)
+      idx = leaf_page->KeyIndex(key, comparator_);
+    uint32_t size = leaf_page->GetSize();
+    while (idx < size && comparator_(leaf_page->KeyAt(idx), key) == 0) {
+      result->push_back(leaf_page->ValueAt(idx));
+      idx++;
+    }
+    page_id_t next_page_id = leaf_page->GetNextPageId();
+
+    if (!page->CheckVersion(version)) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      result->resize(first_match);
+      *restart = true;
+      return false;
+    }
+    if (idx != size || next_page_id == INVALID_PAGE_ID)
+      break;
+
+    // Duplicates may continue on the next leaf
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
+    }
+    // The leaf we came from is checked again: once it changes, a merge may
+    // have freed the next one, and the page may hold anything by now
+    uint64_t next_version = next_page->GetVersion();
+    bool moved = (next_version & 1) || !page->CheckVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (moved) {
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      result->resize(first_match);
+      *restart = true;
+      return false;
+    }
+    page = next_page;
+    version = next_version;
+    idx = 0;
+  }
+
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return result->size() > first_match;
+}
+
 /*****************************************************************************
  * UTILITIES AND HELPERS
  *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key, bool leftMost,
+                                             bool latch_leaf,
+                                             uint64_t *leaf_version,
+                                             bool *restart) {
+  *restart = false;
+  auto retry = [&](Page *pinned) -> Page * {
+    if (pinned != nullptr)
+      buffer_pool_manager_->UnpinPage(pinned->GetPageId(), false);
+    *restart = true;
+    return nullptr;
+  };
+
+  page_id_t root_id = root_page_id_.load();
+  if (root_id == INVALID_PAGE_ID)
+    return nullptr;
+
+  Page *page = buffer_pool_manager_->FetchPage(root_id);
+  if (page == nullptr)
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
+
+  // The root page never moves, but Destroy() may have cleared the id
+  uint64_t version = page->GetVersion();
+  if ((version & 1) || root_page_id_.load() != root_id)
+    return retry(page);
+
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (node->IsLeafPage()) {
+    if (latch_leaf) {
+      page->RLatch();
+      if (!page->CheckVersion(version)) {
+        page->RUnlatch();
+        return retry(page);
+      }
+    } else {
+      *leaf_version = version;
+    }
+    return page;
+  }
+
+  while (true) {
+    auto *internal = reinterpret_cast<
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(
+        page->GetData());
+    page_id_t child_page_id =
+        leftMost ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+
+    // The id may be garbage if a writer got in; never fetch before checking
+    if (!page->CheckVersion(version))
+      return retry(page);
+
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
+    }
+    auto *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+
+    if (child_node->IsLeafPage()) {
+      // Leaves are latched (or snapshotted) first, then the parent is checked
+      // once more: an unchanged parent means no split moved our key away
+      bool ok;
+      if (latch_leaf) {
+        child_page->RLatch();
+        ok = page->CheckVersion(version);
+        if (!ok)
+          child_page->RUnlatch();
+      } else {
+        *leaf_version = child_page->GetVersion();
+        ok = (*leaf_version & 1) == 0 && page->CheckVersion(version);
+      }
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      if (!ok)
+        return retry(child_page);
+      return child_page;
+    }
+
+    uint64_t child_version = child_page->GetVersion();
+    bool ok = (child_version & 1) == 0 && page->CheckVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!ok)
+      return retry(child_page);
+
+    page = child_page;
+    version = child_version;
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost,
-                                   Operation op, Transaction *transaction) {
+                                   Operation op, Transaction *transaction,
+                                   bool optimistic) {
 
   if (IsEmpty())
     return nullptr;
 
+  if (op == Operation::READ && optimistic) {
+    for (int attempt = 0; attempt < OPTIMISTIC_RETRIES; attempt++) {
+      bool restart = false;
+      Page *leaf = FindLeafPageOptimistic(key, leftMost, true, nullptr, &restart);
+      if (!restart)
+        return leaf;
+    }
+  }
+
   bool root_locked = false;
   if (op == Operation::READ) {
     root_latch_.RLock();
@@ -190,9 +363,12 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value,
 
     root_latch_.WLock();
     if (IsEmpty()) {
-      StartNewTree(key, value);
-      root_latch_.WUnlock();
-      return true;
+      try {
+        StartNewTree(transaction);
+      } catch (Exception &e) {
+        root_latch_.WUnlock();
+        throw;
+      }
     }
     root_latch_.WUnlock();
 
@@ -227,7 +403,7 @@ bool BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value,
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+void BPLUSTREE_TYPE::StartNewTree(Transaction *transaction) {
   page_id_t page_id;
   Page *page = buffer_pool_manager_->NewPage(&page_id);
   if (page == nullptr) {
@@ -238,7 +414,7 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
       reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(
           page->GetData());
   leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
-  leaf->Insert(key, value, comparator_);
+  LogNode(leaf, transaction);
 
   root_page_id_ = page_id;
   depth_ = 1;
@@ -259,6 +435,7 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 
   try {
     uint32_t size = leaf->GetSize();
+    uint32_t index = leaf->KeyIndex(key, comparator_);
     uint32_t new_size = leaf->Insert(key, value, comparator_);
 
     if (new_size == size) {
@@ -267,10 +444,11 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
       UnlockUnpinPages(transaction);
       return false;
     }
+    LogEntry(LogRecordType::BTREE_INSERT, leaf, index, transaction);
 
     if (new_size > leaf_max_size_) {
       BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *new_leaf =
-          Split(leaf);
+          Split(leaf, transaction);
 
       try {
         InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction);
@@ -305,16 +483,19 @@ bool BPLUSTREE_TYPE::RemoveFromLeaf(const KeyType &key, const ValueType &value,
       reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(
           page->GetData());
 
+  bool changed = false;
   try {
-    uint32_t size = leaf->GetSize();
-    uint32_t new_size = leaf->Remove(key, value, comparator_);
+    uint32_t index = leaf->EntryIndex(key, value, comparator_);
 
-    if (new_size == size) {
+    if (index == leaf->GetSize()) {
       page->WUnlatch();
       buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
       UnlockUnpinPages(transaction);
       return false;
     }
+    LogEntry(LogRecordType::BTREE_DELETE, leaf, index, transaction);
+    leaf->RemoveAt(index);
+    changed = Rebalance(leaf, transaction);
 
   } catch (Exception &e) {
     page->WUnlatch();
@@ -324,13 +505,471 @@ bool BPLUSTREE_TYPE::RemoveFromLeaf(const KeyType &key, const ValueType &value,
 
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
-  UnlockUnpinPages(transaction);
+  UnlockUnpinPages(transaction, changed);
+  DeletePages(transaction);
+
+  return true;
+}
+
+/*****************************************************************************
+ * UNDERFLOW: MERGE & REDISTRIBUTE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::Rebalance(BPlusTreePage *node, Transaction *transaction) {
+  // A node that can underflow was not safe on the way down, so its parent
+  // is still latched, right behind it in the page set
+  auto &pages = *transaction->GetPageSet();
+  size_t level = pages.size();
+  size_t changed_from = pages.size();
+
+  while (!node->IsRootPage() && node->GetSize() < node->GetMinSize() &&
+         level > 0) {
+    auto *parent = reinterpret_cast<InternalPage *>(pages[--level]->GetData());
+    if (parent->GetPageId() != node->GetParentPageId() ||
+        !CoalesceOrRedistribute(node, parent, transaction))
+      break;
+    changed_from = level;
+    node = parent;
+  }
+
+  // Parents above the highest one that changed go back clean now, so the
+  // page set is left holding only changed pages
+  for (size_t i = 0; i < changed_from; i++) {
+    pages[i]->WUnlatch();
+    buffer_pool_manager_->UnpinPage(pages[i]->GetPageId(), false);
+  }
+  pages.erase(pages.begin(), pages.begin() + changed_from);
+  return !pages.empty();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::CoalesceOrRedistribute(BPlusTreePage *node,
+                                            InternalPage *parent,
+                                            Transaction *transaction) {
+  uint32_t index = parent->ValueIndex(node->GetPageId());
+  if (index == parent->GetSize() || parent->GetSize() < 2)
+    return false;
+
+  // Siblings are latched left to right, the way scans walk the leaves. A
+  // last child only has a left sibling: that latch is only tried, and the
+  // node stays underfull if someone holds it.
+  bool from_right = index + 1 < parent->GetSize();
+  page_id_t sibling_id = parent->ValueAt(from_right ? index + 1 : index - 1);
+  Page *sibling_page = buffer_pool_manager_->FetchPage(sibling_id);
+  if (sibling_page == nullptr)
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
+
+  if (from_right) {
+    sibling_page->WLatch();
+  } else if (!sibling_page->TryWLatch()) {
+    buffer_pool_manager_->UnpinPage(sibling_id, false);
+    return false;
+  }
+
+  auto *sibling = reinterpret_cast<BPlusTreePage *>(sibling_page->GetData());
+  BPlusTreePage *left = from_right ? node : sibling;
+  BPlusTreePage *right = from_right ? sibling : node;
+  uint32_t right_index = from_right ? index + 1 : index;
+
+  try {
+    if (left->GetSize() + right->GetSize() <= node->GetMaxSize())
+      Coalesce(left, right, parent, right_index, transaction);
+    else
+      Redistribute(left, right, parent, right_index, from_right, transaction);
+  } catch (Exception &e) {
+    sibling_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(sibling_id, true);
+    throw;
+  }
 
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_id, true);
   return true;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-template <typename N> N *BPLUSTREE_TYPE::Split(N *node) {
+void BPLUSTREE_TYPE::Coalesce(BPlusTreePage *left, BPlusTreePage *right,
+                              InternalPage *parent, uint32_t right_index,
+                              Transaction *transaction) {
+  // Only `left` is logged: `right` is freed, whatever it holds
+  uint32_t old_size = left->GetSize();
+  if (left->IsLeafPage()) {
+    auto *left_leaf = reinterpret_cast<LeafPage *>(left);
+    auto *right_leaf = reinterpret_cast<LeafPage *>(right);
+    right_leaf->MoveAllTo(left_leaf);
+    left_leaf->SetNextPageId(right_leaf->GetNextPageId());
+
+    LogBytes(left, 0, LEAF_PAGE_HEADER_SIZE, transaction);
+    uint32_t entry_size = sizeof(std::pair<KeyType, ValueType>);
+    LogBytes(left, LEAF_PAGE_HEADER_SIZE + old_size * entry_size,
+             (left->GetSize() - old_size) * entry_size, transaction);
+  } else {
+    auto *left_internal = reinterpret_cast<InternalPage *>(left);
+    reinterpret_cast<InternalPage *>(right)->MoveAllTo(
+        left_internal, parent->KeyAt(right_index), buffer_pool_manager_);
+    for (uint32_t i = old_size; i < left->GetSize(); i++)
+      AdoptChild(left_internal, i, transaction);
+
+    LogBytes(left, 0, INTERNAL_PAGE_HEADER_SIZE, transaction);
+    uint32_t entry_size = sizeof(std::pair<KeyType, page_id_t>);
+    LogBytes(left, INTERNAL_PAGE_HEADER_SIZE + old_size * entry_size,
+             (left->GetSize() - old_size) * entry_size, transaction);
+  }
+
+  LogEntry(LogRecordType::BTREE_DELETE, parent, right_index, transaction);
+  parent->RemoveAt(right_index);
+  transaction->AddIntoDeletedPageSet(right->GetPageId());
+
+  if (parent->IsRootPage() && parent->GetSize() == 1)
+    CollapseRoot(parent, left, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Redistribute(BPlusTreePage *left, BPlusTreePage *right,
+                                  InternalPage *parent, uint32_t right_index,
+                                  bool to_left, Transaction *transaction) {
+  if (left->IsLeafPage()) {
+    auto *left_leaf = reinterpret_cast<LeafPage *>(left);
+    auto *right_leaf = reinterpret_cast<LeafPage *>(right);
+    if (to_left) {
+      LogEntry(LogRecordType::BTREE_DELETE, right, 0, transaction, true);
+      std::pair<KeyType, ValueType> item = right_leaf->ItemAt(0);
+      right_leaf->RemoveAt(0);
+      left_leaf->InsertAt(left_leaf->GetSize(), item);
+      LogEntry(LogRecordType::BTREE_INSERT, left, left_leaf->GetSize() - 1,
+               transaction, true);
+    } else {
+      uint32_t last = left_leaf->GetSize() - 1;
+      LogEntry(LogRecordType::BTREE_DELETE, left, last, transaction, true);
+      std::pair<KeyType, ValueType> item = left_leaf->ItemAt(last);
+      left_leaf->RemoveAt(last);
+      right_leaf->InsertAt(0, item);
+      LogEntry(LogRecordType::BTREE_INSERT, right, 0, transaction, true);
+    }
+    parent->SetKeyAt(right_index, right_leaf->KeyAt(0));
+  } else {
+    // The parent's key comes down to the receiving side and the first key
+    // on the giving side goes up in its place
+    auto *left_internal = reinterpret_cast<InternalPage *>(left);
+    auto *right_internal = reinterpret_cast<InternalPage *>(right);
+    if (to_left) {
+      LogEntry(LogRecordType::BTREE_DELETE, right, 0, transaction);
+      left_internal->InsertAt(left_internal->GetSize(),
+                              {parent->KeyAt(right_index),
+                               right_internal->ValueAt(0)});
+      parent->SetKeyAt(right_index, right_internal->KeyAt(1));
+      right_internal->RemoveAt(0);
+
+      uint32_t last = left_internal->GetSize() - 1;
+      LogEntry(LogRecordType::BTREE_INSERT, left, last, transaction);
+      AdoptChild(left_internal, last, transaction);
+    } else {
+      uint32_t last = left_internal->GetSize() - 1;
+      LogEntry(LogRecordType::BTREE_DELETE, left, last, transaction);
+      right_internal->SetKeyAt(0, parent->KeyAt(right_index));
+      right_internal->InsertAt(0, {KeyType(), left_internal->ValueAt(last)});
+      parent->SetKeyAt(right_index, left_internal->KeyAt(last));
+      left_internal->RemoveAt(last);
+
+      LogEntry(LogRecordType::BTREE_INSERT, right, 0, transaction);
+      LogKey(right_internal, 1, transaction);
+      AdoptChild(right_internal, 0, transaction);
+    }
+  }
+  LogKey(parent, right_index, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CollapseRoot(InternalPage *root, BPlusTreePage *child,
+                                  Transaction *transaction) {
+  page_id_t root_id = root->GetPageId();
+  std::memcpy(reinterpret_cast<char *>(root), child, UsedBytes(child));
+  root->SetPageId(root_id);
+  root->SetParentPageId(INVALID_PAGE_ID);
+  if (!root->IsLeafPage())
+    AdoptChildren(root, transaction);
+  LogNode(root, transaction);
+
+  transaction->AddIntoDeletedPageSet(child->GetPageId());
+  depth_--;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePages(Transaction *transaction) {
+  // A page an optimistic reader still has pinned is freed by the buffer
+  // pool on its last unpin; the reader sees its parent changed and starts
+  // over
+  for (page_id_t page_id : *transaction->GetDeletedPageSet())
+    buffer_pool_manager_->DeletePage(page_id);
+  transaction->ClearDeletedPageSet();
+}
+
+/*****************************************************************************
+ * COMPACTION
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t BPLUSTREE_TYPE::Compact(Transaction *transaction) {
+  uint32_t freed = 0;
+  KeyType key;
+  bool leftmost = true;
+
+  try {
+    // One DELETE descent per leaf: an underfull leaf keeps its parents
+    // latched, the same as one a Remove() is about to empty
+    while (true) {
+      Page *page = FindLeafPage(key, leftmost, Operation::DELETE, transaction);
+      if (page == nullptr)
+        break;
+      auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+
+      bool changed = false;
+      bool more = false;
+      try {
+        changed = Rebalance(leaf, transaction);
+        UnlockUnpinPages(transaction, changed);
+        more = NextLeafKey(leaf, &key, leftmost);
+      } catch (Exception &e) {
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+        throw;
+      }
+
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), changed);
+      freed += transaction->GetDeletedPageSet()->size();
+      DeletePages(transaction);
+
+      if (!more)
+        break;
+      leftmost = false;
+    }
+  } catch (Exception &e) {
+    UnlockUnpinPages(transaction);
+    throw;
+  }
+
+  return freed;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::NextLeafKey(LeafPage *leaf, KeyType *key, bool any) {
+  // `leaf` is held; the chain after it is read hand over hand, rightwards
+  Page *held = nullptr;
+  bool found = false;
+
+  page_id_t next_page_id = leaf->GetNextPageId();
+  while (next_page_id != INVALID_PAGE_ID) {
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      if (held != nullptr) {
+        held->RUnlatch();
+        buffer_pool_manager_->UnpinPage(held->GetPageId(), false);
+      }
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
+    }
+    next_page->RLatch();
+    if (held != nullptr) {
+      held->RUnlatch();
+      buffer_pool_manager_->UnpinPage(held->GetPageId(), false);
+    }
+    held = next_page;
+
+    auto *next_leaf = reinterpret_cast<LeafPage *>(next_page->GetData());
+    if (next_leaf->GetSize() > 0 &&
+        (any || comparator_(next_leaf->KeyAt(0), *key) > 0)) {
+      *key = next_leaf->KeyAt(0);
+      found = true;
+      break;
+    }
+    next_page_id = next_leaf->GetNextPageId();
+  }
+
+  if (held != nullptr) {
+    held->RUnlatch();
+    buffer_pool_manager_->UnpinPage(held->GetPageId(), false);
+  }
+  return found;
+}
+
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoad(
+    const std::function<bool(KeyType *, ValueType *)> &next,
+    uint32_t fill_percent, Transaction *transaction) {
+  page_id_t root_id = root_page_id_;
+  Page *root_page = buffer_pool_manager_->FetchPage(root_id);
+  if (root_page == nullptr)
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
+  auto *root = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
+  bool empty = root->IsLeafPage() && root->GetSize() == 0;
+  buffer_pool_manager_->UnpinPage(root_id, false);
+  if (!empty)
+    throw Exception(ExceptionType::INVALID, "Bulk load into a non-empty tree");
+
+  // Leaves are written left to right. The last two stay pinned until the
+  // input ends, so that a short last leaf can be evened out with the one
+  // before it.
+  uint32_t leaf_fill = FillSize(leaf_max_size_, fill_percent);
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  LeafPage *prev = nullptr;
+  LeafPage *leaf = nullptr;
+  try {
+    KeyType key;
+    ValueType value;
+    while (next(&key, &value)) {
+      if (leaf == nullptr || leaf->GetSize() == leaf_fill) {
+        page_id_t page_id;
+        Page *page = buffer_pool_manager_->NewPage(&page_id);
+        if (page == nullptr)
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
+        if (prev != nullptr)
+          FinishNode(prev, transaction);
+        prev = leaf;
+        leaf = reinterpret_cast<LeafPage *>(page->GetData());
+        leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+        if (prev != nullptr)
+          prev->SetNextPageId(page_id);
+        level.push_back({key, page_id});
+      }
+      leaf->InsertAt(leaf->GetSize(), {key, value});
+    }
+  } catch (...) {
+    if (prev != nullptr)
+      buffer_pool_manager_->UnpinPage(prev->GetPageId(), false);
+    if (leaf != nullptr)
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    throw;
+  }
+  if (leaf == nullptr)
+    return; // Nothing to load: the root stays an empty leaf
+
+  if (prev != nullptr && leaf->GetSize() < leaf_max_size_ / 2) {
+    uint32_t total = prev->GetSize() + leaf->GetSize();
+    if (total <= leaf_max_size_) {
+      leaf->MoveAllTo(prev);
+      prev->SetNextPageId(INVALID_PAGE_ID);
+      page_id_t page_id = leaf->GetPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      level.pop_back();
+      leaf = nullptr;
+    } else {
+      while (prev->GetSize() > total / 2) {
+        uint32_t last = prev->GetSize() - 1;
+        leaf->InsertAt(0, prev->ItemAt(last));
+        prev->RemoveAt(last);
+      }
+      level.back().first = leaf->KeyAt(0);
+    }
+  }
+  if (prev != nullptr)
+    FinishNode(prev, transaction);
+  if (leaf != nullptr)
+    FinishNode(leaf, transaction);
+
+  uint32_t depth = 1;
+  while (level.size() > 1) {
+    level = BuildInternalLevel(level, fill_percent, transaction);
+    depth++;
+  }
+
+  // The root keeps its page id: the top node is copied into it
+  page_id_t top_id = level[0].second;
+  Page *top_page = buffer_pool_manager_->FetchPage(top_id);
+  root_page = buffer_pool_manager_->FetchPage(root_id);
+  if (top_page == nullptr || root_page == nullptr) {
+    if (top_page != nullptr)
+      buffer_pool_manager_->UnpinPage(top_id, false);
+    if (root_page != nullptr)
+      buffer_pool_manager_->UnpinPage(root_id, false);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
+  }
+  auto *top = reinterpret_cast<BPlusTreePage *>(top_page->GetData());
+  root = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
+
+  root_page->WLatch();
+  std::memcpy(root_page->GetData(), top_page->GetData(), UsedBytes(top));
+  root->SetPageId(root_id);
+  root->SetParentPageId(INVALID_PAGE_ID);
+  if (!root->IsLeafPage())
+    AdoptChildren(reinterpret_cast<InternalPage *>(root), transaction);
+  LogNode(root, transaction);
+  depth_ = depth;
+  root_page->WUnlatch();
+
+  buffer_pool_manager_->UnpinPage(root_id, true);
+  buffer_pool_manager_->UnpinPage(top_id, false);
+  buffer_pool_manager_->DeletePage(top_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t BPLUSTREE_TYPE::FillSize(uint32_t max_size, uint32_t fill_percent) {
+  uint32_t fill = static_cast<uint32_t>(
+      static_cast<uint64_t>(max_size) * fill_percent / 100);
+  return std::max(std::min(fill, max_size), std::max(max_size / 2, 2u));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<std::pair<KeyType, page_id_t>> BPLUSTREE_TYPE::BuildInternalLevel(
+    const std::vector<std::pair<KeyType, page_id_t>> &children,
+    uint32_t fill_percent, Transaction *transaction) {
+  // Full nodes, then the rest; a short last node is evened out with the
+  // one before it, or merged into it if they fit together
+  uint32_t fill = FillSize(internal_max_size_, fill_percent);
+  std::vector<uint32_t> sizes(children.size() / fill, fill);
+  uint32_t rest = static_cast<uint32_t>(children.size() % fill);
+  if (rest > 0) {
+    if (sizes.empty() || rest >= internal_max_size_ / 2) {
+      sizes.push_back(rest);
+    } else {
+      uint32_t total = sizes.back() + rest;
+      if (total <= internal_max_size_) {
+        sizes.back() = total;
+      } else {
+        sizes.back() = total / 2;
+        sizes.push_back(total - total / 2);
+      }
+    }
+  }
+
+  std::vector<std::pair<KeyType, page_id_t>> parents;
+  size_t first = 0;
+  for (uint32_t size : sizes) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr)
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
+
+    auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+    node->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+    for (uint32_t i = 0; i < size; i++)
+      node->InsertAt(i, children[first + i]);
+    node->SetKeyAt(0, KeyType());
+    try {
+      AdoptChildren(node, transaction);
+    } catch (Exception &e) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      throw;
+    }
+    FinishNode(node, transaction);
+
+    parents.push_back({children[first].first, page_id});
+    first += size;
+  }
+  return parents;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FinishNode(BPlusTreePage *node, Transaction *transaction) {
+  LogNode(node, transaction);
+  buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+N *BPLUSTREE_TYPE::Split(N *node, Transaction *transaction) {
   page_id_t page_id;
   Page *page = buffer_pool_manager_->NewPage(&page_id);
   if (page == nullptr) {
@@ -349,35 +988,96 @@ template <typename N> N *BPLUSTREE_TYPE::Split(N *node) {
 
     new_leaf->SetNextPageId(leaf->GetNextPageId());
     leaf->SetNextPageId(new_leaf->GetPageId());
+    LogBytes(leaf, 0, LEAF_PAGE_HEADER_SIZE, transaction);
+  } else {
+    AdoptChildren(reinterpret_cast<
+                      BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(
+                      new_node),
+                  transaction);
+    LogBytes(node, 0, INTERNAL_PAGE_HEADER_SIZE, transaction);
   }
+  LogNode(new_node, transaction);
 
   return new_node;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::AdoptChildren(
+    BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *node,
+    Transaction *transaction) {
+  for (uint32_t i = 0; i < node->GetSize(); i++) {
+    AdoptChild(node, i, transaction);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::AdoptChild(InternalPage *node, uint32_t index,
+                                Transaction *transaction) {
+  page_id_t parent_id = node->GetPageId();
+  page_id_t child_id = node->ValueAt(index);
+  Page *child_page = buffer_pool_manager_->FetchPage(child_id);
+  if (child_page == nullptr)
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
+
+  // Writers below may hold the child's latch (they found it safe and let
+  // go of us), so it is not taken. They never touch the parent id, and
+  // the change is logged without moving the child's LSN: an absolute
+  // write redoes correctly whatever the page LSN says.
+  auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+  child->SetParentPageId(parent_id);
+  if (log_manager_ != nullptr) {
+    BTreeChange change;
+    change.page_id = child_id;
+    change.offset = BPlusTreePage::OFFSET_PARENT_PAGE_ID;
+    const char *bytes = reinterpret_cast<const char *>(&parent_id);
+    change.bytes.assign(bytes, bytes + sizeof(page_id_t));
+    AppendLog(LogRecordType::BTREE_WRITE, std::move(change), nullptr,
+              transaction);
+  }
+  buffer_pool_manager_->UnpinPage(child_id, true);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
                                       const KeyType &key,
                                       BPlusTreePage *new_node,
                                       Transaction *transaction) {
   if (old_node->IsRootPage()) {
-    page_id_t new_root_id;
-    Page *page = buffer_pool_manager_->NewPage(&new_root_id);
+    // The root keeps its page id (the catalog stores it): what is left of
+    // it moves to a new left child, and the root becomes their parent
+    page_id_t root_id = old_node->GetPageId();
+    page_id_t left_id;
+    Page *page = buffer_pool_manager_->NewPage(&left_id);
     if (page == nullptr)
       throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
 
-    auto *new_root = reinterpret_cast<
-        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(
-        page->GetData());
-    new_root->Init(new_root_id, INVALID_PAGE_ID, internal_max_size_);
-    new_root->PopulateNewRoot(old_node->GetPageId(), key,
-                              new_node->GetPageId());
+    auto *left = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    std::memcpy(page->GetData(), old_node, UsedBytes(old_node));
+    left->SetPageId(left_id);
+    left->SetParentPageId(root_id);
+    try {
+      if (!left->IsLeafPage())
+        AdoptChildren(reinterpret_cast<BPlusTreeInternalPage<
+                          KeyType, page_id_t, KeyComparator> *>(left),
+                      transaction);
+    } catch (Exception &e) {
+      buffer_pool_manager_->UnpinPage(left_id, true);
+      throw;
+    }
+    LogNode(left, transaction);
+    buffer_pool_manager_->UnpinPage(left_id, true);
+
+    new_node->SetParentPageId(root_id);
+    LogBytes(new_node, BPlusTreePage::OFFSET_PARENT_PAGE_ID, sizeof(page_id_t),
+             transaction);
 
-    old_node->SetParentPageId(new_root_id);
-    new_node->SetParentPageId(new_root_id);
+    auto *root = reinterpret_cast<
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(old_node);
+    root->Init(root_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(left_id, key, new_node->GetPageId());
+    LogNode(root, transaction);
 
-    root_page_id_ = new_root_id;
     depth_++;
-    buffer_pool_manager_->UnpinPage(new_root_id, true);
     return;
   }
 
@@ -392,10 +1092,12 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
 
   try {
     parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    LogEntry(LogRecordType::BTREE_INSERT, parent,
+             parent->ValueIndex(new_node->GetPageId()), transaction);
 
     if (parent->GetSize() > internal_max_size_) {
       BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *new_parent =
-          Split(parent);
+          Split(parent, transaction);
 
       try {
         InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction);
@@ -414,6 +1116,110 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
   buffer_pool_manager_->UnpinPage(parent_id, true);
 }
 
+/*****************************************************************************
+ * LOGGING
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::AppendLog(LogRecordType type, BTreeChange change,
+                               BPlusTreePage *node, Transaction *transaction) {
+  if (log_manager_ == nullptr)
+    return;
+
+  bool chained = transaction != nullptr &&
+                 transaction->GetTransactionId() != INVALID_TRANSACTION_ID;
+  LogRecord record(
+      chained ? transaction->GetTransactionId() : INVALID_TRANSACTION_ID,
+      chained ? transaction->GetPrevLSN() : INVALID_LSN, type,
+      std::move(change));
+  if (chained && transaction->GetUndoNextLSN() != INVALID_LSN) {
+    record.SetCLR(true);
+    record.SetUndoNextLSN(transaction->GetUndoNextLSN());
+  }
+
+  lsn_t lsn = log_manager_->AppendLogRecord(&record);
+  if (chained)
+    transaction->SetPrevLSN(lsn);
+  if (node != nullptr)
+    node->SetLSN(lsn);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LogBytes(BPlusTreePage *node, uint32_t offset,
+                              uint32_t length, Transaction *transaction) {
+  if (log_manager_ == nullptr)
+    return;
+
+  BTreeChange change;
+  change.page_id = node->GetPageId();
+  change.offset = offset;
+  const char *bytes = reinterpret_cast<const char *>(node) + offset;
+  change.bytes.assign(bytes, bytes + length);
+  AppendLog(LogRecordType::BTREE_WRITE, std::move(change), node, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LogNode(BPlusTreePage *node, Transaction *transaction) {
+  if (log_manager_ == nullptr)
+    return;
+
+  BTreeChange change;
+  change.page_id = node->GetPageId();
+  change.formats = true;
+  const char *bytes = reinterpret_cast<const char *>(node);
+  change.bytes.assign(bytes, bytes + UsedBytes(node));
+  AppendLog(LogRecordType::BTREE_WRITE, std::move(change), node, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LogEntry(LogRecordType type, BPlusTreePage *node,
+                              uint32_t index, Transaction *transaction,
+                              bool moved) {
+  if (log_manager_ == nullptr)
+    return;
+
+  BTreeChange change;
+  change.page_id = node->GetPageId();
+  change.offset = index;
+  const char *bytes;
+  size_t length;
+  if (node->IsLeafPage()) {
+    // Leaf entries are undone through the tree, so they say which one
+    if (!moved) {
+      change.root_page_id = root_page_id_;
+      change.key_columns = comparator_.GetColumns();
+    }
+    auto *leaf = reinterpret_cast<
+        BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(node);
+    bytes = reinterpret_cast<const char *>(&leaf->ItemAt(index));
+    length = sizeof(std::pair<KeyType, ValueType>);
+  } else {
+    auto *internal = reinterpret_cast<
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(node);
+    bytes = reinterpret_cast<const char *>(&internal->ItemAt(index));
+    length = sizeof(std::pair<KeyType, page_id_t>);
+  }
+  change.bytes.assign(bytes, bytes + length);
+  AppendLog(type, std::move(change), node, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LogKey(InternalPage *node, uint32_t index,
+                            Transaction *transaction) {
+  uint32_t offset = static_cast<uint32_t>(
+      reinterpret_cast<const char *>(&node->ItemAt(index).first) -
+      reinterpret_cast<const char *>(node));
+  LogBytes(node, offset, sizeof(KeyType), transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t BPLUSTREE_TYPE::UsedBytes(const BPlusTreePage *node) const {
+  if (node->IsLeafPage())
+    return LEAF_PAGE_HEADER_SIZE +
+           node->GetSize() * sizeof(std::pair<KeyType, ValueType>);
+  return INTERNAL_PAGE_HEADER_SIZE +
+         node->GetSize() * sizeof(std::pair<KeyType, page_id_t>);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Print(BufferPoolManager *bpm) {
   if (IsEmpty()) {
@@ -455,6 +1261,34 @@ void BPLUSTREE_TYPE::Print(BufferPoolManager *bpm) {
   std::cout << "\n";
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t BPLUSTREE_TYPE::GetPageCount() {
+  if (IsEmpty())
+    return 0;
+
+  uint32_t count = 0;
+  std::queue<page_id_t> q;
+  q.push(root_page_id_);
+  while (!q.empty()) {
+    page_id_t pid = q.front();
+    q.pop();
+
+    Page *page = buffer_pool_manager_->FetchPage(pid);
+    if (page == nullptr)
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Out of memory");
+    count++;
+
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (!node->IsLeafPage()) {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      for (uint32_t i = 0; i < internal->GetSize(); i++)
+        q.push(internal->ValueAt(i));
+    }
+    buffer_pool_manager_->UnpinPage(pid, false);
+  }
+  return count;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
   if (IsEmpty())
@@ -490,13 +1324,14 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() {
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::UnlockUnpinPages(Transaction *transaction) {
+void BPLUSTREE_TYPE::UnlockUnpinPages(Transaction *transaction,
+                                      bool is_dirty) {
   if (transaction == nullptr)
     return;
 
   for (Page *page : *transaction->GetPageSet()) {
     page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
   }
   transaction->GetPageSet()->clear();
 
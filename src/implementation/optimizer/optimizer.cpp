@@ -16,6 +16,10 @@
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/expressions/arithmetic_expression.h"
+
+#include <unordered_map>
 
 namespace tetodb {
 
@@ -171,6 +175,120 @@ namespace tetodb {
         return plan;
     }
 
+    // `val` as a value of a key column of type `type`, if an equality match
+    // on that column can be answered by an index lookup for it
+    static bool CastToKeyType(const Value& val, TypeId type, Value* out) {
+        if (val.IsNull()) return false;
+        TypeId from = val.GetTypeId();
+        if (from == type) {
+            *out = val;
+            return true;
+        }
+
+        bool from_integral = Value::IsNumeric(from) && from != TypeId::DECIMAL;
+        Value result;
+        bool exact = true;
+        switch (type) {
+        case TypeId::TINYINT:
+            if (!from_integral) return false;
+            result = Value(type, static_cast<int8_t>(val.CastAsBigInt()));
+            exact = static_cast<int64_t>(result.GetAsTinyInt()) == val.CastAsBigInt();
+            break;
+        case TypeId::SMALLINT:
+            if (!from_integral) return false;
+            result = Value(type, static_cast<int16_t>(val.CastAsBigInt()));
+            exact = static_cast<int64_t>(result.GetAsSmallInt()) == val.CastAsBigInt();
+            break;
+        case TypeId::INTEGER:
+            if (!from_integral) return false;
+            result = Value(type, static_cast<int32_t>(val.CastAsBigInt()));
+            exact = static_cast<int64_t>(result.GetAsInteger()) == val.CastAsBigInt();
+            break;
+        case TypeId::BIGINT:
+            if (!from_integral) return false;
+            result = Value(type, val.CastAsBigInt());
+            break;
+        case TypeId::DECIMAL:
+            if (!Value::IsNumeric(from)) return false;
+            result = Value(type, val.CastAsDouble());
+            break;
+        case TypeId::CHAR:
+        case TypeId::VARCHAR:
+            if (from != TypeId::CHAR && from != TypeId::VARCHAR) return false;
+            result = Value(type, val.GetAsString());
+            break;
+        default:
+            return false;
+        }
+        *out = result;
+        return exact;
+    }
+
+    // A literal, or arithmetic on literals only (the parser reads -5 as 0 - 5)
+    static bool IsConstantExpression(const AbstractExpression* expr) {
+        if (dynamic_cast<const ConstantValueExpression*>(expr)) return true;
+        if (!dynamic_cast<const ArithmeticExpression*>(expr)) return false;
+        for (const auto& child : expr->GetChildren()) {
+            if (!IsConstantExpression(child.get())) return false;
+        }
+        return true;
+    }
+
+    // Splits an AND tree into its conjuncts
+    static void CollectConjuncts(const AbstractExpression* expr,
+        std::vector<const AbstractExpression*>* conjuncts) {
+        const auto* logic_expr = dynamic_cast<const LogicExpression*>(expr);
+        if (logic_expr && logic_expr->GetLogicType() == LogicType::AND) {
+            CollectConjuncts(logic_expr->GetChildAt(0), conjuncts);
+            CollectConjuncts(logic_expr->GetChildAt(1), conjuncts);
+            return;
+        }
+        conjuncts->push_back(expr);
+    }
+
+    // What the conjuncts of a filter pin down about one column, as values
+    // of the column's type
+    struct ColumnRange {
+        bool has_equal = false;
+        Value equal;
+        bool has_lower = false;
+        Value lower;
+        bool lower_inclusive = true;
+        bool has_upper = false;
+        Value upper;
+        bool upper_inclusive = true;
+
+        // Keeps the tighter of the current lower bound and `val`
+        void AddLower(const Value& val, bool inclusive) {
+            if (!has_lower || val.CompareGreaterThan(lower) ||
+                (val.CompareEquals(lower) && !inclusive)) {
+                has_lower = true;
+                lower = val;
+                lower_inclusive = inclusive;
+            }
+        }
+
+        void AddUpper(const Value& val, bool inclusive) {
+            if (!has_upper || val.CompareLessThan(upper) ||
+                (val.CompareEquals(upper) && !inclusive)) {
+                has_upper = true;
+                upper = val;
+                upper_inclusive = inclusive;
+            }
+        }
+    };
+
+    // The comparison `b op a`, for `a op b`
+    static CompType FlipComparison(CompType type) {
+        switch (type) {
+        case CompType::LESS_THAN: return CompType::GREATER_THAN;
+        case CompType::GREATER_THAN: return CompType::LESS_THAN;
+        case CompType::LESS_THAN_OR_EQUAL: return CompType::GREATER_THAN_OR_EQUAL;
+        case CompType::GREATER_THAN_OR_EQUAL: return CompType::LESS_THAN_OR_EQUAL;
+        default: return type;
+        }
+    }
+
     const AbstractPlanNode* Optimizer::OptimizeSeqScanAsIndexScan(const AbstractPlanNode* plan) {
         if (plan->GetPlanType() != PlanType::Filter) return plan;
         const auto* filter_plan = static_cast<const FilterPlanNode*>(plan);
@@ -178,46 +296,163 @@ namespace tetodb {
         if (filter_plan->GetChildPlan()->GetPlanType() != PlanType::SeqScan) return plan;
         const auto* seq_scan = static_cast<const SeqScanPlanNode*>(filter_plan->GetChildPlan());
 
-        const auto* comp_expr = dynamic_cast<const ComparisonExpression*>(filter_plan->GetPredicate());
-        if (!comp_expr || comp_expr->GetCompType() != CompType::EQUAL) return plan;
-
-        const auto* col_expr = dynamic_cast<const ColumnValueExpression*>(comp_expr->GetChildAt(0));
-        const auto* const_expr = dynamic_cast<const ConstantValueExpression*>(comp_expr->GetChildAt(1));
-
-        if (!col_expr || !const_expr) return plan;
-
         table_oid_t table_oid = seq_scan->GetTableOid();
-        auto table_indexes = catalog_->GetTableIndexes(table_oid);
         TableMetadata* table_info = catalog_->GetTable(table_oid);
+        if (!table_info) return plan;
+        const Schema& table_schema = table_info->schema_;
+
+        // Every `column op constant` conjunct of the predicate (BETWEEN is
+        // planned as a pair of them), and `column LIKE 'prefix%'`, by column
+        std::vector<const AbstractExpression*> conjuncts;
+        CollectConjuncts(filter_plan->GetPredicate(), &conjuncts);
+
+        std::unordered_map<uint32_t, ColumnRange> ranges;
+        for (const auto* conjunct : conjuncts) {
+            const auto* comp_expr = dynamic_cast<const ComparisonExpression*>(conjunct);
+            if (!comp_expr) continue;
+            CompType comp_type = comp_expr->GetCompType();
+
+            const auto* col_expr = dynamic_cast<const ColumnValueExpression*>(comp_expr->GetChildAt(0));
+            const AbstractExpression* const_expr = comp_expr->GetChildAt(1);
+            if (!col_expr && comp_type != CompType::LIKE) {
+                col_expr = dynamic_cast<const ColumnValueExpression*>(comp_expr->GetChildAt(1));
+                const_expr = comp_expr->GetChildAt(0);
+                comp_type = FlipComparison(comp_type);
+            }
+            if (!col_expr || !IsConstantExpression(const_expr)) continue;
+
+            uint32_t col_idx = col_expr->GetColIdx();
+            if (col_idx >= table_schema.GetColumnCount()) continue;
+            Value bound;
+            if (!CastToKeyType(const_expr->Evaluate(nullptr, nullptr),
+                    table_schema.GetColumn(col_idx).GetTypeId(), &bound)) {
+                continue;
+            }
 
-        for (auto* index_info : table_indexes) {
-            if (index_info->key_attrs_.size() == 1 && index_info->key_attrs_[0] == col_expr->GetColIdx()) {
-
+            ColumnRange& range = ranges[col_idx];
+            switch (comp_type) {
+            case CompType::EQUAL:
+                if (!range.has_equal) {
+                    range.has_equal = true;
+                    range.equal = bound;
+                }
+                break;
+            case CompType::GREATER_THAN:
+                range.AddLower(bound, false);
+                break;
+            case CompType::GREATER_THAN_OR_EQUAL:
+                range.AddLower(bound, true);
+                break;
+            case CompType::LESS_THAN:
+                range.AddUpper(bound, false);
+                break;
+            case CompType::LESS_THAN_OR_EQUAL:
+                range.AddUpper(bound, true);
+                break;
+            case CompType::LIKE: {
+                // Matches start with the pattern's literal prefix: from that
+                // prefix up to (not including) the next string of its length
+                std::string pattern = bound.GetAsString();
+                std::string prefix = pattern.substr(0, pattern.find_first_of("%_"));
+                if (prefix.empty()) break;
+                TypeId type = bound.GetTypeId();
+                range.AddLower(Value(type, prefix), true);
+
+                while (!prefix.empty() && static_cast<unsigned char>(prefix.back()) == 0xFF) {
+                    prefix.pop_back();
+                }
+                if (!prefix.empty()) {
+                    prefix.back() = static_cast<char>(static_cast<unsigned char>(prefix.back()) + 1);
+                    range.AddUpper(Value(type, prefix), false);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
 
+        // The index whose key is matched the furthest: the most leading
+        // columns fixed by equalities, then a range on the next one
+        IndexMetadata* best_index = nullptr;
+        uint32_t best_equal = 0;
+        bool best_range = false;
+        for (auto* index_info : catalog_->GetTableIndexes(table_oid)) {
+            const auto& attrs = index_info->key_attrs_;
+            uint32_t equal = 0;
+            while (equal < attrs.size() && ranges.count(attrs[equal]) &&
+                   ranges[attrs[equal]].has_equal) {
+                equal++;
+            }
+            bool range = equal < attrs.size() && ranges.count(attrs[equal]) &&
+                (ranges[attrs[equal]].has_lower || ranges[attrs[equal]].has_upper);
 
-                // Extract constant value to query the B+ Tree
-                Value search_val = const_expr->Evaluate(nullptr, nullptr);
+            if (equal * 2 + range > best_equal * 2 + best_range) {
+                best_index = index_info;
+                best_equal = equal;
+                best_range = range;
+            }
+        }
+        if (!best_index) return plan;
 
-                // Pack the value into a Tuple using the schema of the indexed column
-                std::vector<Column> key_cols;
-                key_cols.push_back(table_info->schema_.GetColumn(col_expr->GetColIdx()));
-                Schema key_schema(key_cols);
-                Tuple key_tuple({ search_val }, &key_schema);
+        // Packs key values into a Tuple using the schema of those key columns
+        auto make_key = [&](const std::vector<Value>& values) {
+            std::vector<Column> key_cols;
+            for (size_t i = 0; i < values.size(); i++) {
+                key_cols.push_back(table_schema.GetColumn(best_index->key_attrs_[i]));
+            }
+            Schema key_schema(key_cols);
+            return Tuple(values, &key_schema);
+        };
 
-                auto index_scan = std::make_unique<IndexScanPlanNode>(
-                    filter_plan->OutputSchema(),
-                    index_info->oid_,
-                    table_oid,
-                    key_tuple
-                );
+        std::vector<Value> equal_values;
+        for (uint32_t i = 0; i < best_equal; i++) {
+            equal_values.push_back(ranges[best_index->key_attrs_[i]].equal);
+        }
 
-                const AbstractPlanNode* is_ptr = index_scan.get();
-                optimized_nodes_.push_back(std::move(index_scan));
-                return is_ptr;
-            }
+        std::unique_ptr<IndexScanPlanNode> index_scan;
+        if (!best_range) {
+            index_scan = std::make_unique<IndexScanPlanNode>(
+                filter_plan->OutputSchema(),
+                best_index->oid_,
+                table_oid,
+                make_key(equal_values),
+                best_equal
+            );
+        } else {
+            const ColumnRange& range = ranges[best_index->key_attrs_[best_equal]];
+            std::vector<Value> lower_values = equal_values;
+            std::vector<Value> upper_values = equal_values;
+            if (range.has_lower) lower_values.push_back(range.lower);
+            if (range.has_upper) upper_values.push_back(range.upper);
+
+            IndexBound lower{make_key(lower_values), static_cast<uint32_t>(lower_values.size()),
+                range.has_lower ? range.lower_inclusive : true};
+            IndexBound upper{make_key(upper_values), static_cast<uint32_t>(upper_values.size()),
+                range.has_upper ? range.upper_inclusive : true};
+            index_scan = std::make_unique<IndexScanPlanNode>(
+                filter_plan->OutputSchema(),
+                best_index->oid_,
+                table_oid,
+                std::move(lower),
+                std::move(upper)
+            );
+        }
+        const AbstractPlanNode* is_ptr = index_scan.get();
+        optimized_nodes_.push_back(std::move(index_scan));
+
+        // The lookup answers the whole predicate only if it is nothing but
+        // the equalities it used; otherwise the predicate is still checked
+        // per row (ranges included, as the key alone cannot tell NULLs apart)
+        if (!best_range && conjuncts.size() == best_equal) {
+            return is_ptr;
         }
 
-        return plan;
+        auto residual = std::make_unique<FilterPlanNode>(
+            filter_plan->OutputSchema(), is_ptr, filter_plan->GetPredicate());
+        const AbstractPlanNode* residual_ptr = residual.get();
+        optimized_nodes_.push_back(std::move(residual));
+        return residual_ptr;
     }
 
 } // namespace tetodb
\ No newline at end of file
@@ -23,7 +23,7 @@ const std::unordered_set<std::string> Lexer::keywords_ = {
     "HAVING",     "AVERAGE",    "MED",     "MEDIAN",    "BETWEEN",
     "IN",         "UPPER",      "LOWER",   "LENGTH",    "CONCAT",
     "SUBSTRING",  "DISTINCT",   "UNION",   "INTERSECT", "EXCEPT",
-    "WITH",       "VIEW"};
+    "WITH",       "VIEW",       "SHOW",    "REINDEX"};
 
 Lexer::Lexer(const std::string &input) : input_(input), cursor_(0) {}
 
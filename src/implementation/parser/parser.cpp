@@ -81,6 +81,8 @@ std::unique_ptr<ASTNode> Parser::ParseStatement() {
       return ParseDropView();
     throw std::runtime_error("Syntax Error: Unknown DROP statement type");
   }
+  if (Peek().value_ == "REINDEX")
+    return ParseReindex();
 
   if (Peek().value_ == "BEGIN") {
     Advance();
@@ -133,6 +135,12 @@ std::unique_ptr<ASTNode> Parser::ParseStatement() {
     return std::make_unique<SavepointStatement>(SavepointCmd::RELEASE, sp_name);
   }
 
+  if (Peek().value_ == "SET")
+    return ParseSet();
+
+  if (Peek().value_ == "SHOW")
+    return ParseShow();
+
   throw std::runtime_error("Syntax Error: Unknown statement type '" +
                            Peek().value_ + "'");
 }
@@ -349,6 +357,23 @@ std::unique_ptr<DropIndexStatement> Parser::ParseDropIndex() {
   return std::make_unique<DropIndexStatement>(index_name);
 }
 
+std::unique_ptr<ReindexStatement> Parser::ParseReindex() {
+  Consume(TokenType::KEYWORD, "Expected REINDEX");
+
+  bool is_table = Match(TokenType::KEYWORD, "TABLE");
+  if (!is_table && !Match(TokenType::KEYWORD, "INDEX"))
+    throw std::runtime_error("Expected INDEX or TABLE after REINDEX but found '" +
+                             Peek().value_ + "'");
+
+  Consume(TokenType::IDENTIFIER, "Expected index or table name");
+  std::string name = tokens_[cursor_ - 1].value_;
+
+  // Optional semicolon at the end
+  Match(TokenType::SYMBOL, ";");
+
+  return std::make_unique<ReindexStatement>(is_table, name);
+}
+
 std::unique_ptr<CreateIndexStatement> Parser::ParseCreateIndex() {
   auto stmt = std::make_unique<CreateIndexStatement>();
 
@@ -413,6 +438,59 @@ std::unique_ptr<DropViewStatement> Parser::ParseDropView() {
   return std::make_unique<DropViewStatement>(view_name);
 }
 
+// SET <name> { = | TO } <value>
+// <value> may be a number with an optional unit (256MB), a quoted string
+// ('25%'), or a bare word (on / off).
+std::unique_ptr<SetStatement> Parser::ParseSet() {
+  Consume(TokenType::KEYWORD, "Expected SET");
+
+  if (Peek().type_ != TokenType::IDENTIFIER &&
+      Peek().type_ != TokenType::KEYWORD) {
+    throw std::runtime_error("Expected setting name after SET");
+  }
+  std::string name = Advance().value_;
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+  if (!Match(TokenType::SYMBOL, "=") && !Match(TokenType::KEYWORD, "TO")) {
+    throw std::runtime_error("Expected '=' or TO after setting name");
+  }
+
+  std::string value;
+  if (Peek().type_ == TokenType::NUMBER) {
+    value = Advance().value_;
+    if (Peek().type_ == TokenType::IDENTIFIER) {
+      value += Advance().value_; // unit suffix
+    }
+  } else if (Peek().type_ == TokenType::STRING ||
+             Peek().type_ == TokenType::IDENTIFIER ||
+             Peek().type_ == TokenType::KEYWORD) {
+    value = Advance().value_;
+  } else {
+    throw std::runtime_error("Expected a value for setting '" + name + "'");
+  }
+
+  // Optional semicolon at the end
+  Match(TokenType::SYMBOL, ";");
+
+  return std::make_unique<SetStatement>(name, value);
+}
+
+std::unique_ptr<ShowStatement> Parser::ParseShow() {
+  Consume(TokenType::KEYWORD, "Expected SHOW");
+
+  if (Peek().type_ != TokenType::IDENTIFIER &&
+      Peek().type_ != TokenType::KEYWORD) {
+    throw std::runtime_error("Expected setting name after SHOW");
+  }
+  std::string name = Advance().value_;
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+  // Optional semicolon at the end
+  Match(TokenType::SYMBOL, ";");
+
+  return std::make_unique<ShowStatement>(name);
+}
+
 std::unique_ptr<SelectStatement> Parser::ParseSelect() {
   auto stmt = std::make_unique<SelectStatement>();
 
@@ -535,6 +535,23 @@ const AbstractPlanNode *Planner::PlanDelete(const DeleteStatement *stmt) {
 }
 
 // --- ALIAS RESOLUTION INJECTED HERE ---
+// A date string compared with a TIMESTAMP expression becomes a TIMESTAMP
+// constant, the way INSERT and UPDATE convert stored values
+static void CoerceTimestampLiteral(std::unique_ptr<AbstractExpression> &expr,
+                                   const AbstractExpression *other) {
+  if (other->GetReturnType() != TypeId::TIMESTAMP ||
+      !dynamic_cast<const ConstantValueExpression *>(expr.get())) {
+    return;
+  }
+  Value val = expr->Evaluate(nullptr, nullptr);
+  if (val.IsNull() || (val.GetTypeId() != TypeId::VARCHAR &&
+                       val.GetTypeId() != TypeId::CHAR)) {
+    return;
+  }
+  expr = std::make_unique<ConstantValueExpression>(
+      Value(TypeId::TIMESTAMP, Value::ParseTimestamp(val.GetAsString())));
+}
+
 std::unique_ptr<AbstractExpression> Planner::PlanExpression(
     const Expr *ast_expr, const Schema *schema,
     const std::unordered_map<std::string, std::string> &alias_map) {
@@ -591,11 +608,13 @@ std::unique_ptr<AbstractExpression> Planner::PlanExpression(
       bool b = (raw_str == "TRUE" || raw_str == "true");
       val = Value(TypeId::BOOLEAN, b);
     } else {
+      // A number only if all of it parses: '2024-06-15' stays a string
+      size_t parsed = 0;
       try {
         if (raw_str.find('.') != std::string::npos) {
-          val = Value(TypeId::DECIMAL, std::stod(raw_str));
+          val = Value(TypeId::DECIMAL, std::stod(raw_str, &parsed));
         } else {
-          int64_t v = std::stoll(raw_str);
+          int64_t v = std::stoll(raw_str, &parsed);
           if (v >= INT32_MIN && v <= INT32_MAX) {
             val = Value(TypeId::INTEGER, static_cast<int32_t>(v));
           } else {
@@ -603,6 +622,9 @@ std::unique_ptr<AbstractExpression> Planner::PlanExpression(
           }
         }
       } catch (...) {
+        parsed = 0;
+      }
+      if (parsed != raw_str.length()) {
         val = Value(TypeId::VARCHAR, raw_str);
       }
     }
@@ -660,6 +682,9 @@ std::unique_ptr<AbstractExpression> Planner::PlanExpression(
       throw std::runtime_error("Planner Error: Unsupported operator '" +
                                bin_expr->op_ + "'");
 
+    CoerceTimestampLiteral(left, right.get());
+    CoerceTimestampLiteral(right, left.get());
+
     return std::make_unique<ComparisonExpression>(it->second, std::move(left),
                                                   std::move(right));
   }
@@ -737,6 +762,8 @@ std::unique_ptr<AbstractExpression> Planner::PlanExpression(
 
     auto lower = PlanExpression(btw_expr->lower_.get(), schema, alias_map);
     auto upper = PlanExpression(btw_expr->upper_.get(), schema, alias_map);
+    CoerceTimestampLiteral(lower, target1.get());
+    CoerceTimestampLiteral(upper, target2.get());
 
     std::unique_ptr<AbstractExpression> comp1 =
         std::make_unique<ComparisonExpression>(CompType::GREATER_THAN_OR_EQUAL,
@@ -1,31 +1,61 @@
 // checkpoint_manager.cpp
 
 #include "recovery/checkpoint_manager.h"
+#include <algorithm>
 #include <iostream>
 
 namespace tetodb {
 
     void CheckpointManager::PerformCheckpoint() {
-        // 1. Grab the global transaction latch
-        std::unique_lock<std::shared_mutex> lock(txn_manager_->GetGlobalTxnLatch());
-
-        // ==========================================
-        // FIX: ENFORCE WRITE-AHEAD LOGGING (WAL)
-        // ==========================================
-        // You MUST flush the log buffer to disk BEFORE flushing the pages.
-        // If the engine crashes after pages are written but before logs are saved,
-        // uncommitted data is permanently stranded on disk.
+        // 1. BEGIN_CHECKPOINT, with the active transaction table as of that
+        //    exact point in the log. Transactions keep running throughout.
+        ActiveTxnTable att;
+        lsn_t oldest_txn_lsn;
+        lsn_t begin_lsn = log_manager_->AppendBeginCheckpoint(&att, &oldest_txn_lsn);
+
+        // 2. Dirty page table. Pages dirtied after BEGIN_CHECKPOINT are found
+        //    again by the analysis pass, so a fuzzy snapshot is enough.
+        DirtyPageTable dpt = bpm_->GetDirtyPageTable();
+
+        // 3. END_CHECKPOINT record(s), split so each one stays small
+        size_t txn_pos = 0;
+        size_t page_pos = 0;
+        bool last = false;
+        while (!last) {
+            size_t room = CHECKPOINT_ENTRIES_PER_RECORD;
+
+            size_t num_txns = std::min(room, att.size() - txn_pos);
+            ActiveTxnTable txn_chunk(att.begin() + txn_pos, att.begin() + txn_pos + num_txns);
+            txn_pos += num_txns;
+            room -= num_txns;
+
+            size_t num_pages = std::min(room, dpt.size() - page_pos);
+            DirtyPageTable page_chunk(dpt.begin() + page_pos, dpt.begin() + page_pos + num_pages);
+            page_pos += num_pages;
+
+            last = txn_pos == att.size() && page_pos == dpt.size();
+            LogRecord end_record(begin_lsn, std::move(txn_chunk), std::move(page_chunk), last);
+            log_manager_->AppendLogRecord(&end_record);
+        }
+
+        // 4. Only a checkpoint that reached the disk can shorten recovery.
+        //    No data pages are written here: the page cleaner and evictions
+        //    do that, and each advances the recLSNs the next checkpoint sees.
         log_manager_->Flush();
 
-        // 2. Now it is safe to flush pages to the physical disk
-        bpm_->FlushAllPages();
-
-        // 3. Write the CHECKPOINT record
-        LogRecord checkpoint_record(INVALID_TRANSACTION_ID, INVALID_LSN, LogRecordType::CHECKPOINT);
-        log_manager_->AppendLogRecord(&checkpoint_record);
-        log_manager_->Flush();
-
-        lock.unlock();
+        // 5. Recovery now starts at the oldest of: this checkpoint, the
+        //    oldest recLSN (redo) and the oldest active transaction's first
+        //    record (undo). Segments before that can go.
+        lsn_t start_lsn = begin_lsn;
+        for (const auto& [page_id, rec_lsn] : dpt) {
+            start_lsn = std::min(start_lsn, rec_lsn);
+        }
+        if (oldest_txn_lsn != INVALID_LSN) {
+            start_lsn = std::min(start_lsn, oldest_txn_lsn);
+        }
+        if (start_lsn != INVALID_LSN) {
+            log_manager_->TruncateLog(begin_lsn, start_lsn);
+        }
     }
 
-} // namespace tetodb
\ No newline at end of file
+} // namespace tetodb
@@ -0,0 +1,181 @@
+// log_compression.cpp
+
+#include "recovery/log_compression.h"
+#include <algorithm>
+#include <cstring>
+
+namespace tetodb {
+
+static constexpr uint32_t MIN_MATCH = 4;
+static constexpr uint32_t MAX_OFFSET = 65535;
+static constexpr int HASH_BITS = 12;
+
+static inline uint32_t Read32(const char *p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(uint32_t));
+  return v;
+}
+
+static inline uint32_t Hash(uint32_t v) {
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Lengths of 15 or more continue in extra bytes of 255 until a smaller one
+static void WriteLength(size_t length, std::vector<char> *dest) {
+  while (length >= 255) {
+    dest->push_back(static_cast<char>(255));
+    length -= 255;
+  }
+  dest->push_back(static_cast<char>(length));
+}
+
+static bool ReadLength(const unsigned char *&ip, const unsigned char *end,
+                       size_t *length) {
+  unsigned char byte;
+  do {
+    if (ip >= end) {
+      return false;
+    }
+    byte = *ip++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+// Token: literal count (high nibble), match length - MIN_MATCH (low nibble)
+static void EmitSequence(const char *literals, size_t literal_count,
+                         uint32_t offset, size_t match_length,
+                         std::vector<char> *dest) {
+  size_t match_code = match_length == 0 ? 0 : match_length - MIN_MATCH;
+  unsigned char token =
+      static_cast<unsigned char>((std::min<size_t>(literal_count, 15) << 4) |
+                                 std::min<size_t>(match_code, 15));
+  dest->push_back(static_cast<char>(token));
+  if (literal_count >= 15) {
+    WriteLength(literal_count - 15, dest);
+  }
+  dest->insert(dest->end(), literals, literals + literal_count);
+  if (match_length == 0) {
+    return; // Last sequence: literals only
+  }
+  dest->push_back(static_cast<char>(offset & 0xFF));
+  dest->push_back(static_cast<char>(offset >> 8));
+  if (match_code >= 15) {
+    WriteLength(match_code - 15, dest);
+  }
+}
+
+void LogCompression::Compress(const char *src, size_t size,
+                              std::vector<char> *dest) {
+  int32_t table[1 << HASH_BITS];
+  std::memset(table, -1, sizeof(table));
+
+  size_t anchor = 0;
+  size_t i = 0;
+  while (i + MIN_MATCH <= size) {
+    uint32_t h = Hash(Read32(src + i));
+    int32_t candidate = table[h];
+    table[h] = static_cast<int32_t>(i);
+
+    if (candidate < 0 || i - candidate > MAX_OFFSET ||
+        Read32(src + candidate) != Read32(src + i)) {
+      i++;
+      continue;
+    }
+
+    size_t length = MIN_MATCH;
+    while (i + length < size && src[candidate + length] == src[i + length]) {
+      length++;
+    }
+    EmitSequence(src + anchor, i - anchor, static_cast<uint32_t>(i - candidate),
+                 length, dest);
+    i += length;
+    anchor = i;
+  }
+  EmitSequence(src + anchor, size - anchor, 0, 0, dest);
+}
+
+bool LogCompression::Decompress(const char *src, size_t size, size_t raw_size,
+                                std::string *dest) {
+  const unsigned char *ip = reinterpret_cast<const unsigned char *>(src);
+  const unsigned char *end = ip + size;
+  size_t start = dest->size();
+
+  while (ip < end) {
+    unsigned char token = *ip++;
+
+    size_t literal_count = token >> 4;
+    if (literal_count == 15 && !ReadLength(ip, end, &literal_count)) {
+      return false;
+    }
+    if (literal_count > static_cast<size_t>(end - ip) ||
+        dest->size() - start + literal_count > raw_size) {
+      return false;
+    }
+    dest->append(reinterpret_cast<const char *>(ip), literal_count);
+    ip += literal_count;
+    if (ip == end) {
+      break; // Last sequence
+    }
+
+    if (end - ip < 2) {
+      return false;
+    }
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    size_t match_length = token & 0x0F;
+    if (match_length == 15 && !ReadLength(ip, end, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+
+    size_t produced = dest->size() - start;
+    if (offset == 0 || offset > produced ||
+        produced + match_length > raw_size) {
+      return false;
+    }
+    // Byte by byte: the match may overlap what it is copying
+    size_t from = dest->size() - offset;
+    for (size_t k = 0; k < match_length; k++) {
+      dest->push_back((*dest)[from + k]);
+    }
+  }
+  return dest->size() - start == raw_size;
+}
+
+std::string LogCompression::ExpandSegment(const std::string &file_bytes) {
+  std::string records;
+  size_t pos = 0;
+  while (pos + sizeof(uint32_t) <= file_bytes.size()) {
+    uint32_t word = Read32(file_bytes.data() + pos);
+
+    if (word == LOG_BLOCK_MAGIC) {
+      if (pos + LOG_BLOCK_HEADER_SIZE > file_bytes.size()) {
+        break;
+      }
+      uint32_t raw_size = Read32(file_bytes.data() + pos + 4);
+      uint32_t stored_size = Read32(file_bytes.data() + pos + 8);
+      pos += LOG_BLOCK_HEADER_SIZE;
+      if (stored_size > file_bytes.size() - pos) {
+        break; // Torn block
+      }
+      size_t before = records.size();
+      if (!Decompress(file_bytes.data() + pos, stored_size, raw_size,
+                      &records)) {
+        records.resize(before);
+        break;
+      }
+      pos += stored_size;
+    } else {
+      // A plain record: `word` is its size
+      if (word < sizeof(uint32_t) || word > file_bytes.size() - pos) {
+        break;
+      }
+      records.append(file_bytes, pos, word);
+      pos += word;
+    }
+  }
+  return records;
+}
+
+} // namespace tetodb
@@ -1,96 +1,327 @@
 // log_manager.cpp
 
 #include "recovery/log_manager.h"
-#include <cstring>
+#include "recovery/log_compression.h"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <vector>
 
 namespace tetodb {
 
-    LogManager::LogManager(DiskManager* disk_manager)
-        : disk_manager_(disk_manager) {
-        log_buffer_ = std::make_unique<char[]>(LOG_BUFFER_SIZE);
-        flush_buffer_ = std::make_unique<char[]>(LOG_BUFFER_SIZE);
+    // Smallest records are 40 bytes; this bounds the records in flight
+    static constexpr size_t BYTES_PER_SLOT = 64;
+
+    LogManager::LogManager(DiskManager* disk_manager, size_t buffer_size, bool compress)
+        : disk_manager_(disk_manager), compress_(compress) {
+        capacity_ = std::clamp(buffer_size, MIN_LOG_BUFFER_SIZE, MAX_LOG_BUFFER_SIZE);
+        max_ring_record_ = capacity_ / 4;
+        ring_ = std::make_unique<char[]>(capacity_);
+        staging_ = std::make_unique<char[]>(capacity_);
+        slot_count_ = 1;
+        while (slot_count_ * 2 <= capacity_ / BYTES_PER_SLOT) {
+            slot_count_ *= 2;
+        }
+        slots_ = std::make_unique<LogSlot[]>(slot_count_);
     }
 
     LogManager::~LogManager() {
         StopFlushThread();
+        for (size_t i = 0; i < slot_count_; i++) {
+            delete[] slots_[i].spill;
+        }
     }
 
-    lsn_t LogManager::AppendLogRecord(LogRecord* log_record) {
-        std::unique_lock<std::mutex> lock(latch_);
+    void LogManager::SetNextLSN(lsn_t next_lsn) {
+        uint32_t seq = flushed_seq_.load();
+        flushed_pos_ = static_cast<uint64_t>(next_lsn);
+        reserved_ = (static_cast<uint64_t>(seq) << 32) | static_cast<uint32_t>(next_lsn);
+        persistent_lsn_ = next_lsn - 1;
+    }
 
-        lsn_t lsn = next_lsn_++;
-        log_record->SetLSN(lsn);
+    lsn_t LogManager::GetNextLSN() const {
+        // flushed_pos_ first: it can only lag the reservation
+        uint64_t flushed_pos = flushed_pos_.load(std::memory_order_acquire);
+        uint64_t state = reserved_.load(std::memory_order_acquire);
+        return static_cast<lsn_t>(flushed_pos +
+            static_cast<uint32_t>(static_cast<uint32_t>(state) - static_cast<uint32_t>(flushed_pos)));
+    }
 
-        uint32_t size = LogRecord::CalculateSize(log_record->GetLogRecordType(),
-            log_record->GetOldTuple(),
-            log_record->GetNewTuple());
+    lsn_t LogManager::AppendLogRecord(LogRecord* log_record) {
+        uint32_t size = log_record->ComputeSize();
         log_record->SetSize(size);
+        bool spill = size > max_ring_record_;
+
+        // 1. RESERVE the byte range right after the last record (its
+        //    position is its LSN) and a sequence number, in one word
+        uint64_t state;
+        while (true) {
+            // Read what is flushed first: it can only lag the reservation
+            uint64_t flushed_pos = flushed_pos_.load(std::memory_order_acquire);
+            uint32_t flushed_seq = flushed_seq_.load(std::memory_order_acquire);
+            state = reserved_.load(std::memory_order_acquire);
+
+            uint32_t next_seq = static_cast<uint32_t>(state >> 32);
+            uint32_t next_pos = static_cast<uint32_t>(state);
+            uint32_t bytes_in_flight = next_pos - static_cast<uint32_t>(flushed_pos);
+            uint32_t records_in_flight = next_seq - flushed_seq;
 
-        assert(size <= LOG_BUFFER_SIZE && "Log record is too large for the buffer!");
+            if (records_in_flight < slot_count_ &&
+                (spill || bytes_in_flight + size <= capacity_)) {
+                uint64_t next = (static_cast<uint64_t>(next_seq + 1) << 32) |
+                    static_cast<uint32_t>(next_pos + size);
+                if (reserved_.compare_exchange_weak(state, next, std::memory_order_acq_rel)) {
+                    break;
+                }
+                continue;
+            }
 
-        // If active buffer is full, wake the flush thread and wait
-        while (log_buffer_offset_ + size >= LOG_BUFFER_SIZE) {
+            // The ring is full: wake the flush thread and wait for it
+            std::unique_lock<std::mutex> lock(latch_);
+            flush_requested_ = true;
             cv_.notify_one();
-            append_cv_.wait(lock);
+            append_cv_.wait_for(lock, LOG_FLUSH_INTERVAL, [&]() {
+                return flushed_seq_.load() != flushed_seq;
+                });
         }
 
-        uint32_t bytes_written = log_record->Serialize(log_buffer_.get() + log_buffer_offset_);
-        assert(bytes_written == size);
+        uint32_t seq = static_cast<uint32_t>(state >> 32);
+        // The flush thread cannot pass this record until it is filled, so
+        // the position is within 2^32 bytes of what it has flushed
+        uint64_t flushed_pos = flushed_pos_.load(std::memory_order_acquire);
+        uint64_t pos = flushed_pos +
+            static_cast<uint32_t>(static_cast<uint32_t>(state) - static_cast<uint32_t>(flushed_pos));
+        lsn_t lsn = static_cast<lsn_t>(pos);
 
-        log_buffer_offset_ += bytes_written;
+        log_record->SetLSN(lsn);
+        TrackTransaction(*log_record);
+
+        // 2. FILL the range, no lock held
+        LogSlot& slot = slots_[seq & (slot_count_ - 1)];
+        if (spill) {
+            slot.spill = new char[size];
+            log_record->Serialize(slot.spill);
+        } else {
+            size_t at = pos % capacity_;
+            if (at + size <= capacity_) {
+                uint32_t bytes_written = log_record->Serialize(ring_.get() + at);
+                assert(bytes_written == size);
+                (void)bytes_written;
+            } else {
+                // Wraps past the end of the ring
+                thread_local std::vector<char> scratch;
+                scratch.resize(size);
+                log_record->Serialize(scratch.data());
+                size_t first = capacity_ - at;
+                std::memcpy(ring_.get() + at, scratch.data(), first);
+                std::memcpy(ring_.get(), scratch.data() + first, size - first);
+            }
+        }
+        slot.end = pos + size;
 
+        // 3. PUBLISH: the flush thread may take it from here
+        slot.seq.store(seq, std::memory_order_release);
         return lsn;
     }
 
-    void LogManager::Flush() {
-        std::unique_lock<std::mutex> lock(latch_);
+    void LogManager::TrackTransaction(const LogRecord& log_record) {
+        txn_id_t txn_id = log_record.GetTxnId();
+        if (txn_id == INVALID_TRANSACTION_ID) return;
 
-        // FIX: A while loop prevents spurious wakeups and guarantees 
-        // the thread cannot exit until the data has physically cleared both RAM buffers.
-        while (log_buffer_offset_ > 0 || flush_buffer_offset_ > 0) {
+        TxnShard& shard = txn_shards_[static_cast<uint32_t>(txn_id) % TXN_SHARDS];
+        std::scoped_lock<std::mutex> lock(shard.latch);
 
-            // Wake the background thread to handle the flush
-            cv_.notify_one();
+        LogRecordType type = log_record.GetLogRecordType();
+        if (type == LogRecordType::COMMIT || type == LogRecordType::ABORT) {
+            if (type == LogRecordType::COMMIT) {
+                commits_appended_++;
+            }
+            if (shard.txns.erase(txn_id) > 0 && --active_txn_count_ == 0) {
+                cv_.notify_one(); // Nobody left to wait for (group commit)
+            }
+            return;
+        }
+
+        auto [it, inserted] = shard.txns.try_emplace(txn_id, log_record.GetLSN(), log_record.GetLSN());
+        if (inserted) {
+            active_txn_count_++;
+        } else {
+            it->second.second = log_record.GetLSN();
+        }
+    }
+
+    lsn_t LogManager::AppendBeginCheckpoint(ActiveTxnTable* att, lsn_t* oldest_lsn) {
+        LogRecord begin_record(INVALID_TRANSACTION_ID, INVALID_LSN, LogRecordType::BEGIN_CHECKPOINT);
+        lsn_t lsn = AppendLogRecord(&begin_record);
+
+        // Records are tracked before they are filled, and written only once
+        // filled: after this, every record before BEGIN_CHECKPOINT is in the
+        // table. Later ones may be too, which analysis tolerates.
+        WaitForLSN(lsn);
+
+        att->clear();
+        *oldest_lsn = INVALID_LSN;
+        for (auto& shard : txn_shards_) {
+            std::scoped_lock<std::mutex> lock(shard.latch);
+            for (const auto& [txn_id, lsns] : shard.txns) {
+                att->push_back({txn_id, lsns.second});
+                if (*oldest_lsn == INVALID_LSN || lsns.first < *oldest_lsn) {
+                    *oldest_lsn = lsns.first;
+                }
+            }
+        }
+        return lsn;
+    }
+
+    void LogManager::TruncateLog(lsn_t checkpoint_lsn, lsn_t start_lsn) {
+        LogMaster master;
+        master.checkpoint_lsn = checkpoint_lsn;
+        master.start_lsn = start_lsn;
+        disk_manager_->WriteLogMaster(master);
+        disk_manager_->RemoveLogSegmentsBefore(start_lsn);
+    }
+
+    void LogManager::WaitForLSN(lsn_t lsn) {
+        if (persistent_lsn_.load() >= lsn) return;
 
-            // Block the executor until the disk I/O is physically finished
+        std::unique_lock<std::mutex> lock(latch_);
+        while (persistent_lsn_.load() < lsn) {
+            flush_requested_ = true;
+            cv_.notify_one();
             flush_cv_.wait(lock);
         }
     }
 
-    void LogManager::RunFlushThread() {
-        if (enable_logging_) return;
-        enable_logging_ = true;
+    void LogManager::Flush() {
+        WaitForLSN(GetNextLSN() - 1);
+    }
 
-        flush_thread_ = std::thread([&]() {
-            while (enable_logging_) {
-                std::unique_lock<std::mutex> lock(latch_);
+    void LogManager::FlushReserved() {
+        uint32_t end_seq = static_cast<uint32_t>(reserved_.load() >> 32);
+        uint32_t seq = flushed_seq_.load();
+        if (seq == end_seq) return;
+        commits_flushed_ = commits_appended_.load();
 
-                // 1. Sleep until timeout (30ms Group Commit) OR buffer has data and is triggered
-                cv_.wait_for(lock, std::chrono::milliseconds(30), [&]() {
-                    return log_buffer_offset_ > 0 || !enable_logging_;
-                    });
+        uint64_t pos = flushed_pos_.load();
+        size_t staged = 0;
+        lsn_t staged_first_lsn = static_cast<lsn_t>(pos);
+        for (; seq != end_seq; seq++) {
+            LogSlot& slot = slots_[seq & (slot_count_ - 1)];
+            lsn_t lsn = static_cast<lsn_t>(pos);
 
-                if (log_buffer_offset_ > 0) {
-                    // 2. SWAP THE BUFFERS!
-                    std::swap(log_buffer_, flush_buffer_);
-                    flush_buffer_offset_ = log_buffer_offset_;
-                    log_buffer_offset_ = 0;
+            // Reserved but not filled yet: its appender is copying it in
+            while (slot.seq.load(std::memory_order_acquire) != seq) {
+                std::this_thread::yield();
+            }
 
-                    // Wake up any threads blocked in AppendLogRecord
-                    append_cv_.notify_all();
+            size_t size = slot.end - pos;
+            if (slot.spill != nullptr) {
+                if (staged > 0) {
+                    WriteBlock(staging_.get(), staged, staged_first_lsn);
+                    staged = 0;
+                }
+                WriteBlock(slot.spill, size, lsn);
+                delete[] slot.spill;
+                slot.spill = nullptr;
+            } else {
+                if (staged == 0) {
+                    staged_first_lsn = lsn;
+                }
+                size_t at = pos % capacity_;
+                size_t first = std::min(size, capacity_ - at);
+                std::memcpy(staging_.get() + staged, ring_.get() + at, first);
+                std::memcpy(staging_.get() + staged + first, ring_.get(), size - first);
+                staged += size;
+            }
+            pos = slot.end;
+        }
+        if (staged > 0) {
+            WriteBlock(staging_.get(), staged, staged_first_lsn);
+        }
 
-                    // 3. WRITE TO DISK (Drop the lock so executors can append to the new active buffer!)
-                    lock.unlock();
+        flushed_pos_.store(pos, std::memory_order_release);
+        flushed_seq_.store(end_seq, std::memory_order_release);
+        persistent_lsn_ = static_cast<lsn_t>(pos) - 1;
 
-                    disk_manager_->WriteLog(flush_buffer_.get(), flush_buffer_offset_);
+        // Wake appenders waiting for space and committers waiting for disk
+        { std::scoped_lock<std::mutex> lock(latch_); }
+        append_cv_.notify_all();
+        flush_cv_.notify_all();
+    }
 
-                    lock.lock();
-                    flush_buffer_offset_ = 0;
+    void LogManager::WriteBlock(const char* data, size_t size, lsn_t first_lsn) {
+        bytes_logged_ += size;
+        if (compress_ && size >= LOG_BLOCK_MIN_SIZE) {
+            compressed_.resize(LOG_BLOCK_HEADER_SIZE);
+            LogCompression::Compress(data, size, &compressed_);
+            uint32_t header[3] = {LOG_BLOCK_MAGIC, static_cast<uint32_t>(size),
+                                  static_cast<uint32_t>(compressed_.size() - LOG_BLOCK_HEADER_SIZE)};
+            std::memcpy(compressed_.data(), header, LOG_BLOCK_HEADER_SIZE);
 
-                    // 4. FIX: Notify threads blocked in Flush() that data is safely on disk
-                    flush_cv_.notify_all();
+            // Incompressible data is written plain
+            if (compressed_.size() < size) {
+                disk_manager_->WriteLog(compressed_.data(), static_cast<int>(compressed_.size()), first_lsn);
+                bytes_written_ += compressed_.size();
+                return;
+            }
+        }
+        disk_manager_->WriteLog(data, static_cast<int>(size), first_lsn);
+        bytes_written_ += size;
+    }
+
+    void LogManager::GroupCommitWait(std::unique_lock<std::mutex>& lock) {
+        auto window = std::chrono::microseconds(group_commit_window_us_.load());
+        uint64_t commits_before = commits_appended_.load();
+
+        // Only running transactions can add commits to this write
+        if (window.count() > 0 && active_txn_count_.load() > 0) {
+            cv_.wait_for(lock, window, [&]() {
+                uint32_t bytes_in_flight = static_cast<uint32_t>(reserved_.load()) -
+                    static_cast<uint32_t>(flushed_pos_.load());
+                return active_txn_count_.load() == 0 || bytes_in_flight >= capacity_ / 2 ||
+                    !enable_logging_;
+                });
+        }
+
+        uint64_t commits_now = commits_appended_.load();
+        if (commits_now > commits_before) {
+            window = std::min(std::max(window * 2, GROUP_COMMIT_MIN_WINDOW), GROUP_COMMIT_MAX_WINDOW);
+        } else if (window.count() == 0 && commits_now - commits_flushed_ > 1) {
+            window = GROUP_COMMIT_MIN_WINDOW; // Commits already arrive together
+        } else {
+            window /= 2;
+            if (window < GROUP_COMMIT_MIN_WINDOW) window = std::chrono::microseconds(0);
+        }
+        group_commit_window_us_ = window.count();
+    }
+
+    void LogManager::RunFlushThread() {
+        if (enable_logging_) return;
+        enable_logging_ = true;
+
+        flush_thread_ = std::thread([&]() {
+            while (enable_logging_) {
+                {
+                    std::unique_lock<std::mutex> lock(latch_);
+                    auto pending = [&]() {
+                        return static_cast<uint32_t>(reserved_.load() >> 32) != flushed_seq_.load();
+                    };
+
+                    // 1. Sleep until someone waits on the log, or for at most
+                    //    the background flush interval
+                    cv_.wait_for(lock, LOG_FLUSH_INTERVAL, [&]() {
+                        return (flush_requested_ && pending()) || !enable_logging_;
+                        });
+
+                    if (flush_requested_ && pending()) {
+                        GroupCommitWait(lock);
+                    }
+                    flush_requested_ = false;
                 }
+
+                // 2. WRITE everything reserved so far (latch released, so
+                //    executors keep appending into the rest of the ring)
+                FlushReserved();
             }
         });
     }
@@ -98,7 +329,7 @@ namespace tetodb {
     void LogManager::StopFlushThread() {
         if (!enable_logging_) return;
 
-        Flush(); // Flush anything left in the active buffer
+        Flush(); // Flush anything left in the ring
 
         enable_logging_ = false;
         cv_.notify_all(); // Wake the thread to exit the loop
@@ -108,4 +339,4 @@ namespace tetodb {
         }
     }
 
-} // namespace tetodb
\ No newline at end of file
+} // namespace tetodb
@@ -1,18 +1,152 @@
 // log_record.cpp
 
 #include "recovery/log_record.h"
+#include <algorithm>
 #include <cstring>
 
 namespace tetodb {
 
+// ==========================================
+// TUPLE DELTAS
+// ==========================================
+// offset + old length + new length
+static constexpr uint32_t DELTA_RANGE_HEADER = 3 * sizeof(uint32_t);
+
+TupleDelta TupleDelta::Diff(const Tuple &old_tuple, const Tuple &new_tuple) {
+  TupleDelta delta;
+  delta.old_size = old_tuple.GetSize();
+  delta.new_size = new_tuple.GetSize();
+  const char *a = old_tuple.GetData();
+  const char *b = new_tuple.GetData();
+
+  auto add_range = [&](uint32_t offset, uint32_t old_end, uint32_t new_end) {
+    Range range;
+    range.offset = offset;
+    range.old_bytes.assign(a + offset, a + old_end);
+    range.new_bytes.assign(b + offset, b + new_end);
+    delta.ranges.push_back(std::move(range));
+  };
+
+  if (delta.old_size != delta.new_size) {
+    uint32_t common = std::min(delta.old_size, delta.new_size);
+    uint32_t prefix = 0;
+    while (prefix < common && a[prefix] == b[prefix]) {
+      prefix++;
+    }
+    uint32_t suffix = 0;
+    while (suffix < common - prefix &&
+           a[delta.old_size - 1 - suffix] == b[delta.new_size - 1 - suffix]) {
+      suffix++;
+    }
+    add_range(prefix, delta.old_size - suffix, delta.new_size - suffix);
+    return delta;
+  }
+
+  uint32_t size = delta.old_size;
+  uint32_t i = 0;
+  while (i < size) {
+    if (a[i] == b[i]) {
+      i++;
+      continue;
+    }
+    uint32_t start = i;
+    uint32_t end = i + 1;
+    while (end < size) {
+      if (a[end] != b[end]) {
+        end++;
+        continue;
+      }
+      // Bridge a short unchanged gap: a new range would cost more
+      uint32_t gap_end = end;
+      while (gap_end < size && a[gap_end] == b[gap_end]) {
+        gap_end++;
+      }
+      if (gap_end == size || gap_end - end >= DELTA_RANGE_HEADER) {
+        break;
+      }
+      end = gap_end;
+    }
+    add_range(start, end, end);
+    i = end;
+  }
+  return delta;
+}
+
+bool TupleDelta::Apply(const Tuple &old_tuple, Tuple *new_tuple) const {
+  if (old_tuple.GetSize() != old_size) {
+    return false;
+  }
+  const char *src = old_tuple.GetData();
+  std::vector<char> out;
+  out.reserve(new_size);
+
+  uint32_t cursor = 0;
+  for (const auto &range : ranges) {
+    uint32_t old_len = static_cast<uint32_t>(range.old_bytes.size());
+    if (range.offset < cursor || range.offset + old_len > old_size ||
+        (old_len > 0 &&
+         std::memcmp(src + range.offset, range.old_bytes.data(), old_len) != 0)) {
+      return false;
+    }
+    out.insert(out.end(), src + cursor, src + range.offset);
+    out.insert(out.end(), range.new_bytes.begin(), range.new_bytes.end());
+    cursor = range.offset + old_len;
+  }
+  out.insert(out.end(), src + cursor, src + old_size);
+  if (out.size() != new_size) {
+    return false;
+  }
+
+  new_tuple->DeserializeFrom(out.data(), new_size);
+  new_tuple->SetRid(old_tuple.GetRid());
+  return true;
+}
+
+TupleDelta TupleDelta::Inverse() const {
+  TupleDelta inverse;
+  inverse.old_size = new_size;
+  inverse.new_size = old_size;
+  int64_t shift = 0; // How far the new image has moved bytes so far
+  for (const auto &range : ranges) {
+    Range back;
+    back.offset = static_cast<uint32_t>(range.offset + shift);
+    back.old_bytes = range.new_bytes;
+    back.new_bytes = range.old_bytes;
+    shift += static_cast<int64_t>(range.new_bytes.size()) -
+             static_cast<int64_t>(range.old_bytes.size());
+    inverse.ranges.push_back(std::move(back));
+  }
+  return inverse;
+}
+
+uint32_t TupleDelta::SerializedSize() const {
+  // old size + new size + range count
+  uint32_t size = 3 * sizeof(uint32_t);
+  for (const auto &range : ranges) {
+    size += DELTA_RANGE_HEADER;
+    size += static_cast<uint32_t>(range.old_bytes.size() + range.new_bytes.size());
+  }
+  return size;
+}
+
+// page_id + offset + root_page_id + key column count + byte count + formats
+static constexpr uint32_t BTREE_CHANGE_HEADER = 6 * sizeof(uint32_t);
+// type + offset + length
+static constexpr uint32_t KEY_COLUMN_SIZE =
+    sizeof(uint32_t) + 2 * sizeof(uint16_t);
+
+uint32_t BTreeChange::SerializedSize() const {
+  return BTREE_CHANGE_HEADER +
+         static_cast<uint32_t>(key_columns.size()) * KEY_COLUMN_SIZE +
+         static_cast<uint32_t>(bytes.size());
+}
+
 // ==========================================
 // SIZE CALCULATION
 // ==========================================
 uint32_t LogRecord::CalculateSize(LogRecordType type, const Tuple &old_tuple,
                                   const Tuple &new_tuple) {
-  // Standard Header Size: size (4) + lsn (4) + txn_id (4) + prev_lsn (4) + type
-  // (4) + is_clr (4) + undo_next_lsn (4) = 28 bytes
-  uint32_t size = 28;
+  uint32_t size = LOG_RECORD_HEADER_SIZE;
 
   switch (type) {
   case LogRecordType::INSERT:
@@ -38,7 +172,12 @@ uint32_t LogRecord::CalculateSize(LogRecordType type, const Tuple &old_tuple,
   case LogRecordType::BEGIN:
   case LogRecordType::COMMIT:
   case LogRecordType::ABORT:
-    // No payload! Just the 28-byte header.
+  case LogRecordType::BEGIN_CHECKPOINT:
+    // No payload! Just the header.
+    break;
+  case LogRecordType::END_CHECKPOINT:
+    // is_last + the two table counts; the entries are added by ComputeSize()
+    size += 3 * sizeof(uint32_t);
     break;
 
   default:
@@ -47,6 +186,23 @@ uint32_t LogRecord::CalculateSize(LogRecordType type, const Tuple &old_tuple,
   return size;
 }
 
+uint32_t LogRecord::ComputeSize() const {
+  uint32_t size = CalculateSize(log_record_type_, old_tuple_, new_tuple_);
+  if (log_record_type_ == LogRecordType::UPDATE_DELTA) {
+    size += sizeof(RID) + delta_.SerializedSize();
+  } else if (log_record_type_ == LogRecordType::BTREE_WRITE ||
+             log_record_type_ == LogRecordType::BTREE_INSERT ||
+             log_record_type_ == LogRecordType::BTREE_DELETE) {
+    size += btree_change_.SerializedSize();
+  } else if (log_record_type_ == LogRecordType::END_CHECKPOINT) {
+    size += static_cast<uint32_t>(active_txns_.size() *
+                                  (sizeof(txn_id_t) + sizeof(lsn_t)));
+    size += static_cast<uint32_t>(dirty_pages_.size() *
+                                  (sizeof(page_id_t) + sizeof(lsn_t)));
+  }
+  return size;
+}
+
 // ==========================================
 // SERIALIZATION (C++ Object -> Raw Bytes)
 // ==========================================
@@ -103,11 +259,83 @@ uint32_t LogRecord::Serialize(char *dest) const {
     offset += sizeof(uint32_t);
     new_tuple_.SerializeTo(dest + offset);
     offset += new_size;
+  } else if (log_record_type_ == LogRecordType::UPDATE_DELTA) {
+    std::memcpy(dest + offset, &target_rid_, sizeof(RID));
+    offset += sizeof(RID);
+
+    uint32_t num_ranges = static_cast<uint32_t>(delta_.ranges.size());
+    for (uint32_t value : {delta_.old_size, delta_.new_size, num_ranges}) {
+      std::memcpy(dest + offset, &value, sizeof(uint32_t));
+      offset += sizeof(uint32_t);
+    }
+    for (const auto &range : delta_.ranges) {
+      uint32_t old_len = static_cast<uint32_t>(range.old_bytes.size());
+      uint32_t new_len = static_cast<uint32_t>(range.new_bytes.size());
+      for (uint32_t value : {range.offset, old_len, new_len}) {
+        std::memcpy(dest + offset, &value, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+      }
+      std::memcpy(dest + offset, range.old_bytes.data(), old_len);
+      offset += old_len;
+      std::memcpy(dest + offset, range.new_bytes.data(), new_len);
+      offset += new_len;
+    }
+  } else if (log_record_type_ == LogRecordType::BTREE_WRITE ||
+             log_record_type_ == LogRecordType::BTREE_INSERT ||
+             log_record_type_ == LogRecordType::BTREE_DELETE) {
+    const BTreeChange &change = btree_change_;
+    uint32_t num_columns = static_cast<uint32_t>(change.key_columns.size());
+    uint32_t num_bytes = static_cast<uint32_t>(change.bytes.size());
+    uint32_t formats = change.formats ? 1 : 0;
+    std::memcpy(dest + offset, &change.page_id, sizeof(page_id_t));
+    offset += sizeof(page_id_t);
+    std::memcpy(dest + offset, &change.offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    std::memcpy(dest + offset, &change.root_page_id, sizeof(page_id_t));
+    offset += sizeof(page_id_t);
+    for (uint32_t value : {num_columns, num_bytes, formats}) {
+      std::memcpy(dest + offset, &value, sizeof(uint32_t));
+      offset += sizeof(uint32_t);
+    }
+    for (const KeyColumn &column : change.key_columns) {
+      uint32_t type_id = static_cast<uint32_t>(column.type_id_);
+      std::memcpy(dest + offset, &type_id, sizeof(uint32_t));
+      offset += sizeof(uint32_t);
+      std::memcpy(dest + offset, &column.offset_, sizeof(uint16_t));
+      offset += sizeof(uint16_t);
+      std::memcpy(dest + offset, &column.length_, sizeof(uint16_t));
+      offset += sizeof(uint16_t);
+    }
+    std::memcpy(dest + offset, change.bytes.data(), num_bytes);
+    offset += num_bytes;
   } else if (log_record_type_ == LogRecordType::NEWPAGE) {
     std::memcpy(dest + offset, &target_rid_, sizeof(RID));
     offset += sizeof(RID);
     std::memcpy(dest + offset, &prev_page_id_, sizeof(page_id_t));
     offset += sizeof(page_id_t);
+  } else if (log_record_type_ == LogRecordType::END_CHECKPOINT) {
+    std::memcpy(dest + offset, &is_last_checkpoint_record_, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+
+    uint32_t num_txns = static_cast<uint32_t>(active_txns_.size());
+    std::memcpy(dest + offset, &num_txns, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    for (const auto &[txn_id, last_lsn] : active_txns_) {
+      std::memcpy(dest + offset, &txn_id, sizeof(txn_id_t));
+      offset += sizeof(txn_id_t);
+      std::memcpy(dest + offset, &last_lsn, sizeof(lsn_t));
+      offset += sizeof(lsn_t);
+    }
+
+    uint32_t num_pages = static_cast<uint32_t>(dirty_pages_.size());
+    std::memcpy(dest + offset, &num_pages, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    for (const auto &[page_id, rec_lsn] : dirty_pages_) {
+      std::memcpy(dest + offset, &page_id, sizeof(page_id_t));
+      offset += sizeof(page_id_t);
+      std::memcpy(dest + offset, &rec_lsn, sizeof(lsn_t));
+      offset += sizeof(lsn_t);
+    }
   }
 
   return offset;
@@ -169,11 +397,89 @@ uint32_t LogRecord::Deserialize(const char *src) {
     offset += sizeof(uint32_t);
     new_tuple_.DeserializeFrom(src + offset, new_size);
     offset += new_size;
+  } else if (log_record_type_ == LogRecordType::UPDATE_DELTA) {
+    std::memcpy(&target_rid_, src + offset, sizeof(RID));
+    offset += sizeof(RID);
+
+    uint32_t num_ranges = 0;
+    for (uint32_t *value : {&delta_.old_size, &delta_.new_size, &num_ranges}) {
+      std::memcpy(value, src + offset, sizeof(uint32_t));
+      offset += sizeof(uint32_t);
+    }
+    delta_.ranges.resize(num_ranges);
+    for (auto &range : delta_.ranges) {
+      uint32_t old_len = 0;
+      uint32_t new_len = 0;
+      for (uint32_t *value : {&range.offset, &old_len, &new_len}) {
+        std::memcpy(value, src + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+      }
+      range.old_bytes.assign(src + offset, src + offset + old_len);
+      offset += old_len;
+      range.new_bytes.assign(src + offset, src + offset + new_len);
+      offset += new_len;
+    }
+  } else if (log_record_type_ == LogRecordType::BTREE_WRITE ||
+             log_record_type_ == LogRecordType::BTREE_INSERT ||
+             log_record_type_ == LogRecordType::BTREE_DELETE) {
+    BTreeChange &change = btree_change_;
+    uint32_t num_columns = 0;
+    uint32_t num_bytes = 0;
+    uint32_t formats = 0;
+    std::memcpy(&change.page_id, src + offset, sizeof(page_id_t));
+    offset += sizeof(page_id_t);
+    std::memcpy(&change.offset, src + offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    std::memcpy(&change.root_page_id, src + offset, sizeof(page_id_t));
+    offset += sizeof(page_id_t);
+    for (uint32_t *value : {&num_columns, &num_bytes, &formats}) {
+      std::memcpy(value, src + offset, sizeof(uint32_t));
+      offset += sizeof(uint32_t);
+    }
+    change.formats = formats != 0;
+    change.key_columns.resize(num_columns);
+    for (KeyColumn &column : change.key_columns) {
+      uint32_t type_id = 0;
+      std::memcpy(&type_id, src + offset, sizeof(uint32_t));
+      offset += sizeof(uint32_t);
+      column.type_id_ = static_cast<TypeId>(type_id);
+      std::memcpy(&column.offset_, src + offset, sizeof(uint16_t));
+      offset += sizeof(uint16_t);
+      std::memcpy(&column.length_, src + offset, sizeof(uint16_t));
+      offset += sizeof(uint16_t);
+    }
+    change.bytes.assign(src + offset, src + offset + num_bytes);
+    offset += num_bytes;
   } else if (log_record_type_ == LogRecordType::NEWPAGE) {
     std::memcpy(&target_rid_, src + offset, sizeof(RID));
     offset += sizeof(RID);
     std::memcpy(&prev_page_id_, src + offset, sizeof(page_id_t));
     offset += sizeof(page_id_t);
+  } else if (log_record_type_ == LogRecordType::END_CHECKPOINT) {
+    std::memcpy(&is_last_checkpoint_record_, src + offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+
+    uint32_t num_txns = 0;
+    std::memcpy(&num_txns, src + offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    active_txns_.resize(num_txns);
+    for (auto &[txn_id, last_lsn] : active_txns_) {
+      std::memcpy(&txn_id, src + offset, sizeof(txn_id_t));
+      offset += sizeof(txn_id_t);
+      std::memcpy(&last_lsn, src + offset, sizeof(lsn_t));
+      offset += sizeof(lsn_t);
+    }
+
+    uint32_t num_pages = 0;
+    std::memcpy(&num_pages, src + offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    dirty_pages_.resize(num_pages);
+    for (auto &[page_id, rec_lsn] : dirty_pages_) {
+      std::memcpy(&page_id, src + offset, sizeof(page_id_t));
+      offset += sizeof(page_id_t);
+      std::memcpy(&rec_lsn, src + offset, sizeof(lsn_t));
+      offset += sizeof(lsn_t);
+    }
   }
 
   return offset;
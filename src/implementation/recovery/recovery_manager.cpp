@@ -1,167 +1,544 @@
 // recovery_manager.cpp
 
 #include "recovery/recovery_manager.h"
+#include "index/b_plus_tree.h"
+#include "index/generic_key.h"
+#include "recovery/log_compression.h"
 #include "storage/page/page_guard.h"
+#include <algorithm>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
 namespace tetodb {
 
+std::istringstream
+RecoveryManager::OpenSegment(const std::filesystem::path &path) {
+  std::ifstream file(path, std::ios::binary);
+  std::string bytes((std::istreambuf_iterator<char>(file)),
+                    std::istreambuf_iterator<char>());
+  return std::istringstream(LogCompression::ExpandSegment(bytes));
+}
+
+bool RecoveryManager::ReadLogRecord(std::istream &log_file,
+                                    LogRecord *log_record,
+                                    uint32_t *record_size) {
+  // 1. Peek at the first 4 bytes (the size of the record)
+  char size_buf[sizeof(uint32_t)];
+  if (!log_file.read(size_buf, sizeof(uint32_t))) {
+    return false; // Clean EOF
+  }
+  std::memcpy(record_size, size_buf, sizeof(uint32_t));
+
+  // ==========================================
+  // FIX 1: PARTIAL CRASH WRITE PROTECTION
+  // ==========================================
+  // If the power was cut mid-write, the record size will be garbage.
+  // Minimum is the header alone. Max is roughly PAGE_SIZE.
+  if (*record_size < LOG_RECORD_HEADER_SIZE || *record_size > PAGE_SIZE * 2) {
+    std::cout << "[RECOVERY] Encountered partial/corrupted log record at end "
+                 "of segment."
+              << std::endl;
+    return false;
+  }
+
+  std::vector<char> buffer(*record_size);
+  std::memcpy(buffer.data(), record_size, sizeof(uint32_t));
+
+  // If the payload is truncated, read will fail safely
+  if (!log_file.read(buffer.data() + sizeof(uint32_t),
+                     *record_size - sizeof(uint32_t))) {
+    std::cout << "[RECOVERY] Log payload truncated. Halting Analysis."
+              << std::endl;
+    return false;
+  }
+
+  log_record->Deserialize(buffer.data());
+  return true;
+}
+
+std::vector<page_id_t>
+RecoveryManager::PagesTouched(const LogRecord &log_record) {
+  switch (log_record.GetLogRecordType()) {
+  case LogRecordType::NEWPAGE:
+    if (log_record.GetPrevPageId() != INVALID_PAGE_ID) {
+      return {log_record.GetTargetRID().GetPageId(),
+              log_record.GetPrevPageId()};
+    }
+    return {log_record.GetTargetRID().GetPageId()};
+  case LogRecordType::INSERT:
+  case LogRecordType::MARKDELETE:
+  case LogRecordType::ROLLBACKDELETE:
+  case LogRecordType::APPLYDELETE:
+  case LogRecordType::UPDATE:
+  case LogRecordType::UPDATE_DELTA:
+    return {log_record.GetTargetRID().GetPageId()};
+  case LogRecordType::BTREE_WRITE:
+  case LogRecordType::BTREE_INSERT:
+  case LogRecordType::BTREE_DELETE:
+    return {log_record.GetBTreeChange().page_id};
+  default:
+    return {};
+  }
+}
+
+bool RecoveryManager::ReadLogRecordAt(lsn_t lsn, LogRecord *log_record) {
+  // Segments are few, so a linear search is fine
+  size_t index = 0;
+  while (index < segments_.size() && segments_[index].end <= lsn) {
+    index++;
+  }
+  if (index == segments_.size() || lsn < segments_[index].begin) {
+    return false;
+  }
+
+  if (read_segment_ != index + 1) {
+    read_file_ = OpenSegment(segments_[index].path);
+    read_segment_ = index + 1;
+  }
+  read_file_.clear();
+  read_file_.seekg(lsn - segments_[index].begin);
+
+  uint32_t record_size;
+  return ReadLogRecord(read_file_, log_record, &record_size) &&
+         log_record->GetLSN() == lsn;
+}
+
+template <typename F> lsn_t RecoveryManager::ScanLog(lsn_t lsn, F &&visit) {
+  LogRecord log_record;
+  uint32_t record_size = 0;
+  lsn_t position = lsn;
+  for (const auto &segment : segments_) {
+    if (segment.end <= lsn) {
+      continue;
+    }
+    std::istringstream log_file = OpenSegment(segment.path);
+    position = std::max(lsn, segment.begin);
+    log_file.seekg(position - segment.begin);
+    // A record not at the position its LSN names is a torn write's leftover
+    while (position < segment.end &&
+           ReadLogRecord(log_file, &log_record, &record_size) &&
+           log_record.GetLSN() == position) {
+      visit(log_record);
+      position += record_size;
+    }
+  }
+  return position;
+}
+
 void RecoveryManager::Redo() {
-  std::ifstream log_file(log_file_name_, std::ios::binary);
-  if (!log_file.is_open()) {
+  std::vector<LogSegment> segments = disk_manager_->GetLogSegments();
+  if (segments.empty()) {
     std::cout << "[RECOVERY] No log file found. Starting fresh." << std::endl;
     return;
   }
 
   std::cout << "[RECOVERY] Phase 1 & 2: Analysis and Redo Started..."
             << std::endl;
-  uint32_t offset = 0;
-  lsn_t max_lsn = INVALID_LSN;
-
-  while (true) {
-    // 1. Peek at the first 4 bytes (the size of the record)
-    uint32_t record_size;
-    char size_buf[sizeof(uint32_t)];
-    if (!log_file.read(size_buf, sizeof(uint32_t))) {
-      break; // Clean EOF
+
+  // Skip the segments the master record says recovery no longer needs
+  // (they outlive it only if truncation was interrupted)
+  size_t first_segment = 0;
+  LogMaster master;
+  bool has_master = disk_manager_->ReadLogMaster(&master);
+  if (has_master && master.start_lsn != INVALID_LSN) {
+    while (first_segment + 1 < segments.size() &&
+           segments[first_segment + 1].first_lsn <= master.start_lsn) {
+      first_segment++;
     }
-    std::memcpy(&record_size, size_buf, sizeof(uint32_t));
-
-    // ==========================================
-    // FIX 1: PARTIAL CRASH WRITE PROTECTION
-    // ==========================================
-    // If the power was cut mid-write, the record size will be garbage.
-    // Minimum log header is 20 bytes. Max is roughly PAGE_SIZE.
-    if (record_size < 20 || record_size > PAGE_SIZE * 2) {
-      std::cout << "[RECOVERY] Encountered partial/corrupted log record at end "
-                   "of file. Halting Analysis."
-                << std::endl;
-      break;
+    std::cout << "[RECOVERY] Master record: checkpoint LSN "
+              << master.checkpoint_lsn << ", reading from LSN "
+              << segments[first_segment].first_lsn << "." << std::endl;
+  }
+  for (size_t i = first_segment; i < segments.size(); i++) {
+    lsn_t end = i + 1 < segments.size() ? segments[i + 1].first_lsn
+                                        : std::numeric_limits<lsn_t>::max();
+    segments_.push_back({segments[i].path, segments[i].first_lsn, end});
+  }
+
+  // ==========================================
+  // PASS 1: ANALYSIS FROM THE CHECKPOINT
+  // ==========================================
+  // The master record names the last checkpoint that completed, so analysis
+  // seeks straight to it. Records between its BEGIN and END were appended
+  // while its tables were built; the scan sees them, and they take
+  // precedence over the tables.
+  lsn_t checkpoint_lsn = INVALID_LSN;
+  LogRecord log_record;
+  if (has_master && master.checkpoint_lsn != INVALID_LSN &&
+      ReadLogRecordAt(master.checkpoint_lsn, &log_record) &&
+      log_record.GetLogRecordType() == LogRecordType::BEGIN_CHECKPOINT) {
+    checkpoint_lsn = master.checkpoint_lsn;
+  }
+  lsn_t analysis_lsn =
+      checkpoint_lsn != INVALID_LSN ? checkpoint_lsn : segments_.front().begin;
+
+  std::unordered_set<txn_id_t> seen_txns;
+  ActiveTxnTable checkpoint_att;
+  DirtyPageTable checkpoint_dpt;
+  bool checkpoint_done = false;
+
+  lsn_t end_lsn = ScanLog(analysis_lsn, [&](const LogRecord &record) {
+    if (!checkpoint_done &&
+        record.GetLogRecordType() == LogRecordType::END_CHECKPOINT &&
+        record.GetPrevLSN() == checkpoint_lsn) {
+      const auto &att = record.GetActiveTxns();
+      const auto &dpt = record.GetDirtyPages();
+      checkpoint_att.insert(checkpoint_att.end(), att.begin(), att.end());
+      checkpoint_dpt.insert(checkpoint_dpt.end(), dpt.begin(), dpt.end());
+      checkpoint_done = record.IsLastCheckpointRecord();
     }
 
-    std::vector<char> buffer(record_size);
-    std::memcpy(buffer.data(), &record_size, sizeof(uint32_t));
+    if (record.GetTxnId() != INVALID_TRANSACTION_ID) {
+      seen_txns.insert(record.GetTxnId());
+      if (record.GetLogRecordType() == LogRecordType::COMMIT ||
+          record.GetLogRecordType() == LogRecordType::ABORT) {
+        active_txn_.erase(record.GetTxnId());
+      } else {
+        active_txn_[record.GetTxnId()] = record.GetLSN();
+      }
+    }
+    for (page_id_t page_id : PagesTouched(record)) {
+      dirty_pages_.emplace(page_id, record.GetLSN());
+    }
+  });
 
-    // If the payload is truncated, read will fail safely
-    if (!log_file.read(buffer.data() + sizeof(uint32_t),
-                       record_size - sizeof(uint32_t))) {
-      std::cout << "[RECOVERY] Log payload truncated. Halting Analysis."
-                << std::endl;
-      break;
+  if (checkpoint_lsn != INVALID_LSN) {
+    for (const auto &[txn_id, last_lsn] : checkpoint_att) {
+      if (seen_txns.count(txn_id) == 0) {
+        active_txn_[txn_id] = last_lsn;
+      }
+    }
+    for (const auto &[page_id, rec_lsn] : checkpoint_dpt) {
+      auto it = dirty_pages_.find(page_id);
+      if (it == dirty_pages_.end() || rec_lsn < it->second) {
+        dirty_pages_[page_id] = rec_lsn;
+      }
     }
+    std::cout << "[RECOVERY] Analysis starts at checkpoint LSN "
+              << checkpoint_lsn << " (" << checkpoint_att.size()
+              << " active txns, " << checkpoint_dpt.size()
+              << " dirty pages)." << std::endl;
+  }
 
-    LogRecord log_record;
-    log_record.Deserialize(buffer.data());
+  // Everything read is on disk already. Setting this before redo lets the
+  // buffer pool evict redone pages (WAL rule) without a flush thread.
+  log_mgr_->SetNextLSN(end_lsn);
+
+  // ==========================================
+  // PASS 2: REDO FROM THE OLDEST recLSN
+  // ==========================================
+  if (!dirty_pages_.empty()) {
+    lsn_t redo_lsn = dirty_pages_.begin()->second;
+    for (const auto &[page_id, rec_lsn] : dirty_pages_) {
+      redo_lsn = std::min(redo_lsn, rec_lsn);
+    }
 
-    lsn_mapping_[log_record.GetLSN()] = offset;
-    max_lsn = std::max(max_lsn, log_record.GetLSN());
-    did_work_ = true;
+    std::cout << "[RECOVERY] Redo starts at LSN " << redo_lsn << " ("
+              << dirty_pages_.size() << " pages may be stale)." << std::endl;
+    RedoFrom(redo_lsn);
+  }
 
-    if (log_record.GetTxnId() != INVALID_TRANSACTION_ID) {
-      if (log_record.GetLogRecordType() == LogRecordType::COMMIT ||
-          log_record.GetLogRecordType() == LogRecordType::ABORT) {
-        active_txn_.erase(log_record.GetTxnId());
-      } else {
-        active_txn_[log_record.GetTxnId()] = log_record.GetLSN();
+  std::cout << "[RECOVERY] Redo Complete." << std::endl;
+  std::cout << "[RECOVERY] Found " << active_txn_.size()
+            << " active (loser) transactions." << std::endl;
+}
+
+void RecoveryManager::RedoFrom(lsn_t lsn) {
+  if (redo_threads_ <= 1) {
+    ScanLog(lsn, [&](const LogRecord &record) {
+      for (page_id_t page_id : PagesTouched(record)) {
+        if (NeedsRedo(record, page_id)) {
+          RedoRecord(record, page_id);
+        }
       }
+    });
+    return;
+  }
+
+  // Each page belongs to one worker, which applies its records in log
+  // order. Pages are independent, so workers never wait on each other.
+  struct RedoTask {
+    std::shared_ptr<const LogRecord> record;
+    page_id_t page_id;
+  };
+  struct RedoQueue {
+    std::mutex latch;
+    std::condition_variable cv;
+    std::deque<std::vector<RedoTask>> batches;
+    bool done = false;
+  };
+  constexpr size_t BATCH_SIZE = 256;
+  constexpr size_t MAX_QUEUED_BATCHES = 64; // Bounds memory per worker
+
+  std::vector<RedoQueue> queues(redo_threads_);
+  std::vector<std::vector<RedoTask>> pending(redo_threads_);
+
+  std::vector<std::thread> workers;
+  for (size_t w = 0; w < redo_threads_; w++) {
+    workers.emplace_back([&, w] {
+      RedoQueue &queue = queues[w];
+      while (true) {
+        std::vector<RedoTask> batch;
+        {
+          std::unique_lock<std::mutex> lock(queue.latch);
+          queue.cv.wait(lock,
+                        [&] { return !queue.batches.empty() || queue.done; });
+          if (queue.batches.empty()) {
+            return;
+          }
+          batch = std::move(queue.batches.front());
+          queue.batches.pop_front();
+        }
+        queue.cv.notify_all(); // Room for the reader
+        for (const RedoTask &task : batch) {
+          RedoRecord(*task.record, task.page_id);
+        }
+      }
+    });
+  }
+
+  auto hand_off = [&](size_t w) {
+    RedoQueue &queue = queues[w];
+    {
+      std::unique_lock<std::mutex> lock(queue.latch);
+      queue.cv.wait(lock, [&] {
+        return queue.batches.size() < MAX_QUEUED_BATCHES;
+      });
+      queue.batches.push_back(std::move(pending[w]));
     }
+    queue.cv.notify_all();
+    pending[w].clear();
+  };
+
+  // The reader decodes the log and dispatches by page
+  ScanLog(lsn, [&](const LogRecord &record) {
+    std::shared_ptr<const LogRecord> shared;
+    for (page_id_t page_id : PagesTouched(record)) {
+      if (!NeedsRedo(record, page_id)) {
+        continue;
+      }
+      if (shared == nullptr) {
+        shared = std::make_shared<const LogRecord>(record);
+      }
+      size_t w = std::hash<page_id_t>{}(page_id) % redo_threads_;
+      pending[w].push_back({shared, page_id});
+      if (pending[w].size() >= BATCH_SIZE) {
+        hand_off(w);
+      }
+    }
+  });
+
+  for (size_t w = 0; w < redo_threads_; w++) {
+    if (!pending[w].empty()) {
+      hand_off(w);
+    }
+    {
+      std::scoped_lock<std::mutex> lock(queues[w].latch);
+      queues[w].done = true;
+    }
+    queues[w].cv.notify_all();
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
 
-    RID rid = log_record.GetTargetRID();
-    LogRecordType type = log_record.GetLogRecordType();
+bool RecoveryManager::NeedsRedo(const LogRecord &log_record,
+                                page_id_t page_id) const {
+  // Only if the page was possibly dirty at the crash and the record is not
+  // older than its recLSN
+  auto it = dirty_pages_.find(page_id);
+  return it != dirty_pages_.end() && log_record.GetLSN() >= it->second;
+}
 
-    if (type == LogRecordType::NEWPAGE) {
-      page_id_t new_page_id = rid.GetPageId();
-      page_id_t prev_page_id = log_record.GetPrevPageId();
+void RecoveryManager::RedoRecord(const LogRecord &log_record,
+                                 page_id_t page_id) {
+  RID rid = log_record.GetTargetRID();
+  LogRecordType type = log_record.GetLogRecordType();
+
+  if (type == LogRecordType::NEWPAGE) {
+    page_id_t new_page_id = rid.GetPageId();
+    page_id_t prev_page_id = log_record.GetPrevPageId();
+
+    // The record formats the page, so it applies whatever the page holds:
+    // a freed B+ tree node keeps its own LSN at another offset. Every later
+    // record for the page is then repeated on top.
+    Page *new_page =
+        page_id == new_page_id ? bpm_->FetchPage(new_page_id) : nullptr;
+    if (new_page != nullptr) {
+      WritePageGuard guard(bpm_, new_page);
+      guard.As<TablePage>()->Init(new_page_id, PAGE_SIZE, prev_page_id,
+                                  log_record.GetLSN());
+      guard.MarkDirty();
+    }
 
-      Page *new_page = bpm_->FetchPage(new_page_id);
-      if (new_page != nullptr) {
-        WritePageGuard guard(bpm_, new_page);
+    if (prev_page_id != INVALID_PAGE_ID && page_id == prev_page_id) {
+      Page *prev_page = bpm_->FetchPage(prev_page_id);
+      if (prev_page != nullptr) {
+        WritePageGuard guard(bpm_, prev_page);
         auto table_page = guard.As<TablePage>();
         if (table_page->GetFreeSpacePointer() == 0 ||
+            table_page->GetFreeSpacePointer() > PAGE_SIZE ||
+            table_page->GetSlotCount() > PAGE_SIZE ||
             table_page->GetLSN() < log_record.GetLSN()) {
-          table_page->Init(new_page_id, PAGE_SIZE, prev_page_id,
-                           log_record.GetLSN());
-          guard.MarkDirty();
-        }
-      }
-
-      if (prev_page_id != INVALID_PAGE_ID) {
-        Page *prev_page = bpm_->FetchPage(prev_page_id);
-        if (prev_page != nullptr) {
-          WritePageGuard guard(bpm_, prev_page);
-          auto table_page = guard.As<TablePage>();
           if (table_page->GetFreeSpacePointer() == 0 ||
               table_page->GetFreeSpacePointer() > PAGE_SIZE ||
-              table_page->GetSlotCount() > PAGE_SIZE ||
-              table_page->GetLSN() < log_record.GetLSN()) {
-            if (table_page->GetFreeSpacePointer() == 0 ||
-                table_page->GetFreeSpacePointer() > PAGE_SIZE ||
-                table_page->GetSlotCount() > PAGE_SIZE) {
-              table_page->Init(prev_page_id, PAGE_SIZE);
-            }
-            table_page->SetNextPageId(new_page_id);
-            table_page->SetLSN(log_record.GetLSN());
-            guard.MarkDirty();
+              table_page->GetSlotCount() > PAGE_SIZE) {
+            table_page->Init(prev_page_id, PAGE_SIZE);
           }
+          table_page->SetNextPageId(new_page_id);
+          table_page->SetLSN(log_record.GetLSN());
+          guard.MarkDirty();
         }
       }
-    } else if (type == LogRecordType::INSERT ||
-               type == LogRecordType::MARKDELETE ||
-               type == LogRecordType::ROLLBACKDELETE ||
-               type == LogRecordType::APPLYDELETE ||
-               type == LogRecordType::UPDATE) {
-
-      Page *page = bpm_->FetchPage(rid.GetPageId());
-      if (page != nullptr) {
-        WritePageGuard guard(bpm_, page);
-        auto table_page = guard.As<TablePage>();
-
-        // Detect uninitialized pages or recycled B-Tree pages with garbage
-        // metadata
-        if (table_page->GetFreeSpacePointer() == 0 ||
-            table_page->GetFreeSpacePointer() > PAGE_SIZE ||
-            table_page->GetSlotCount() > PAGE_SIZE) {
-          table_page->Init(rid.GetPageId(), PAGE_SIZE);
-        }
+    }
+  } else if (type == LogRecordType::INSERT ||
+             type == LogRecordType::MARKDELETE ||
+             type == LogRecordType::ROLLBACKDELETE ||
+             type == LogRecordType::APPLYDELETE ||
+             type == LogRecordType::UPDATE ||
+             type == LogRecordType::UPDATE_DELTA) {
+    Page *page = bpm_->FetchPage(rid.GetPageId());
+    if (page != nullptr) {
+      WritePageGuard guard(bpm_, page);
+      auto table_page = guard.As<TablePage>();
+
+      // Detect uninitialized pages or recycled B-Tree pages with garbage
+      // metadata
+      if (table_page->GetFreeSpacePointer() == 0 ||
+          table_page->GetFreeSpacePointer() > PAGE_SIZE ||
+          table_page->GetSlotCount() > PAGE_SIZE) {
+        table_page->Init(rid.GetPageId(), PAGE_SIZE);
+      }
 
-        if (table_page->GetLSN() >= log_record.GetLSN()) {
-          // Skip stale log
-        } else {
-          if (type == LogRecordType::INSERT) {
-            // Because we replay logs in exact chronological order,
-            // standard insertion will perfectly recreate the original RIDs.
-            RID temp_rid;
-            table_page->InsertTuple(log_record.GetNewTuple(), &temp_rid);
-          } else if (type == LogRecordType::MARKDELETE) {
-            table_page->MarkDelete(rid);
-          } else if (type == LogRecordType::ROLLBACKDELETE) {
-            table_page->RollbackDelete(rid, log_record.GetNewTuple());
-          } else if (type == LogRecordType::APPLYDELETE) {
-            table_page->ApplyDelete(rid);
-          } else if (type == LogRecordType::UPDATE) {
+      if (table_page->GetLSN() >= log_record.GetLSN()) {
+        // Skip stale log
+      } else {
+        if (type == LogRecordType::INSERT) {
+          // Because we replay logs in exact chronological order,
+          // standard insertion will perfectly recreate the original RIDs.
+          RID temp_rid;
+          table_page->InsertTuple(log_record.GetNewTuple(), &temp_rid);
+        } else if (type == LogRecordType::MARKDELETE) {
+          table_page->MarkDelete(rid);
+        } else if (type == LogRecordType::ROLLBACKDELETE) {
+          table_page->RollbackDelete(rid, log_record.GetNewTuple());
+        } else if (type == LogRecordType::APPLYDELETE) {
+          table_page->ApplyDelete(rid);
+        } else if (type == LogRecordType::UPDATE) {
+          Tuple dummy_old_tuple;
+          table_page->UpdateTuple(log_record.GetNewTuple(), &dummy_old_tuple,
+                                  rid);
+        } else if (type == LogRecordType::UPDATE_DELTA) {
+          // History is repeated in order, so the page holds the old image
+          Tuple old_tuple;
+          Tuple new_tuple;
+          if (table_page->GetTuple(rid, &old_tuple) &&
+              log_record.GetDelta().Apply(old_tuple, &new_tuple)) {
             Tuple dummy_old_tuple;
-            table_page->UpdateTuple(log_record.GetNewTuple(), &dummy_old_tuple, rid);
+            table_page->UpdateTuple(new_tuple, &dummy_old_tuple, rid);
+          } else {
+            std::cerr << "[RECOVERY ERROR] Delta of LSN " << log_record.GetLSN()
+                      << " does not match the tuple on page "
+                      << rid.GetPageId() << std::endl;
           }
+        }
 
-          table_page->SetLSN(log_record.GetLSN());
-          guard.MarkDirty();
+        table_page->SetLSN(log_record.GetLSN());
+        guard.MarkDirty();
+      }
+    }
+  } else if (type == LogRecordType::BTREE_WRITE ||
+             type == LogRecordType::BTREE_INSERT ||
+             type == LogRecordType::BTREE_DELETE) {
+    const BTreeChange &change = log_record.GetBTreeChange();
+    Page *page = bpm_->FetchPage(change.page_id);
+    if (page != nullptr) {
+      WritePageGuard guard(bpm_, page);
+      char *data = page->GetData();
+      auto *node = reinterpret_cast<BPlusTreePage *>(data);
+
+      // A node image formats the page and applies whatever it holds (a
+      // freed heap page keeps its LSN at another offset); every later record
+      // for the page is then repeated on top. A page never written reads as
+      // zeros, LSN included, and LSN 0 is a real record: only page bytes can
+      // apply to it
+      bool unformatted = node->GetPageType() == IndexPageType::INVALID_PAGE_ID;
+      bool apply = change.formats ||
+                   (type == LogRecordType::BTREE_WRITE
+                        ? unformatted || node->GetLSN() < log_record.GetLSN()
+                        : !unformatted && node->GetLSN() < log_record.GetLSN());
+
+      if (apply && type == LogRecordType::BTREE_WRITE) {
+        if (change.offset + change.bytes.size() <= PAGE_SIZE) {
+          std::memcpy(data + change.offset, change.bytes.data(),
+                      change.bytes.size());
         }
+      } else if (apply) {
+        // The entries sit right after the header, in slot order
+        size_t entry_size = change.bytes.size();
+        uint32_t size = node->GetSize();
+        char *entries = data + (node->IsLeafPage() ? LEAF_PAGE_HEADER_SIZE
+                                                   : INTERNAL_PAGE_HEADER_SIZE);
+        char *slot = entries + change.offset * entry_size;
+        char *end = entries + size * entry_size;
+
+        if (type == LogRecordType::BTREE_INSERT && change.offset <= size &&
+            end + entry_size <= data + PAGE_SIZE) {
+          std::memmove(slot + entry_size, slot, end - slot);
+          std::memcpy(slot, change.bytes.data(), entry_size);
+          node->SetSize(size + 1);
+        } else if (type == LogRecordType::BTREE_DELETE &&
+                   change.offset < size && end <= data + PAGE_SIZE) {
+          std::memmove(slot, slot + entry_size, end - slot - entry_size);
+          node->SetSize(size - 1);
+        } else {
+          std::cerr << "[RECOVERY ERROR] Slot " << change.offset
+                    << " of LSN " << log_record.GetLSN()
+                    << " is out of range on index page " << change.page_id
+                    << std::endl;
+        }
+      }
+
+      if (apply) {
+        node->SetLSN(log_record.GetLSN());
+        guard.MarkDirty();
       }
     }
-    offset += record_size;
   }
+}
 
-  log_file.close();
-
-  if (max_lsn != INVALID_LSN) {
-    log_mgr_->SetNextLSN(max_lsn + 1);
+// Takes a leaf entry back out of (or puts it back into) its tree. The tree
+// is opened from the record alone: the entry size gives the key width, the
+// record its root and key columns. Its changes are logged on `txn`.
+template <size_t KeySize>
+static void UndoIndexEntry(BufferPoolManager *bpm, LogManager *log_mgr,
+                           const LogRecord &log_record, Transaction *txn) {
+  using Tree = BPlusTree<GenericKey<KeySize>, RID, GenericComparator<KeySize>>;
+  const BTreeChange &change = log_record.GetBTreeChange();
+
+  std::pair<GenericKey<KeySize>, RID> entry;
+  std::memcpy(entry.first.data_, change.bytes.data() +
+                  offsetof(decltype(entry), first), KeySize);
+  std::memcpy(&entry.second, change.bytes.data() +
+                  offsetof(decltype(entry), second), sizeof(RID));
+
+  Tree tree("", bpm, GenericComparator<KeySize>(change.key_columns),
+            Tree::DefaultLeafMaxSize(), Tree::DefaultInternalMaxSize(),
+            change.root_page_id, log_mgr);
+  if (log_record.GetLogRecordType() == LogRecordType::BTREE_INSERT) {
+    tree.Remove(entry.first, entry.second, txn);
+  } else {
+    tree.Insert(entry.first, entry.second, txn);
   }
-
-  std::cout << "[RECOVERY] Redo Complete." << std::endl;
-  std::cout << "[RECOVERY] Found " << active_txn_.size()
-            << " active (loser) transactions." << std::endl;
 }
 
 void RecoveryManager::Undo() {
@@ -173,36 +550,19 @@ void RecoveryManager::Undo() {
 
   std::cout << "[RECOVERY] Phase 3: Undo Started..." << std::endl;
 
-  std::ifstream log_file(log_file_name_, std::ios::binary);
-
   for (auto const &[txn_id, last_lsn] : active_txn_) {
     lsn_t current_lsn = last_lsn;
     std::cout << " -> Rolling back incomplete Transaction " << txn_id
               << std::endl;
 
     while (current_lsn != INVALID_LSN) {
-      auto offset_it = lsn_mapping_.find(current_lsn);
-      if (offset_it == lsn_mapping_.end()) {
-        std::cerr << "[RECOVERY ERROR] Missing LSN " << current_lsn
-                  << " in mapping!" << std::endl;
+      LogRecord log_record;
+      if (!ReadLogRecordAt(current_lsn, &log_record)) {
+        std::cerr << "[RECOVERY ERROR] Unreadable LSN " << current_lsn
+                  << " in the log!" << std::endl;
         break;
       }
 
-      uint32_t offset = offset_it->second;
-      log_file.seekg(offset);
-      uint32_t record_size;
-      char size_buf[sizeof(uint32_t)];
-      log_file.read(size_buf, sizeof(uint32_t));
-      std::memcpy(&record_size, size_buf, sizeof(uint32_t));
-
-      std::vector<char> buffer(record_size);
-      std::memcpy(buffer.data(), &record_size, sizeof(uint32_t));
-      log_file.read(buffer.data() + sizeof(uint32_t),
-                    record_size - sizeof(uint32_t));
-
-      LogRecord log_record;
-      log_record.Deserialize(buffer.data());
-
       RID rid = log_record.GetTargetRID();
       LogRecordType type = log_record.GetLogRecordType();
 
@@ -274,8 +634,77 @@ void RecoveryManager::Undo() {
           table_page->UpdateTuple(log_record.GetOldTuple(), &dummy_old_tuple, rid);
           guard.MarkDirty();
         }
-      } else if (type == LogRecordType::NEWPAGE) {
-        // Do nothing. Structural changes are not logically undone.
+      } else if (type == LogRecordType::UPDATE_DELTA) {
+        // The page holds the new image (redo repeated history); the inverse
+        // delta takes it back
+        TupleDelta inverse = log_record.GetDelta().Inverse();
+
+        Page *page = bpm_->FetchPage(rid.GetPageId());
+        if (page != nullptr) {
+          WritePageGuard guard(bpm_, page);
+          auto table_page = guard.As<TablePage>();
+          Tuple new_tuple;
+          Tuple old_tuple;
+          if (table_page->GetTuple(rid, &new_tuple) &&
+              inverse.Apply(new_tuple, &old_tuple)) {
+            // 1. Emit CLR
+            LogRecord clr_record(txn_id, active_txn_[txn_id], rid, inverse);
+            clr_record.SetCLR(true);
+            clr_record.SetUndoNextLSN(log_record.GetPrevLSN());
+            lsn_t clr_lsn = log_mgr_->AppendLogRecord(&clr_record);
+            active_txn_[txn_id] = clr_lsn; // Update tip to the CLR
+
+            // 2. Physical Undo
+            Tuple dummy_old_tuple;
+            table_page->UpdateTuple(old_tuple, &dummy_old_tuple, rid);
+            table_page->SetLSN(clr_lsn);
+            guard.MarkDirty();
+          } else {
+            std::cerr << "[RECOVERY ERROR] Cannot undo delta of LSN "
+                      << current_lsn << ": tuple does not match" << std::endl;
+          }
+        }
+      } else if ((type == LogRecordType::BTREE_INSERT ||
+                  type == LogRecordType::BTREE_DELETE) &&
+                 log_record.GetBTreeChange().root_page_id != INVALID_PAGE_ID) {
+        // Later splits may have moved the entry to another page, so it is
+        // undone through its tree, not on the page it was logged on. The
+        // tree's records become CLRs that resume undo at the same place.
+        Transaction undo_txn(txn_id);
+        undo_txn.SetPrevLSN(active_txn_[txn_id]);
+        undo_txn.SetUndoNextLSN(log_record.GetPrevLSN());
+
+        switch (log_record.GetBTreeChange().bytes.size() - sizeof(RID)) {
+        case 4:
+          UndoIndexEntry<4>(bpm_, log_mgr_, log_record, &undo_txn);
+          break;
+        case 8:
+          UndoIndexEntry<8>(bpm_, log_mgr_, log_record, &undo_txn);
+          break;
+        case 16:
+          UndoIndexEntry<16>(bpm_, log_mgr_, log_record, &undo_txn);
+          break;
+        case 32:
+          UndoIndexEntry<32>(bpm_, log_mgr_, log_record, &undo_txn);
+          break;
+        case 64:
+          UndoIndexEntry<64>(bpm_, log_mgr_, log_record, &undo_txn);
+          break;
+        case 128:
+          UndoIndexEntry<128>(bpm_, log_mgr_, log_record, &undo_txn);
+          break;
+        case 256:
+          UndoIndexEntry<256>(bpm_, log_mgr_, log_record, &undo_txn);
+          break;
+        default:
+          std::cerr << "[RECOVERY ERROR] Index entry of LSN " << current_lsn
+                    << " has an unknown key size" << std::endl;
+          break;
+        }
+        active_txn_[txn_id] = undo_txn.GetPrevLSN();
+      } else {
+        // NEWPAGE and the other B+ tree records: structural changes are
+        // not logically undone
       }
 
       current_lsn = log_record.GetPrevLSN();
@@ -287,7 +716,8 @@ void RecoveryManager::Undo() {
     log_mgr_->AppendLogRecord(&abort_record);
   }
 
-  log_file.close();
+  read_file_ = std::istringstream();
+  read_segment_ = 0;
   std::cout << "[RECOVERY] Undo Complete. Database is fully ACID compliant and "
                "ready for queries!"
             << std::endl;
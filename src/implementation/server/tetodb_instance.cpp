@@ -1,12 +1,26 @@
 // tetodb_instance.cpp
 
 #include "server/tetodb_instance.h"
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
 // Frontend & Backend Headers
 #include "execution/execution_engine.h"
 #include "optimizer/optimizer.h"
+#include "parser/ast.h"
 #include "parser/lexer.h"
 #include "parser/parser.h"
 #include "planner/planner.h"
@@ -14,6 +28,9 @@
 
 namespace tetodb {
 
+// Smallest pool partition we create or shrink to, in frames
+static constexpr size_t MIN_PARTITION_FRAMES = 64;
+
 // Helper function to recursively build the EXPLAIN output string
 void PrintPlanTree(const AbstractPlanNode *plan, std::ostringstream &oss,
                    int indent_level = 0) {
@@ -28,16 +45,38 @@ void PrintPlanTree(const AbstractPlanNode *plan, std::ostringstream &oss,
   }
 }
 
-TetoDBInstance::TetoDBInstance(const std::string &db_file_name) {
-  disk_manager_ = std::make_unique<DiskManager>(db_file_name);
-  replacer_ = std::make_unique<TwoQueueReplacer>(50);
-  bpm_ = std::make_unique<BufferPoolManager>(50, disk_manager_.get(),
-                                             replacer_.get());
-  log_mgr_ = std::make_unique<LogManager>(disk_manager_.get());
+TetoDBInstance::TetoDBInstance(const std::string &db_file_name,
+                               InstanceOptions options) {
+  DiskOptions disk_options;
+  disk_options.io_engine = options.io_engine;
+  disk_options.direct_io = options.direct_io;
+  disk_manager_ = std::make_unique<DiskManager>(db_file_name, disk_options);
+  size_t partitions = options.buffer_pool_partitions;
+  if (partitions == 0) {
+    // One partition per core, but never so many that a partition gets too
+    // small to hold a B+ tree descent plus a scan's pins
+    partitions = std::max<size_t>(1, std::thread::hardware_concurrency());
+    partitions = std::min(partitions,
+                          options.buffer_pool_frames / MIN_PARTITION_FRAMES);
+    partitions = std::clamp<size_t>(partitions, 1, 64);
+  }
+  bpm_ = std::make_unique<BufferPoolManager>(options.buffer_pool_frames,
+                                             disk_manager_.get(), partitions,
+                                             options.replacer);
+  log_mgr_ = std::make_unique<LogManager>(disk_manager_.get(),
+                                          options.log_buffer_size,
+                                          options.wal_compression);
+  bpm_->SetLogManager(log_mgr_.get());
 
   // ARIES Recovery
+  size_t recovery_threads = options.recovery_threads;
+  if (recovery_threads == 0) {
+    recovery_threads = std::thread::hardware_concurrency();
+  }
+  recovery_threads =
+      std::clamp<size_t>(recovery_threads, 1, MAX_RECOVERY_THREADS);
   RecoveryManager recovery_mgr(disk_manager_.get(), bpm_.get(), log_mgr_.get(),
-                               db_file_name);
+                               recovery_threads);
   recovery_mgr.Redo();
 
   // Start log flush thread BEFORE Undo, so CLRs emitted during Undo can be
@@ -45,7 +84,6 @@ TetoDBInstance::TetoDBInstance(const std::string &db_file_name) {
   log_mgr_->RunFlushThread();
 
   recovery_mgr.Undo();
-  bool needs_index_rebuild = recovery_mgr.DidWork();
 
   lock_mgr_ = std::make_unique<LockManager>();
   txn_mgr_ =
@@ -55,21 +93,249 @@ TetoDBInstance::TetoDBInstance(const std::string &db_file_name) {
   catalog_ =
       std::make_unique<Catalog>(catalog_path, bpm_.get(), log_mgr_.get());
 
-  checkpoint_mgr_ = std::make_unique<CheckpointManager>(
-      txn_mgr_.get(), log_mgr_.get(), bpm_.get());
+  checkpoint_mgr_ =
+      std::make_unique<CheckpointManager>(log_mgr_.get(), bpm_.get());
   checkpoint_mgr_->StartCheckpointer(std::chrono::seconds(5));
 
-  catalog_->LoadCatalog(catalog_path, needs_index_rebuild);
+  page_cleaner_ = std::make_unique<PageCleaner>(bpm_.get(), log_mgr_.get());
+  page_cleaner_->Start();
+
+  catalog_->LoadCatalog(catalog_path);
   std::cout << "[SYSTEM] TetoDB Instance Online. Awaiting connections.\n";
 }
 
 TetoDBInstance::~TetoDBInstance() {
   std::cout << "[SYSTEM] Shutting down TetoDB Instance...\n";
+  page_cleaner_->Stop();
   checkpoint_mgr_->StopCheckpointer();
   bpm_->FlushAllPages();
   log_mgr_->StopFlushThread();
 }
 
+// Splits a "<number><unit>" size spec and returns true with `*bytes` set
+// for a byte unit (none, B, K/KB, M/MB, G/GB). Any other unit returns false
+// with the bare number in `*bytes` and the upper-cased unit in `*unit`, for
+// the caller to handle or reject. `what` names the size in errors.
+static bool ParseByteSize(const std::string &spec, const std::string &what,
+                          double *bytes, std::string *unit) {
+  size_t pos = 0;
+  double amount = 0;
+  try {
+    amount = std::stod(spec, &pos);
+  } catch (const std::exception &) {
+    throw std::invalid_argument("Invalid " + what + " '" + spec + "'");
+  }
+  if (amount <= 0) {
+    throw std::invalid_argument("Invalid " + what + " '" + spec +
+                                "' (must be positive)");
+  }
+
+  *unit = spec.substr(pos);
+  for (auto &c : *unit)
+    c = static_cast<char>(::toupper(static_cast<unsigned char>(c)));
+
+  if (unit->empty() || *unit == "B") {
+    *bytes = amount;
+  } else if (*unit == "K" || *unit == "KB") {
+    *bytes = amount * 1024;
+  } else if (*unit == "M" || *unit == "MB") {
+    *bytes = amount * 1024 * 1024;
+  } else if (*unit == "G" || *unit == "GB") {
+    *bytes = amount * 1024 * 1024 * 1024;
+  } else {
+    *bytes = amount;
+    return false;
+  }
+  return true;
+}
+
+size_t TetoDBInstance::ParseBufferPoolSize(const std::string &spec) {
+  double bytes = 0;
+  std::string unit;
+  if (!ParseByteSize(spec, "buffer pool size", &bytes, &unit)) {
+    if (unit != "%") {
+      throw std::invalid_argument("Unknown size unit '" + unit +
+                                  "' (expected B, KB, MB, GB or %)");
+    }
+    if (bytes > 100) {
+      throw std::invalid_argument("Buffer pool percentage must be <= 100%");
+    }
+    double total_ram = 0;
+#ifdef _WIN32
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status))
+      total_ram = static_cast<double>(status.ullTotalPhys);
+#else
+    long pages = ::sysconf(_SC_PHYS_PAGES);
+    long page_size = ::sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page_size > 0)
+      total_ram = static_cast<double>(pages) * static_cast<double>(page_size);
+#endif
+    if (total_ram <= 0) {
+      throw std::invalid_argument("Cannot determine physical RAM size");
+    }
+    bytes = total_ram * bytes / 100.0;
+  }
+
+  // B+ tree latch crabbing and hash joins keep several pages pinned at
+  // once; below this the engine can wedge on a full pool
+  static constexpr size_t MIN_FRAMES = 16;
+
+  size_t frames = static_cast<size_t>(bytes / PAGE_SIZE);
+  if (frames < MIN_FRAMES) {
+    throw std::invalid_argument(
+        "Buffer pool must hold at least " + std::to_string(MIN_FRAMES) +
+        " pages (" + std::to_string(MIN_FRAMES * PAGE_SIZE / 1024) + " KB)");
+  }
+  return frames;
+}
+
+size_t TetoDBInstance::ParseWalBufferSize(const std::string &spec) {
+  double bytes = 0;
+  std::string unit;
+  if (!ParseByteSize(spec, "WAL buffer size", &bytes, &unit)) {
+    throw std::invalid_argument("Unknown WAL buffer size unit '" + unit +
+                                "' (expected B, KB, MB or GB)");
+  }
+
+  if (bytes < static_cast<double>(MIN_LOG_BUFFER_SIZE)) {
+    throw std::invalid_argument("WAL buffer must be at least " +
+                                std::to_string(MIN_LOG_BUFFER_SIZE / 1024) +
+                                " KB");
+  }
+  if (bytes > static_cast<double>(MAX_LOG_BUFFER_SIZE)) {
+    throw std::invalid_argument(
+        "WAL buffer must be at most " +
+        std::to_string(MAX_LOG_BUFFER_SIZE / (1024 * 1024)) + " MB");
+  }
+  return static_cast<size_t>(bytes);
+}
+
+void TetoDBInstance::ApplySetting(const SetStatement &stmt,
+                                  ClientSession &session, QueryResult &res) {
+  if (stmt.name_ == "buffer_pool_size") {
+    size_t frames = ParseBufferPoolSize(stmt.value_);
+    size_t min_frames = bpm_->GetNumPartitions() * MIN_PARTITION_FRAMES;
+    if (frames < min_frames) {
+      throw std::runtime_error(
+          "buffer_pool_size must be at least " +
+          std::to_string(min_frames * PAGE_SIZE / 1024) + " KB with " +
+          std::to_string(bpm_->GetNumPartitions()) + " pool partitions");
+    }
+    size_t reached = bpm_->Resize(frames);
+    if (reached != frames) {
+      std::cout << "[SYSTEM] Buffer pool shrink stopped at " << reached
+                << " frames (pinned pages in the way)\n";
+    }
+    res.status_msg = "SET";
+    return;
+  }
+
+  // Applies to indexes built from here on (CREATE INDEX, rebuilds)
+  if (stmt.name_ == "index_fill_factor") {
+    size_t pos = 0;
+    long percent = -1;
+    try {
+      percent = std::stol(stmt.value_, &pos);
+    } catch (const std::exception &) {
+      pos = 0;
+    }
+    if (pos != stmt.value_.size() || percent < MIN_INDEX_FILL_FACTOR ||
+        percent > 100) {
+      throw std::runtime_error("index_fill_factor must be an integer from " +
+                               std::to_string(MIN_INDEX_FILL_FACTOR) +
+                               " to 100");
+    }
+    catalog_->SetIndexFillFactor(static_cast<uint32_t>(percent));
+    res.status_msg = "SET";
+    return;
+  }
+
+  // Per session; inside a transaction block it also covers that transaction
+  if (stmt.name_ == "synchronous_commit") {
+    std::string value = stmt.value_;
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    if (value == "on" || value == "true" || value == "1") {
+      session.synchronous_commit = true;
+    } else if (value == "off" || value == "false" || value == "0") {
+      session.synchronous_commit = false;
+    } else {
+      throw std::runtime_error("synchronous_commit requires a Boolean value");
+    }
+    if (session.active_txn != nullptr) {
+      session.active_txn->SetSynchronousCommit(session.synchronous_commit);
+    }
+    res.status_msg = "SET";
+    return;
+  }
+
+  throw std::runtime_error("unrecognized configuration parameter \"" +
+                           stmt.name_ + "\"");
+}
+
+void TetoDBInstance::ShowSetting(const ShowStatement &stmt,
+                                 const ClientSession &session,
+                                 QueryResult &res) {
+  if (stmt.name_ == "buffer_pool_size") {
+    res.owned_schema = std::make_shared<Schema>(
+        std::vector<Column>{Column("buffer_pool_size", TypeId::VARCHAR)});
+    res.schema = res.owned_schema.get();
+    size_t kb = bpm_->GetPoolSize() * PAGE_SIZE / 1024;
+    std::string text = (kb % 1024 == 0) ? std::to_string(kb / 1024) + "MB"
+                                        : std::to_string(kb) + "kB";
+    res.rows.push_back(Tuple({Value(TypeId::VARCHAR, text)}, res.schema));
+    res.status_msg = "SHOW";
+    return;
+  }
+
+  if (stmt.name_ == "synchronous_commit") {
+    res.owned_schema = std::make_shared<Schema>(
+        std::vector<Column>{Column("synchronous_commit", TypeId::VARCHAR)});
+    res.schema = res.owned_schema.get();
+    res.rows.push_back(
+        Tuple({Value(TypeId::VARCHAR, session.synchronous_commit ? "on" : "off")},
+              res.schema));
+    res.status_msg = "SHOW";
+    return;
+  }
+
+  if (stmt.name_ == "index_fill_factor") {
+    res.owned_schema = std::make_shared<Schema>(
+        std::vector<Column>{Column("index_fill_factor", TypeId::INTEGER)});
+    res.schema = res.owned_schema.get();
+    res.rows.push_back(Tuple(
+        {Value(TypeId::INTEGER,
+               static_cast<int32_t>(catalog_->GetIndexFillFactor()))},
+        res.schema));
+    res.status_msg = "SHOW";
+    return;
+  }
+
+  if (stmt.name_ == "buffer_pool_stats") {
+    res.owned_schema = std::make_shared<Schema>(std::vector<Column>{
+        Column("stat", TypeId::VARCHAR), Column("value", TypeId::BIGINT)});
+    res.schema = res.owned_schema.get();
+    BufferPoolStats stats = bpm_->GetStats();
+    auto add_row = [&](const char *name, uint64_t value) {
+      res.rows.push_back(Tuple({Value(TypeId::VARCHAR, name),
+                                Value(TypeId::BIGINT,
+                                      static_cast<int64_t>(value))},
+                               res.schema));
+    };
+    add_row("fetch_hits", stats.fetch_hits);
+    add_row("fetch_misses", stats.fetch_misses);
+    add_row("pages_cleaned", stats.pages_cleaned);
+    add_row("sync_eviction_writes", stats.sync_eviction_writes);
+    add_row("pages_prefetched", stats.pages_prefetched);
+    res.status_msg = "SHOW";
+    return;
+  }
+
+  throw std::runtime_error("unrecognized configuration parameter \"" +
+                           stmt.name_ + "\"");
+}
+
 QueryResult TetoDBInstance::ExecuteQuery(const std::string &sql,
                                          ClientSession &session) {
   QueryResult res;
@@ -98,6 +364,7 @@ QueryResult TetoDBInstance::ExecuteQuery(const std::string &sql,
         if (session.active_txn)
           throw std::runtime_error("Transaction already in progress");
         session.active_txn = txn_mgr_->Begin();
+        session.active_txn->SetSynchronousCommit(session.synchronous_commit);
         session.is_poisoned = false;
         res.status_msg = "BEGIN";
       } else if (txn_stmt->cmd_ == TransactionCmd::COMMIT) {
@@ -148,13 +415,25 @@ QueryResult TetoDBInstance::ExecuteQuery(const std::string &sql,
       return res;
     }
 
+    // Server settings are not transactional
+    if (ast->type_ == ASTNodeType::SET_STATEMENT) {
+      ApplySetting(*static_cast<SetStatement *>(ast.get()), session, res);
+      return res;
+    }
+    if (ast->type_ == ASTNodeType::SHOW_STATEMENT) {
+      ShowSetting(*static_cast<ShowStatement *>(ast.get()), session, res);
+      return res;
+    }
+
     if (session.is_poisoned)
       throw std::runtime_error(
           "current transaction is aborted, commands ignored until end "
           "of transaction block");
 
     exec_txn = is_autocommit ? txn_mgr_->Begin() : session.active_txn;
-    std::shared_lock<std::shared_mutex> cp_lock(txn_mgr_->GetGlobalTxnLatch());
+    if (is_autocommit) {
+      exec_txn->SetSynchronousCommit(session.synchronous_commit);
+    }
 
     // 2. DDL Logic
     if (ast->type_ == ASTNodeType::CREATE_TABLE_STATEMENT) {
@@ -235,6 +514,27 @@ QueryResult TetoDBInstance::ExecuteQuery(const std::string &sql,
       } else {
         throw std::runtime_error("View not found");
       }
+    } else if (ast->type_ == ASTNodeType::REINDEX_STATEMENT) {
+      // Compaction is online and runs alongside DML and other REINDEX
+      // statements: it takes the same latches as a delete. The shared lock
+      // only keeps DDL from dropping the index under it.
+      std::shared_lock<std::shared_mutex> ddl_lock(ddl_latch_);
+      auto *r_stmt = static_cast<ReindexStatement *>(ast.get());
+      std::vector<IndexMetadata *> indexes;
+      if (r_stmt->is_table_) {
+        TableMetadata *table = catalog_->GetTable(r_stmt->name_);
+        if (table == nullptr)
+          throw std::runtime_error("Table not found");
+        indexes = catalog_->GetTableIndexes(table->oid_);
+      } else {
+        IndexMetadata *index = catalog_->GetIndex(r_stmt->name_);
+        if (index == nullptr)
+          throw std::runtime_error("Index not found");
+        indexes.push_back(index);
+      }
+      for (IndexMetadata *index : indexes)
+        index->index_->Compact(exec_txn);
+      res.status_msg = "REINDEX";
     }
     // 3. DML/Query Logic
     else {
@@ -293,12 +593,6 @@ QueryResult TetoDBInstance::ExecuteQuery(const std::string &sql,
       }
     }
 
-    // Release the checkpoint shared lock BEFORE commit/abort.
-    // Commit() calls log_manager_->Flush() which blocks. If the checkpoint
-    // manager fires while cp_lock is held, it tries to take an exclusive lock
-    // on GlobalTxnLatch, blocking all new shared locks → convoy deadlock.
-    cp_lock.unlock();
-
     if (is_autocommit)
       txn_mgr_->Commit(exec_txn);
   } catch (const std::exception &e) {
@@ -0,0 +1,44 @@
+// buffer_access_strategy.cpp
+
+#include "storage/buffer/buffer_access_strategy.h"
+
+#include <algorithm>
+
+namespace tetodb {
+
+BufferAccessStrategy::BufferAccessStrategy(BufferPoolManager *bpm,
+                                           AccessStrategyType type)
+    : bpm_(bpm), type_(type) {
+  size_t pool_size = bpm_->GetPoolSize();
+  size_t partitions = bpm_->GetNumPartitions();
+
+  // Never more than 1/8 of the pool, split across the partitions. A scan
+  // pins at most a couple of pages at a time, so two frames per partition
+  // are enough to keep it going.
+  size_t ring_pages = type_ == AccessStrategyType::BULK_READ
+                          ? BULK_READ_RING_PAGES
+                          : BULK_WRITE_RING_PAGES;
+  ring_pages = std::min(ring_pages, pool_size / 8);
+  size_t per_partition = std::max<size_t>(2, ring_pages / partitions);
+
+  rings_.resize(partitions);
+  for (auto &ring : rings_) {
+    ring.capacity = per_partition;
+  }
+  activate_after_ = pool_size / 4;
+}
+
+BufferAccessStrategy::~BufferAccessStrategy() { bpm_->ReleaseStrategy(this); }
+
+BufferRing *BufferAccessStrategy::RingFor(page_id_t page_id, size_t partition) {
+  if (page_id != last_page_id_) {
+    last_page_id_ = page_id;
+    pages_seen_++;
+  }
+  if (pages_seen_ <= activate_after_) {
+    return nullptr;
+  }
+  return &rings_[partition];
+}
+
+} // namespace tetodb
@@ -0,0 +1,755 @@
+// buffer_pool_instance.cpp
+
+#include "storage/buffer/buffer_pool_instance.h"
+#include "recovery/log_manager.h"
+
+#include <algorithm>
+
+namespace tetodb {
+BufferPoolInstance::BufferPoolInstance(size_t pool_size,
+                                       DiskManager *disk_manager,
+                                       Replacer *replacer,
+                                       ReplacerPolicy policy)
+    : disk_manager_(disk_manager), replacer_(replacer), pool_size_(0) {
+  if (replacer_ == nullptr) {
+    owned_replacer_ = MakeReplacer(policy, pool_size);
+    replacer_ = owned_replacer_.get();
+  }
+  AddFrames(pool_size);
+}
+
+void BufferPoolInstance::AddFrames(size_t count) {
+  if (count == 0)
+    return;
+
+  size_t bytes = count * PAGE_SIZE;
+  char *raw_ptr = nullptr;
+
+#ifdef _WIN32
+  raw_ptr = static_cast<char *>(_aligned_malloc(bytes, PAGE_SIZE));
+  if (!raw_ptr)
+    throw std::bad_alloc();
+#else
+  if (posix_memalign((void **)&raw_ptr, PAGE_SIZE, bytes) != 0) {
+    throw std::bad_alloc();
+  }
+#endif
+
+  data_chunks_.push_back({pool_size_, count, ChunkPtr(raw_ptr)});
+
+  for (size_t i = 0; i < count; i++) {
+    pages_.emplace_back();
+    pages_.back().data_ = raw_ptr + (i * PAGE_SIZE);
+    free_list_.push_back(static_cast<frame_id_t>(pool_size_ + i));
+  }
+  pool_size_ += count;
+}
+
+BufferPoolInstance::~BufferPoolInstance() = default;
+
+void BufferPoolInstance::SetLogManager(LogManager *log_manager) {
+  log_manager_ = log_manager;
+}
+
+lsn_t BufferPoolInstance::NextLSN() const {
+  LogManager *log_manager = log_manager_.load();
+  return log_manager != nullptr ? log_manager->GetNextLSN() : INVALID_LSN;
+}
+
+void BufferPoolInstance::Pin(Page *page) {
+  if (page->pin_count_++ == 0) {
+    page->pin_lsn_ = NextLSN();
+  }
+}
+
+bool BufferPoolInstance::WriteBack(std::unique_lock<std::mutex> &lock,
+                                   const std::vector<frame_id_t> &frames,
+                                   std::vector<bool> *written) {
+  std::vector<PageIO> batch;
+  batch.reserve(frames.size());
+  lsn_t wal_lsn = INVALID_LSN;
+
+  // Clear the dirty bit BEFORE writing: anyone who pins and modifies the
+  // page while the write is in flight re-dirties it on unpin, so a torn
+  // image on disk is always followed by another write.
+  for (frame_id_t fid : frames) {
+    Page *page = &pages_[fid];
+    page->is_dirty_ = false;
+    page->in_writeback_ = true;
+    wal_lsn = std::max(wal_lsn, page->last_lsn_);
+    batch.push_back({page->page_id_, page->GetData()});
+  }
+
+  lock.unlock();
+  LogManager *log_manager = log_manager_.load();
+  if (log_manager != nullptr && wal_lsn != INVALID_LSN) {
+    log_manager->WaitForLSN(wal_lsn); // WAL: log records before the pages
+  }
+  bool all_ok = disk_manager_->WritePages(batch);
+  lock.lock();
+
+  if (written != nullptr)
+    written->assign(frames.size(), false);
+  for (size_t i = 0; i < frames.size(); i++) {
+    Page *page = &pages_[frames[i]];
+    page->in_writeback_ = false;
+    if (!batch[i].ok)
+      page->is_dirty_ = true;
+    else if (!page->is_dirty_)
+      page->rec_lsn_ = INVALID_LSN; // Not re-dirtied during the write
+    if (written != nullptr)
+      (*written)[i] = batch[i].ok;
+  }
+  io_cv_.notify_all();
+  return all_ok;
+}
+
+void BufferPoolInstance::WaitForIo(std::unique_lock<std::mutex> &lock,
+                                   Page *page) {
+  io_cv_.wait(lock, [page] {
+    return !page->is_loading_ && !page->in_writeback_ && !page->is_evicting_;
+  });
+}
+
+bool BufferPoolInstance::GetFreeFrame(std::unique_lock<std::mutex> &lock,
+                                      frame_id_t *frame_id) {
+  while (true) {
+    if (!free_list_.empty()) {
+      *frame_id = free_list_.front();
+      free_list_.pop_front();
+      return true;
+    }
+
+    if (!replacer_->Evict(frame_id)) {
+      return false;
+    }
+    Page *victim = &pages_[*frame_id];
+
+    // Another eviction already owns this frame; it only came back through
+    // the replacer because it was hit (and unpinned) during that writeback.
+    // Put it back and let the owner decide.
+    if (victim->is_evicting_) {
+      replacer_->RecordAccess(*frame_id);
+      replacer_->SetEvictable(*frame_id, true);
+      io_cv_.wait(lock, [victim] { return !victim->is_evicting_; });
+      continue;
+    }
+
+    // Claim the frame. It stays in the page table while we may sleep, so a
+    // hit on it just pins it again and this eviction is abandoned.
+    victim->is_evicting_ = true;
+    io_cv_.wait(lock, [victim] { return !victim->in_writeback_; });
+
+    bool written = true;
+    if (victim->pin_count_ == 0 && victim->is_dirty_) {
+      std::vector<frame_id_t> frames{*frame_id};
+
+      // Clean the next few victims in the same submission, so their own
+      // evictions later need no I/O
+      if (disk_manager_->GetIoEngine() == IoEngine::IO_URING) {
+        for (frame_id_t fid : replacer_->EvictionCandidates(WRITEBACK_BATCH)) {
+          Page *page = &pages_[fid];
+          if (page->is_dirty_ && !page->in_writeback_ && !page->is_evicting_) {
+            frames.push_back(fid);
+          }
+        }
+      }
+
+      sync_eviction_writes_++;
+      std::vector<bool> results;
+      WriteBack(lock, frames, &results);
+      written = results[0];
+    }
+
+    victim->is_evicting_ = false;
+    io_cv_.notify_all();
+
+    if (victim->pin_count_ > 0) {
+      continue; // Hit while we slept; the pinner re-registered it
+    }
+
+    replacer_->Remove(*frame_id); // In case it was hit and unpinned meanwhile
+    if (!written || victim->is_dirty_) {
+      // Write failed, or the page was modified during the write: keep it
+      // cached (and evictable) rather than lose it
+      replacer_->RecordAccess(*frame_id);
+      replacer_->SetEvictable(*frame_id, true);
+      if (!written) {
+        return false;
+      }
+      continue;
+    }
+
+    page_table_.erase(victim->GetPageId());
+    return true;
+  }
+}
+
+bool BufferPoolInstance::GetRingFrame(std::unique_lock<std::mutex> &lock,
+                                      BufferRing *ring, frame_id_t *frame_id) {
+  if (ring->frames.size() < ring->capacity) {
+    // Still filling the ring from the shared pool
+    if (!GetFreeFrame(lock, frame_id)) {
+      return false;
+    }
+    ring->frames.push_back(*frame_id);
+  } else {
+    size_t slot = ring->next;
+    ring->next = (ring->next + 1) % ring->frames.size();
+
+    if (RecycleRingFrame(lock, ring, ring->frames[slot])) {
+      *frame_id = ring->frames[slot];
+    } else {
+      // That frame was adopted by another session, deleted or is still
+      // pinned; replace it with one from the shared pool
+      if (!GetFreeFrame(lock, frame_id)) {
+        return false;
+      }
+      ring->frames[slot] = *frame_id;
+    }
+  }
+
+  pages_[*frame_id].ring_ = ring;
+  return true;
+}
+
+bool BufferPoolInstance::RecycleRingFrame(std::unique_lock<std::mutex> &lock,
+                                          BufferRing *ring,
+                                          frame_id_t frame_id) {
+  if (static_cast<size_t>(frame_id) >= pool_size_) {
+    return false; // Dropped by a shrink
+  }
+  Page *page = &pages_[frame_id];
+  if (page->ring_ != ring) {
+    return false;
+  }
+  if (page->pin_count_ > 0 || page->is_loading_ || page->in_writeback_ ||
+      page->is_evicting_) {
+    DisownRingFrame(frame_id);
+    return false;
+  }
+
+  if (page->is_dirty_) {
+    // The bulk operation pays for its own writes
+    page->is_evicting_ = true;
+    std::vector<bool> written;
+    WriteBack(lock, {frame_id}, &written);
+    page->is_evicting_ = false;
+    io_cv_.notify_all();
+
+    if (page->ring_ != ring) {
+      return false; // Hit by another session meanwhile; it is shared now
+    }
+    if (!written[0] || page->pin_count_ > 0 || page->is_dirty_) {
+      DisownRingFrame(frame_id);
+      return false;
+    }
+  }
+
+  if (page->page_id_ != INVALID_PAGE_ID) {
+    page_table_.erase(page->page_id_);
+  }
+  return true;
+}
+
+void BufferPoolInstance::DisownRingFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  page->ring_ = nullptr;
+  if (page->page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  replacer_->RecordAccess(frame_id);
+  replacer_->SetEvictable(frame_id, page->pin_count_ == 0);
+}
+
+void BufferPoolInstance::ReleaseRing(BufferRing *ring) {
+  std::scoped_lock<std::mutex> lock(latch_);
+
+  for (frame_id_t frame_id : ring->frames) {
+    if (static_cast<size_t>(frame_id) < pool_size_ &&
+        pages_[frame_id].ring_ == ring) {
+      DisownRingFrame(frame_id);
+    }
+  }
+  ring->frames.clear();
+  ring->next = 0;
+}
+
+Page *BufferPoolInstance::NewPage(page_id_t page_id, BufferRing *ring) {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  frame_id_t frame_id = INVALID_FRAME_ID;
+
+  bool got_frame = ring != nullptr ? GetRingFrame(lock, ring, &frame_id)
+                                   : GetFreeFrame(lock, &frame_id);
+  if (!got_frame) {
+    return nullptr;
+  }
+
+  // A recycled id may still have a stale, unpinned copy cached (e.g. from
+  // PrefetchPages). Drop it so the page table maps the id to one frame only.
+  auto stale = page_table_.find(page_id);
+  if (stale != page_table_.end()) {
+    Page *stale_page = &pages_[stale->second];
+    WaitForIo(lock, stale_page);
+    stale = page_table_.find(page_id);
+  }
+  if (stale != page_table_.end()) {
+    Page *stale_page = &pages_[stale->second];
+    stale_page->page_id_ = INVALID_PAGE_ID;
+    stale_page->is_dirty_ = false;
+    stale_page->rec_lsn_ = INVALID_LSN;
+    stale_page->ring_ = nullptr;
+    replacer_->Remove(stale->second);
+    free_list_.push_back(stale->second);
+    page_table_.erase(stale);
+  }
+
+  Page *page = &pages_[frame_id];
+
+  page->page_id_ = page_id;
+  page->pin_count_ = 0;
+  Pin(page);
+  page->is_dirty_ = true;
+  page->dirty_since_ = std::chrono::steady_clock::now();
+  page->rec_lsn_ = page->pin_lsn_;
+  page->last_lsn_ = INVALID_LSN;
+  page->ResetMemory();
+
+  page_table_[page_id] = frame_id;
+  if (ring == nullptr) {
+    replacer_->RecordAccess(frame_id);
+    replacer_->SetEvictable(frame_id, false);
+  }
+
+  return page;
+}
+
+Page *BufferPoolInstance::FetchPage(page_id_t page_id, BufferRing *ring) {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  while (true) {
+    // FIX: Removed '&' to prevent dangling reference
+    auto it = page_table_.find(page_id);
+    if (it != page_table_.end()) {
+      frame_id_t frame_id = it->second;
+      Page *page = &pages_[frame_id];
+
+      fetch_hits_++;
+      Pin(page);
+
+      if (page->ring_ == nullptr || page->ring_ != ring) {
+        bool adopted = page->ring_ != nullptr;
+        if (adopted) {
+          // Someone else wants a bulk operation's page: it joins the shared
+          // pool (and the replacer) from now on
+          page->ring_ = nullptr;
+        }
+        // A bulk scan's hits must not make its pages look hot. (A frame
+        // still being prefetched is not in the replacer yet, and one being
+        // evicted was taken out of it; register those.)
+        if (ring == nullptr || adopted || page->is_loading_ ||
+            page->is_evicting_) {
+          replacer_->RecordAccess(frame_id);
+        }
+        replacer_->SetEvictable(frame_id, false);
+      }
+
+      // Another session is reading this page in: wait for that frame only.
+      // (Our pin keeps the frame from being evicted while we sleep.)
+      if (page->is_loading_) {
+        io_cv_.wait(lock, [page] { return !page->is_loading_; });
+      }
+      return page;
+    }
+
+    frame_id_t frame_id = INVALID_FRAME_ID;
+
+    bool got_frame = ring != nullptr ? GetRingFrame(lock, ring, &frame_id)
+                                     : GetFreeFrame(lock, &frame_id);
+    if (!got_frame) {
+      return nullptr;
+    }
+
+    // GetFreeFrame may have dropped the latch for a writeback; if somebody
+    // else started loading this page meanwhile, join them instead
+    if (page_table_.find(page_id) != page_table_.end()) {
+      pages_[frame_id].ring_ = nullptr;
+      free_list_.push_back(frame_id);
+      continue;
+    }
+
+    // Reserve the frame, then read with the latch released
+    fetch_misses_++;
+    Page *page = &pages_[frame_id];
+    page->page_id_ = page_id;
+    page->pin_count_ = 0;
+    Pin(page);
+    page->is_dirty_ = false;
+    page->rec_lsn_ = INVALID_LSN;
+    page->last_lsn_ = INVALID_LSN;
+    page->is_loading_ = true;
+
+    page_table_[page_id] = frame_id;
+    if (ring == nullptr) {
+      replacer_->RecordAccess(frame_id);
+      replacer_->SetEvictable(frame_id, false);
+    }
+
+    lock.unlock();
+    disk_manager_->ReadPage(page_id, page->GetData());
+    lock.lock();
+
+    page->is_loading_ = false;
+    io_cv_.notify_all();
+    return page;
+  }
+}
+
+bool BufferPoolInstance::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // FIX: Removed '&' to prevent dangling reference
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return false;
+  }
+
+  frame_id_t frame_id = it->second;
+  Page *page = &pages_[frame_id];
+
+  if (page->pin_count_ <= 0)
+    return false;
+
+  page->pin_count_--;
+  if (is_dirty) {
+    if (!page->is_dirty_) {
+      page->is_dirty_ = true;
+      page->dirty_since_ = std::chrono::steady_clock::now();
+    }
+    // Changes are made under a pin taken no earlier than pin_lsn_, and are
+    // logged before the unpin
+    if (page->rec_lsn_ == INVALID_LSN) {
+      page->rec_lsn_ = page->pin_lsn_;
+    }
+    lsn_t next_lsn = NextLSN();
+    if (next_lsn != INVALID_LSN) {
+      page->last_lsn_ = next_lsn - 1;
+    }
+  }
+
+  if (page->pin_count_ == 0 && page->is_deleted_) {
+    // A FlushPage() may still be writing it; whoever pins it meanwhile
+    // becomes the last unpinner. It is not evictable, so it stays put.
+    WaitForIo(lock, page);
+    if (page->page_id_ == page_id && page->pin_count_ == 0) {
+      replacer_->SetEvictable(frame_id, true); // so Remove() drops it
+      DropFrame(frame_id);
+      lock.unlock();
+      disk_manager_->DeallocatePage(page_id);
+    }
+  } else if (page->pin_count_ == 0) {
+    replacer_->SetEvictable(frame_id, true);
+  }
+
+  return true;
+}
+
+bool BufferPoolInstance::DeletePage(page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // FIX: Removed '&' to prevent dangling reference
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return true;
+  }
+
+  // Never hand a frame back to the free list while I/O still uses it
+  WaitForIo(lock, &pages_[it->second]);
+  it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return true;
+  }
+
+  frame_id_t frame_id = it->second;
+  Page *page = &pages_[frame_id];
+
+  if (page->pin_count_ > 0) {
+    page->is_deleted_ = true;
+    return false;
+  }
+
+  DropFrame(frame_id);
+  return true;
+}
+
+void BufferPoolInstance::DropFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  page_table_.erase(page->page_id_);
+  replacer_->Remove(frame_id);
+
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  page->is_deleted_ = false;
+  page->rec_lsn_ = INVALID_LSN;
+  page->pin_count_ = 0;
+  page->ring_ = nullptr;
+  page->ResetMemory();
+
+  free_list_.push_back(frame_id);
+}
+
+bool BufferPoolInstance::FlushPage(page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // FIX: Removed '&' to prevent dangling reference
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return false;
+  }
+
+  frame_id_t frame_id = it->second;
+  Page *page = &pages_[frame_id];
+  WaitForIo(lock, page);
+  if (page->page_id_ != page_id) {
+    return false; // Evicted (and therefore written) while we waited
+  }
+
+  return WriteBack(lock, {frame_id}, nullptr);
+}
+
+size_t BufferPoolInstance::Resize(size_t new_pool_size) {
+  std::scoped_lock<std::mutex> lock(latch_);
+
+  if (new_pool_size == 0)
+    new_pool_size = 1;
+
+  if (new_pool_size > pool_size_) {
+    AddFrames(new_pool_size - pool_size_);
+    replacer_->Resize(pool_size_);
+    return pool_size_;
+  }
+
+  // Shrink from the tail. Frames are only dropped from the end of pages_ so
+  // every surviving Page* stays valid; a pinned frame (or one with I/O in
+  // flight) stops the shrink there. Resizing is rare, so its writeback is
+  // done under the latch.
+  size_t target = pool_size_;
+  while (target > new_pool_size && pages_[target - 1].pin_count_ == 0 &&
+         !pages_[target - 1].is_loading_ && !pages_[target - 1].in_writeback_ &&
+         !pages_[target - 1].is_evicting_) {
+    target--;
+  }
+  if (target == pool_size_)
+    return pool_size_;
+
+  // Write back dirty tail pages in one batch before letting them go
+  std::vector<PageIO> batch;
+  lsn_t wal_lsn = INVALID_LSN;
+  for (size_t i = target; i < pool_size_; i++) {
+    Page *page = &pages_[i];
+    if (page->page_id_ != INVALID_PAGE_ID && page->is_dirty_) {
+      batch.push_back({page->page_id_, page->GetData()});
+      wal_lsn = std::max(wal_lsn, page->last_lsn_);
+    }
+  }
+  LogManager *log_manager = log_manager_.load();
+  if (log_manager != nullptr && wal_lsn != INVALID_LSN) {
+    log_manager->WaitForLSN(wal_lsn);
+  }
+  if (!disk_manager_->WritePages(batch)) {
+    return pool_size_; // Keep everything cached rather than lose data
+  }
+
+  for (size_t i = target; i < pool_size_; i++) {
+    Page *page = &pages_[i];
+    if (page->page_id_ != INVALID_PAGE_ID) {
+      page_table_.erase(page->page_id_);
+      replacer_->Remove(static_cast<frame_id_t>(i));
+    }
+  }
+  free_list_.remove_if(
+      [target](frame_id_t fid) { return static_cast<size_t>(fid) >= target; });
+
+  while (pages_.size() > target) {
+    pages_.pop_back();
+  }
+  pool_size_ = target;
+
+  // Release every chunk that now lies entirely past the end of the pool.
+  // (A chunk cut in the middle keeps its memory until it is fully dropped.)
+  while (!data_chunks_.empty() && data_chunks_.back().first_frame >= target) {
+    data_chunks_.pop_back();
+  }
+
+  replacer_->Resize(pool_size_);
+  return pool_size_;
+}
+
+size_t BufferPoolInstance::CleanDirtyPages(double dirty_ratio,
+                                           std::chrono::milliseconds max_age,
+                                           size_t max_pages) {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  auto now = std::chrono::steady_clock::now();
+  size_t num_dirty = 0;
+  std::vector<std::pair<page_id_t, frame_id_t>> candidates;
+
+  for (size_t i = 0; i < pool_size_; i++) {
+    Page *page = &pages_[i];
+    if (page->page_id_ == INVALID_PAGE_ID || !page->is_dirty_) {
+      continue;
+    }
+    num_dirty++;
+    if (page->pin_count_ == 0 && !page->is_loading_ && !page->in_writeback_ &&
+        !page->is_evicting_) {
+      candidates.push_back({page->page_id_, static_cast<frame_id_t>(i)});
+    }
+  }
+
+  bool over_ratio = num_dirty > dirty_ratio * static_cast<double>(pool_size_);
+  if (!over_ratio) {
+    candidates.erase(
+        std::remove_if(candidates.begin(), candidates.end(),
+                       [&](const std::pair<page_id_t, frame_id_t> &c) {
+                         return now - pages_[c.second].dirty_since_ < max_age;
+                       }),
+        candidates.end());
+  }
+  if (candidates.empty()) {
+    return 0;
+  }
+
+  // Ascending page ids turn the batch into mostly sequential writes
+  std::sort(candidates.begin(), candidates.end());
+  if (candidates.size() > max_pages) {
+    candidates.resize(max_pages);
+  }
+
+  std::vector<frame_id_t> frames;
+  frames.reserve(candidates.size());
+  for (const auto &c : candidates) {
+    frames.push_back(c.second);
+  }
+
+  std::vector<bool> written;
+  WriteBack(lock, frames, &written);
+  size_t cleaned = static_cast<size_t>(
+      std::count(written.begin(), written.end(), true));
+  pages_cleaned_ += cleaned;
+  return cleaned;
+}
+
+void BufferPoolInstance::GetDirtyPageTable(
+    std::vector<std::pair<page_id_t, lsn_t>> *out) {
+  std::scoped_lock<std::mutex> lock(latch_);
+
+  for (size_t i = 0; i < pool_size_; i++) {
+    Page *page = &pages_[i];
+    if (page->page_id_ == INVALID_PAGE_ID) {
+      continue;
+    }
+    // rec_lsn_ stays set while a write is in flight, so a page whose write
+    // has not landed yet is still listed
+    lsn_t rec_lsn = page->rec_lsn_;
+    if (page->pin_count_ > 0 && page->pin_lsn_ != INVALID_LSN &&
+        (rec_lsn == INVALID_LSN || page->pin_lsn_ < rec_lsn)) {
+      rec_lsn = page->pin_lsn_;
+    }
+    if (rec_lsn != INVALID_LSN) {
+      out->push_back({page->page_id_, rec_lsn});
+    }
+  }
+}
+
+BufferPoolStats BufferPoolInstance::GetStats() const {
+  BufferPoolStats stats;
+  stats.fetch_hits = fetch_hits_.load();
+  stats.fetch_misses = fetch_misses_.load();
+  stats.pages_cleaned = pages_cleaned_.load();
+  stats.sync_eviction_writes = sync_eviction_writes_.load();
+  stats.pages_prefetched = pages_prefetched_.load();
+  return stats;
+}
+
+size_t BufferPoolInstance::GetPoolSize() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return pool_size_;
+}
+
+void BufferPoolInstance::FlushAllPages() {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  std::vector<frame_id_t> frames;
+
+  for (size_t i = 0; i < pool_size_; i++) {
+    Page *page = &pages_[i];
+
+    if (page->page_id_ != INVALID_PAGE_ID && page->is_dirty_ &&
+        !page->is_loading_ && !page->in_writeback_) {
+      frames.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+
+  // Cache hits keep flowing while the checkpoint's writes are in flight
+  WriteBack(lock, frames, nullptr);
+}
+
+void BufferPoolInstance::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  std::unique_lock<std::mutex> lock(latch_);
+
+  page_id_t num_pages = disk_manager_->GetNumPages();
+  std::vector<PageIO> batch;
+  std::vector<frame_id_t> batch_frames;
+
+  for (page_id_t page_id : page_ids) {
+    if (page_id < 0 || page_id >= num_pages ||
+        page_table_.find(page_id) != page_table_.end()) {
+      continue;
+    }
+
+    frame_id_t frame_id = INVALID_FRAME_ID;
+    if (!GetFreeFrame(lock, &frame_id)) {
+      break;
+    }
+    if (page_table_.find(page_id) != page_table_.end()) {
+      free_list_.push_back(frame_id); // Loaded by someone else meanwhile
+      continue;
+    }
+
+    // Claim the frame now (so duplicates in page_ids are skipped, and
+    // FetchPage waits on it), but keep it out of the replacer until its
+    // contents have actually arrived
+    Page *page = &pages_[frame_id];
+    page->page_id_ = page_id;
+    page->pin_count_ = 0;
+    page->is_dirty_ = false;
+    page->is_loading_ = true;
+    page_table_[page_id] = frame_id;
+
+    batch.push_back({page_id, page->GetData()});
+    batch_frames.push_back(frame_id);
+  }
+
+  if (batch.empty())
+    return;
+
+  pages_prefetched_ += batch.size();
+
+  lock.unlock();
+  disk_manager_->ReadPages(batch);
+  lock.lock();
+
+  for (frame_id_t frame_id : batch_frames) {
+    Page *page = &pages_[frame_id];
+    page->is_loading_ = false;
+    // A FetchPage that arrived mid-read already registered its pin
+    if (page->pin_count_ == 0) {
+      replacer_->RecordAccess(frame_id);
+      replacer_->SetEvictable(frame_id, true);
+    }
+  }
+  io_cv_.notify_all();
+}
+
+} // namespace tetodb
@@ -1,212 +1,263 @@
 // buffer_pool_manager.cpp
 
 #include "storage/buffer/buffer_pool_manager.h"
+#include "storage/buffer/buffer_access_strategy.h"
+
+#include <algorithm>
 
 namespace tetodb {
 BufferPoolManager::BufferPoolManager(size_t pool_size,
                                      DiskManager *disk_manager,
-                                     TwoQueueReplacer *replacer)
-    : pool_size_(pool_size), disk_manager_(disk_manager), replacer_(replacer) {
-  size_t bytes = pool_size_ * PAGE_SIZE;
-  char *raw_ptr = nullptr;
-
-#ifdef _WIN32
-  raw_ptr = static_cast<char *>(_aligned_malloc(bytes, PAGE_SIZE));
-  if (!raw_ptr)
-    throw std::bad_alloc();
-#else
-  if (posix_memalign((void **)&raw_ptr, PAGE_SIZE, bytes) != 0) {
-    throw std::bad_alloc();
-  }
-#endif
-
-  data_pool_.reset(raw_ptr);
-  pages_.resize(pool_size_);
+                                     Replacer *replacer)
+    : disk_manager_(disk_manager) {
+  partitions_.push_back(
+      std::make_unique<BufferPoolInstance>(pool_size, disk_manager, replacer));
+}
 
-  for (size_t i = 0; i < pool_size_; i++) {
-    pages_[i].data_ = data_pool_.get() + (i * PAGE_SIZE);
-    free_list_.push_back(static_cast<frame_id_t>(i));
+BufferPoolManager::BufferPoolManager(size_t pool_size,
+                                     DiskManager *disk_manager,
+                                     size_t num_partitions,
+                                     ReplacerPolicy policy)
+    : disk_manager_(disk_manager) {
+  if (num_partitions == 0)
+    num_partitions = 1;
+  if (num_partitions > pool_size)
+    num_partitions = pool_size > 0 ? pool_size : 1;
+
+  partitions_.reserve(num_partitions);
+  for (size_t i = 0; i < num_partitions; i++) {
+    size_t share =
+        pool_size / num_partitions + (i < pool_size % num_partitions ? 1 : 0);
+    partitions_.push_back(
+        std::make_unique<BufferPoolInstance>(share, disk_manager, nullptr, policy));
   }
 }
 
-BufferPoolManager::~BufferPoolManager() = default;
-
-bool BufferPoolManager::GetFreeFrame(frame_id_t *frame_id) {
-  if (!free_list_.empty()) {
-    *frame_id = free_list_.front();
-    free_list_.pop_front();
-    return true;
+BufferPoolManager::~BufferPoolManager() {
+  {
+    std::scoped_lock<std::mutex> lock(read_ahead_latch_);
+    read_ahead_stop_ = true;
   }
-
-  if (replacer_->Evict(frame_id)) {
-    Page *evicted_page = &pages_[*frame_id];
-
-    if (evicted_page->is_dirty_) {
-      if (!disk_manager_->WritePage(evicted_page->GetPageId(),
-                                    evicted_page->GetData())) {
-        replacer_->SetEvictable(*frame_id, true);
-        return false;
-      }
-      evicted_page->is_dirty_ = false;
-    }
-
-    page_table_.erase(evicted_page->GetPageId());
-    return true;
+  read_ahead_cv_.notify_all();
+  if (read_ahead_thread_.joinable()) {
+    read_ahead_thread_.join();
   }
-
-  return false;
 }
 
-Page *BufferPoolManager::NewPage(page_id_t *page_id) {
-  std::scoped_lock<std::mutex> lock(latch_);
-
-  frame_id_t frame_id = INVALID_FRAME_ID;
-
-  if (!GetFreeFrame(&frame_id)) {
-    return nullptr;
-  }
-
+Page *BufferPoolManager::NewPage(page_id_t *page_id,
+                                 BufferAccessStrategy *strategy) {
   *page_id = disk_manager_->AllocatePage();
 
-  Page *page = &pages_[frame_id];
-
-  page->page_id_ = *page_id;
-  page->pin_count_ = 1;
-  page->is_dirty_ = true;
-  page->ResetMemory();
-
-  page_table_[*page_id] = frame_id;
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
-
+  size_t index = PartitionIndex(*page_id);
+  BufferRing *ring =
+      strategy != nullptr ? strategy->RingFor(*page_id, index) : nullptr;
+  Page *page = partitions_[index]->NewPage(*page_id, ring);
+  if (page == nullptr) {
+    // Every frame of that partition is pinned; hand the id back
+    disk_manager_->DeallocatePage(*page_id);
+  }
   return page;
 }
 
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
-  std::scoped_lock<std::mutex> lock(latch_);
-
-  // FIX: Removed '&' to prevent dangling reference
-  auto it = page_table_.find(page_id);
-  if (it != page_table_.end()) {
-    frame_id_t frame_id = it->second;
-    Page *page = &pages_[frame_id];
-
-    page->pin_count_++;
-
-    replacer_->RecordAccess(frame_id);
-    replacer_->SetEvictable(frame_id, false);
-
-    return page;
+Page *BufferPoolManager::FetchPage(page_id_t page_id,
+                                   BufferAccessStrategy *strategy) {
+  if (strategy == nullptr) {
+    return PartitionFor(page_id)->FetchPage(page_id);
   }
+  size_t index = PartitionIndex(page_id);
+  return partitions_[index]->FetchPage(page_id,
+                                       strategy->RingFor(page_id, index));
+}
 
-  frame_id_t frame_id = INVALID_FRAME_ID;
-
-  if (!GetFreeFrame(&frame_id)) {
-    return nullptr;
+void BufferPoolManager::ReleaseStrategy(BufferAccessStrategy *strategy) {
+  for (size_t i = 0; i < partitions_.size() && i < strategy->rings_.size();
+       i++) {
+    partitions_[i]->ReleaseRing(&strategy->rings_[i]);
   }
-
-  Page *page = &pages_[frame_id];
-  disk_manager_->ReadPage(page_id, page->GetData());
-
-  page->page_id_ = page_id;
-  page->pin_count_ = 1;
-  page->is_dirty_ = false;
-
-  page_table_[page_id] = frame_id;
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
-
-  return page;
 }
 
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-  std::scoped_lock<std::mutex> lock(latch_);
-
-  // FIX: Removed '&' to prevent dangling reference
-  auto it = page_table_.find(page_id);
-  if (it == page_table_.end()) {
-    return false;
-  }
-
-  frame_id_t frame_id = it->second;
-  Page *page = &pages_[frame_id];
-
-  if (page->pin_count_ <= 0)
-    return false;
-
-  page->pin_count_--;
-  page->is_dirty_ |= is_dirty;
+  return PartitionFor(page_id)->UnpinPage(page_id, is_dirty);
+}
 
-  if (page->pin_count_ == 0) {
-    replacer_->SetEvictable(frame_id, true);
+bool BufferPoolManager::DeletePage(page_id_t page_id) {
+  if (!PartitionFor(page_id)->DeletePage(page_id)) {
+    return false; // Still pinned: freed on the last unpin
   }
-
+  disk_manager_->DeallocatePage(page_id);
   return true;
 }
 
-bool BufferPoolManager::DeletePage(page_id_t page_id) {
-  std::scoped_lock<std::mutex> lock(latch_);
+bool BufferPoolManager::FlushPage(page_id_t page_id) {
+  return PartitionFor(page_id)->FlushPage(page_id);
+}
 
-  // FIX: Removed '&' to prevent dangling reference
-  auto it = page_table_.find(page_id);
-  if (it == page_table_.end()) {
-    disk_manager_->DeallocatePage(page_id);
-    return true;
+void BufferPoolManager::FlushAllPages() {
+  for (auto &partition : partitions_) {
+    partition->FlushAllPages();
   }
+}
 
-  frame_id_t frame_id = it->second;
-  Page *page = &pages_[frame_id];
-
-  if (page->pin_count_ > 0) {
-    return false;
+void BufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  if (partitions_.size() == 1) {
+    partitions_[0]->PrefetchPages(page_ids);
+    return;
   }
 
-  page->page_id_ = INVALID_PAGE_ID;
-  page->is_dirty_ = false;
-  page->pin_count_ = 0;
-  page->ResetMemory();
+  std::vector<std::vector<page_id_t>> per_partition(partitions_.size());
+  for (page_id_t page_id : page_ids) {
+    if (page_id < 0)
+      continue;
+    per_partition[static_cast<size_t>(page_id) % partitions_.size()]
+        .push_back(page_id);
+  }
+  for (size_t i = 0; i < partitions_.size(); i++) {
+    if (!per_partition[i].empty()) {
+      partitions_[i]->PrefetchPages(per_partition[i]);
+    }
+  }
+}
 
-  page_table_.erase(page_id);
-  replacer_->Remove(frame_id);
+void BufferPoolManager::ReadAhead(ReadAheadState *state, page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID)
+    return;
+
+  // 1. Track the stride of the chain the scan is following
+  if (state->last_page_id != INVALID_PAGE_ID) {
+    int64_t stride = static_cast<int64_t>(page_id) - state->last_page_id;
+    if (stride != 0 && stride == state->stride) {
+      state->run++;
+    } else {
+      *state = ReadAheadState();
+      state->stride = stride;
+      state->run = 1;
+    }
+  }
+  state->last_page_id = page_id;
+
+  if (state->run < READ_AHEAD_TRIGGER)
+    return;
+
+  // 2. Only top up once the scan is within half a window of the pages
+  //    already requested
+  auto hops_ahead = [&](page_id_t target) {
+    return (static_cast<int64_t>(target) - page_id) / state->stride;
+  };
+  if (state->prefetched_until != INVALID_PAGE_ID &&
+      hops_ahead(state->prefetched_until) > state->window / 2) {
+    return;
+  }
 
-  free_list_.push_back(frame_id);
+  uint32_t cap = static_cast<uint32_t>(
+      std::min<size_t>(READ_AHEAD_MAX_PAGES, GetPoolSize() / 8));
+  if (cap == 0)
+    return;
+  state->window = state->window == 0
+                      ? std::min(READ_AHEAD_MIN_PAGES, cap)
+                      : std::min(state->window * 2, cap);
+
+  // 3. Request the pages between the old frontier and the new one
+  int64_t first = 1;
+  if (state->prefetched_until != INVALID_PAGE_ID) {
+    first = std::max<int64_t>(1, hops_ahead(state->prefetched_until) + 1);
+  }
+  std::vector<page_id_t> page_ids;
+  for (int64_t hop = first; hop <= state->window; hop++) {
+    int64_t id = static_cast<int64_t>(page_id) + hop * state->stride;
+    if (id < 0 || id > INT32_MAX)
+      break;
+    page_ids.push_back(static_cast<page_id_t>(id));
+  }
+  if (page_ids.empty())
+    return;
+  state->prefetched_until = page_ids.back();
+
+  {
+    std::scoped_lock<std::mutex> lock(read_ahead_latch_);
+    if (read_ahead_queue_.size() >= READ_AHEAD_MAX_QUEUED)
+      return; // The disk is already behind; reading even more ahead won't help
+    read_ahead_queue_.push_back(std::move(page_ids));
+    if (!read_ahead_thread_.joinable()) {
+      read_ahead_thread_ = std::thread([this] { ReadAheadLoop(); });
+    }
+  }
+  read_ahead_cv_.notify_one();
+}
 
-  disk_manager_->DeallocatePage(page_id);
-  return true;
+void BufferPoolManager::ReadAheadLoop() {
+  std::unique_lock<std::mutex> lock(read_ahead_latch_);
+  while (true) {
+    read_ahead_cv_.wait(lock, [this] {
+      return read_ahead_stop_ || !read_ahead_queue_.empty();
+    });
+    if (read_ahead_stop_)
+      return;
+
+    std::vector<page_id_t> page_ids = std::move(read_ahead_queue_.front());
+    read_ahead_queue_.pop_front();
+
+    lock.unlock();
+    PrefetchPages(page_ids);
+    lock.lock();
+  }
 }
 
-bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  std::scoped_lock<std::mutex> lock(latch_);
+size_t BufferPoolManager::Resize(size_t new_pool_size) {
+  if (new_pool_size < partitions_.size())
+    new_pool_size = partitions_.size();
 
-  // FIX: Removed '&' to prevent dangling reference
-  auto it = page_table_.find(page_id);
-  if (it == page_table_.end()) {
-    return false;
+  size_t reached = 0;
+  for (size_t i = 0; i < partitions_.size(); i++) {
+    reached += partitions_[i]->Resize(PartitionShare(new_pool_size, i));
   }
+  return reached;
+}
 
-  frame_id_t frame_id = it->second;
-  Page *page = &pages_[frame_id];
-
-  if (!disk_manager_->WritePage(page_id, page->GetData())) {
-    return false;
+size_t BufferPoolManager::CleanDirtyPages(double dirty_ratio,
+                                          std::chrono::milliseconds max_age,
+                                          size_t max_pages) {
+  size_t cleaned = 0;
+  for (size_t i = 0; i < partitions_.size(); i++) {
+    size_t share = std::max<size_t>(1, PartitionShare(max_pages, i));
+    cleaned += partitions_[i]->CleanDirtyPages(dirty_ratio, max_age, share);
   }
-  page->is_dirty_ = false;
+  return cleaned;
+}
 
-  return true;
+BufferPoolStats BufferPoolManager::GetStats() const {
+  BufferPoolStats total;
+  for (const auto &partition : partitions_) {
+    BufferPoolStats stats = partition->GetStats();
+    total.fetch_hits += stats.fetch_hits;
+    total.fetch_misses += stats.fetch_misses;
+    total.pages_cleaned += stats.pages_cleaned;
+    total.sync_eviction_writes += stats.sync_eviction_writes;
+    total.pages_prefetched += stats.pages_prefetched;
+  }
+  return total;
 }
 
-void BufferPoolManager::FlushAllPages() {
-  std::scoped_lock<std::mutex> lock(latch_);
+void BufferPoolManager::SetLogManager(LogManager *log_manager) {
+  for (auto &partition : partitions_) {
+    partition->SetLogManager(log_manager);
+  }
+}
 
-  for (size_t i = 0; i < pool_size_; i++) {
-    Page *page = &pages_[i];
+std::vector<std::pair<page_id_t, lsn_t>>
+BufferPoolManager::GetDirtyPageTable() {
+  std::vector<std::pair<page_id_t, lsn_t>> dpt;
+  for (auto &partition : partitions_) {
+    partition->GetDirtyPageTable(&dpt);
+  }
+  return dpt;
+}
 
-    if (page->page_id_ != INVALID_PAGE_ID && page->is_dirty_) {
-      if (disk_manager_->WritePage(page->page_id_, page->GetData())) {
-        page->is_dirty_ = false;
-      }
-    }
+size_t BufferPoolManager::GetPoolSize() {
+  size_t total = 0;
+  for (auto &partition : partitions_) {
+    total += partition->GetPoolSize();
   }
+  return total;
 }
 
 } // namespace tetodb
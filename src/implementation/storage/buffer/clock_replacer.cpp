@@ -0,0 +1,133 @@
+// clock_replacer.cpp
+
+#include "storage/buffer/clock_replacer.h"
+
+#include <algorithm>
+
+namespace tetodb {
+
+    ClockReplacer::ClockReplacer(size_t num_frames)
+        : num_frames_(num_frames),
+          state_(new std::atomic<uint8_t>[num_frames]),
+          usage_(new std::atomic<uint8_t>[num_frames]) {
+        for (size_t i = 0; i < num_frames; i++) {
+            state_[i].store(ABSENT, std::memory_order_relaxed);
+            usage_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool ClockReplacer::Evict(frame_id_t* frame_id) {
+        std::scoped_lock<std::mutex> lock(latch_);
+
+        if (curr_size_.load() == 0 || num_frames_ == 0) return false;
+
+        // Every full turn lowers each evictable count by one, so a victim
+        // turns up within MAX_USAGE + 1 turns unless frames keep getting hit
+        size_t max_steps = num_frames_ * (MAX_USAGE + 2);
+        for (size_t step = 0; step < max_steps; step++) {
+            size_t i = hand_;
+            hand_ = (hand_ + 1) % num_frames_;
+
+            if (state_[i].load() != EVICTABLE) continue;
+
+            uint8_t usage = usage_[i].load(std::memory_order_relaxed);
+            if (usage > 0) {
+                usage_[i].compare_exchange_strong(usage, usage - 1,
+                                                  std::memory_order_relaxed);
+                continue;
+            }
+
+            uint8_t expected = EVICTABLE;
+            if (state_[i].compare_exchange_strong(expected, ABSENT)) {
+                curr_size_--;
+                *frame_id = static_cast<frame_id_t>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ClockReplacer::RecordAccess(frame_id_t frame_id) {
+        if (!InRange(frame_id)) return;
+
+        uint8_t state = state_[frame_id].load();
+        if (state == ABSENT) {
+            usage_[frame_id].store(0, std::memory_order_relaxed);
+            if (state_[frame_id].compare_exchange_strong(state, PINNED)) return;
+        }
+
+        // Already tracked: just note the hit. A lost increment between two
+        // racing hits is harmless.
+        uint8_t usage = usage_[frame_id].load(std::memory_order_relaxed);
+        if (usage < MAX_USAGE) {
+            usage_[frame_id].store(usage + 1, std::memory_order_relaxed);
+        }
+    }
+
+    void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+        if (!InRange(frame_id)) return;
+
+        uint8_t desired = set_evictable ? EVICTABLE : PINNED;
+        uint8_t state = state_[frame_id].load();
+        while (state != ABSENT && state != desired) {
+            if (state_[frame_id].compare_exchange_weak(state, desired)) {
+                if (set_evictable) curr_size_++;
+                else curr_size_--;
+                return;
+            }
+        }
+    }
+
+    void ClockReplacer::Remove(frame_id_t frame_id) {
+        if (!InRange(frame_id)) return;
+
+        uint8_t expected = EVICTABLE;
+        if (state_[frame_id].compare_exchange_strong(expected, ABSENT)) {
+            curr_size_--;
+        }
+    }
+
+    size_t ClockReplacer::Size() {
+        return curr_size_.load();
+    }
+
+    void ClockReplacer::Resize(size_t num_frames) {
+        std::scoped_lock<std::mutex> lock(latch_);
+
+        std::unique_ptr<std::atomic<uint8_t>[]> state(new std::atomic<uint8_t>[num_frames]);
+        std::unique_ptr<std::atomic<uint8_t>[]> usage(new std::atomic<uint8_t>[num_frames]);
+        size_t evictable = 0;
+        for (size_t i = 0; i < num_frames; i++) {
+            uint8_t s = i < num_frames_ ? state_[i].load() : static_cast<uint8_t>(ABSENT);
+            uint8_t u = i < num_frames_ ? usage_[i].load() : 0;
+            state[i].store(s, std::memory_order_relaxed);
+            usage[i].store(u, std::memory_order_relaxed);
+            if (s == EVICTABLE) evictable++;
+        }
+
+        state_ = std::move(state);
+        usage_ = std::move(usage);
+        num_frames_ = num_frames;
+        curr_size_.store(evictable);
+        if (hand_ >= num_frames_) hand_ = 0;
+    }
+
+    std::vector<frame_id_t> ClockReplacer::EvictionCandidates(size_t max_count) {
+        std::scoped_lock<std::mutex> lock(latch_);
+
+        // Replay the sweep without touching any counts: frames at usage 0
+        // in hand order, then usage 1, and so on
+        std::vector<frame_id_t> out;
+        for (uint8_t level = 0; level <= MAX_USAGE && out.size() < max_count; level++) {
+            for (size_t step = 0; step < num_frames_ && out.size() < max_count; step++) {
+                size_t i = (hand_ + step) % num_frames_;
+                if (state_[i].load() == EVICTABLE &&
+                    std::min<uint8_t>(usage_[i].load(std::memory_order_relaxed), MAX_USAGE) == level) {
+                    out.push_back(static_cast<frame_id_t>(i));
+                }
+            }
+        }
+        return out;
+    }
+
+} // namespace tetodb
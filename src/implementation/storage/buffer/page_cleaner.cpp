@@ -0,0 +1,49 @@
+// page_cleaner.cpp
+
+#include "storage/buffer/page_cleaner.h"
+
+namespace tetodb {
+
+void PageCleaner::Start() {
+  if (enable_cleaner_)
+    return;
+  enable_cleaner_ = true;
+
+  cleaner_thread_ = std::thread([this] {
+    while (enable_cleaner_) {
+      {
+        std::unique_lock<std::mutex> lock(latch_);
+        cv_.wait_for(lock, options_.interval,
+                     [this] { return !enable_cleaner_; });
+      }
+      if (enable_cleaner_) {
+        RunOnce();
+      }
+    }
+  });
+}
+
+void PageCleaner::Stop() {
+  if (!enable_cleaner_)
+    return;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    enable_cleaner_ = false;
+  }
+  cv_.notify_all();
+  if (cleaner_thread_.joinable()) {
+    cleaner_thread_.join();
+  }
+}
+
+size_t PageCleaner::RunOnce() {
+  // Write-ahead logging: get the log for what is in the pool onto disk
+  // before the pages themselves (a no-op when the log buffer is empty)
+  if (log_manager_ != nullptr) {
+    log_manager_->Flush();
+  }
+  return bpm_->CleanDirtyPages(options_.dirty_ratio, options_.max_age,
+                               options_.max_pages_per_round);
+}
+
+} // namespace tetodb
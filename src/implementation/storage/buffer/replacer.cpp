@@ -0,0 +1,19 @@
+// replacer.cpp
+
+#include "storage/buffer/replacer.h"
+#include "storage/buffer/clock_replacer.h"
+#include "storage/buffer/two_queue_replacer.h"
+
+namespace tetodb {
+
+    std::unique_ptr<Replacer> MakeReplacer(ReplacerPolicy policy, size_t num_frames) {
+        switch (policy) {
+        case ReplacerPolicy::CLOCK:
+            return std::make_unique<ClockReplacer>(num_frames);
+        case ReplacerPolicy::TWO_QUEUE:
+        default:
+            return std::make_unique<TwoQueueReplacer>(num_frames);
+        }
+    }
+
+} // namespace tetodb
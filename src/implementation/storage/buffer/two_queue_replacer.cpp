@@ -113,6 +113,24 @@ namespace tetodb {
         curr_size_--;
     }
 
+    std::vector<frame_id_t> TwoQueueReplacer::EvictionCandidates(size_t max_count) {
+        std::scoped_lock<std::mutex> lock(latch_);
+
+        std::vector<frame_id_t> candidates;
+        for (auto it = fifo_.rbegin(); it != fifo_.rend() && candidates.size() < max_count; ++it) {
+            if (node_store_[*it].is_evictable_) candidates.push_back(*it);
+        }
+        for (auto it = lru_.rbegin(); it != lru_.rend() && candidates.size() < max_count; ++it) {
+            if (node_store_[*it].is_evictable_) candidates.push_back(*it);
+        }
+        return candidates;
+    }
+
+    void TwoQueueReplacer::Resize(size_t num_frames) {
+        std::scoped_lock<std::mutex> lock(latch_);
+        replacer_size_ = num_frames;
+    }
+
     size_t TwoQueueReplacer::Size() {
         std::scoped_lock<std::mutex> lock(latch_);
         return curr_size_;
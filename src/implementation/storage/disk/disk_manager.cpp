@@ -1,14 +1,63 @@
 // disk_manager.cpp
 
 #include "storage/disk/disk_manager.h"
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
 
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace tetodb {
 
-DiskManager::DiskManager(std::filesystem::path db_file)
+// Requests in flight per io_uring submission
+static constexpr uint32_t IO_URING_QUEUE_DEPTH = 64;
+
+// Marks a valid <db>.wal/master file. Changed when LSNs became byte
+// positions, so an older master is ignored.
+static constexpr uint32_t LOG_MASTER_MAGIC = 0x54455432;
+
+// Fixed-width hex, so segment names sort in LSN order
+static std::string SegmentFileName(lsn_t first_lsn) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.seg",
+                static_cast<unsigned long long>(first_lsn));
+  return name;
+}
+
+#ifndef _WIN32
+namespace {
+
+inline bool IsPageAligned(const void *ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % PAGE_SIZE == 0;
+}
+
+// O_DIRECT also needs the user buffer aligned. Buffer pool frames already
+// are; callers passing ordinary memory (tests, tools) are staged through
+// this per-thread page.
+char *BouncePage() {
+  struct Deleter {
+    void operator()(char *p) const { free(p); }
+  };
+  thread_local std::unique_ptr<char, Deleter> page = [] {
+    void *raw = nullptr;
+    if (posix_memalign(&raw, PAGE_SIZE, PAGE_SIZE) != 0)
+      throw std::bad_alloc();
+    return std::unique_ptr<char, Deleter>(static_cast<char *>(raw));
+  }();
+  return page.get();
+}
+
+} // namespace
+#endif
+
+DiskManager::DiskManager(std::filesystem::path db_file, DiskOptions options)
     : file_name_(std::move(db_file)) {
   // ==========================================
   // 1. SETUP MAIN DATABASE FILE (.db)
@@ -18,34 +67,73 @@ DiskManager::DiskManager(std::filesystem::path db_file)
     out.close();
   }
 
+#ifdef _WIN32
   db_io_.rdbuf()->pubsetbuf(nullptr, 0);
   db_io_.open(file_name_, std::ios::binary | std::ios::in | std::ios::out);
 
   if (!db_io_.is_open()) {
     throw std::runtime_error("Failed to open db file");
   }
+#else
+  if (options.direct_io) {
+#ifdef O_DIRECT
+    db_fd_ = ::open(file_name_.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    if (db_fd_ >= 0) {
+      direct_io_ = true;
+    } else {
+      // e.g. tmpfs and some network filesystems refuse O_DIRECT
+      std::cerr << "[DISK] O_DIRECT rejected for " << file_name_ << " ("
+                << std::strerror(errno) << "), using the page cache"
+                << std::endl;
+    }
+#elif defined(F_NOCACHE)
+    db_fd_ = ::open(file_name_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (db_fd_ >= 0 && ::fcntl(db_fd_, F_NOCACHE, 1) == 0) {
+      direct_io_ = true; // macOS: uncached, but no alignment rules
+    }
+#endif
+  }
+  if (db_fd_ < 0) {
+    db_fd_ = ::open(file_name_.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw std::runtime_error("Failed to open db file");
+  }
+#endif
 
   next_page_id_ = static_cast<page_id_t>(GetFileSize() / PAGE_SIZE);
 
-  // ==========================================
-  // 2. SETUP SEQUENTIAL LOG FILE (.log)
-  // ==========================================
-  log_name_ = file_name_;
-  log_name_.replace_extension(".log");
-
-  if (!std::filesystem::exists(log_name_)) {
-    std::ofstream out(log_name_, std::ios::binary);
-    out.close();
+#ifndef _WIN32
+  if (options.io_engine == IoEngine::IO_URING) {
+    auto engine = std::make_unique<IoUringEngine>(IO_URING_QUEUE_DEPTH);
+    if (engine->IsAvailable()) {
+      uring_ = std::move(engine);
+    }
   }
+#else
+  if (options.direct_io) {
+    std::cerr << "[DISK] Direct I/O is not supported by the Windows backend, "
+                 "using the page cache"
+              << std::endl;
+  }
+#endif
 
-  log_io_.rdbuf()->pubsetbuf(nullptr, 0); // Disable buffering for safety
-  // Notice the ios::app flag! This ensures all writes go to the absolute end of
-  // the file.
-  log_io_.open(log_name_,
-               std::ios::binary | std::ios::in | std::ios::out | std::ios::app);
-
-  if (!log_io_.is_open()) {
-    throw std::runtime_error("Failed to open log file");
+  // ==========================================
+  // 2. SETUP WAL SEGMENT DIRECTORY (.wal/)
+  // ==========================================
+  log_dir_ = file_name_;
+  log_dir_.replace_extension(".wal");
+  log_segment_size_ = options.log_segment_size;
+  std::filesystem::create_directories(log_dir_);
+
+  // Databases created before segmentation have a single .log file. Its
+  // records predate byte-position LSNs and cannot be replayed; it is left
+  // in place.
+  std::filesystem::path legacy_log = file_name_;
+  legacy_log.replace_extension(".log");
+  if (std::filesystem::exists(legacy_log)) {
+    std::cerr << "[DISK WARNING] Ignoring " << legacy_log
+              << ": log format is no longer supported" << std::endl;
   }
 
   // ==========================================
@@ -70,6 +158,15 @@ DiskManager::DiskManager(std::filesystem::path db_file)
 }
 
 DiskManager::~DiskManager() {
+  uring_.reset(); // Drain the ring before its descriptor's target goes away
+
+#ifndef _WIN32
+  if (db_fd_ >= 0) {
+    ::close(db_fd_);
+    db_fd_ = -1;
+  }
+#endif
+
   std::scoped_lock<std::mutex> lock(alloc_latch_);
 
   // Prevent writing .freelist if it's already empty
@@ -91,11 +188,12 @@ DiskManager::~DiskManager() {
 }
 
 bool DiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+
+#ifdef _WIN32
   std::scoped_lock<std::mutex> lock(io_latch_);
 
   db_io_.clear();
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-
   db_io_.seekp(offset);
   db_io_.write(page_data, PAGE_SIZE);
   db_io_.flush();
@@ -106,14 +204,49 @@ bool DiskManager::WritePage(page_id_t page_id, const char *page_data) {
     return false;
   }
   return true;
+#else
+  if (direct_io_ && !IsPageAligned(page_data)) {
+    char *bounce = BouncePage();
+    std::memcpy(bounce, page_data, PAGE_SIZE);
+    page_data = bounce;
+  }
+
+  size_t done = 0;
+  bool retried = false; // after an O_DIRECT fallback
+  while (done < static_cast<size_t>(PAGE_SIZE)) {
+    ssize_t n = ::pwrite(db_fd_, page_data + done, PAGE_SIZE - done,
+                         static_cast<off_t>(offset + done));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EINVAL && !retried && DisableDirectIo()) {
+        retried = true;
+        continue;
+      }
+      std::cerr << "[DISK ERROR] Write failed for Page " << page_id << ": "
+                << std::strerror(errno) << std::endl;
+      return false;
+    }
+    done += static_cast<size_t>(n);
+  }
+  return true;
+#endif
 }
 
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+
+  // Redo reads pages that were allocated before a crash but never written;
+  // their ids must not be handed out again
+  page_id_t next = next_page_id_.load();
+  while (page_id >= next &&
+         !next_page_id_.compare_exchange_weak(next, page_id + 1)) {
+  }
+
+#ifdef _WIN32
   std::scoped_lock<std::mutex> lock(io_latch_);
 
   db_io_.clear();
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-
   db_io_.seekg(offset);
   db_io_.read(page_data, PAGE_SIZE);
 
@@ -122,15 +255,146 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   }
 
   int32_t cnt = db_io_.gcount();
+#else
+  char *dst = page_data;
+  if (direct_io_ && !IsPageAligned(page_data)) {
+    dst = BouncePage();
+  }
+
+  size_t done = 0;
+  bool retried = false; // after an O_DIRECT fallback
+  while (done < static_cast<size_t>(PAGE_SIZE)) {
+    ssize_t n = ::pread(db_fd_, dst + done, PAGE_SIZE - done,
+                        static_cast<off_t>(offset + done));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EINVAL && !retried && DisableDirectIo()) {
+        retried = true;
+        continue;
+      }
+      std::cerr << "[DISK ERROR] Read failed for Page " << page_id << ": "
+                << std::strerror(errno) << std::endl;
+      break;
+    }
+    if (n == 0)
+      break; // Past EOF: page was allocated but never written
+    done += static_cast<size_t>(n);
+  }
+
+  if (dst != page_data) {
+    std::memcpy(page_data, dst, done);
+  }
+
+  int32_t cnt = static_cast<int32_t>(done);
+#endif
+
   if (cnt < PAGE_SIZE) {
     std::fill(page_data + cnt, page_data + PAGE_SIZE, 0);
   }
 }
 
-// NEW: Append-only log writing
-void DiskManager::WriteLog(const char *log_data, int size) {
+bool DiskManager::DisableDirectIo() {
+#if !defined(_WIN32) && defined(O_DIRECT)
+  std::scoped_lock<std::mutex> lock(direct_io_latch_);
+  if (!direct_io_)
+    return true; // Another session fell back while our I/O was in flight
+
+  // The filesystem accepted O_DIRECT at open but rejects it for I/O. Linux
+  // lets us clear the flag on the live descriptor.
+  int flags = ::fcntl(db_fd_, F_GETFL);
+  if (flags < 0 || ::fcntl(db_fd_, F_SETFL, flags & ~O_DIRECT) < 0)
+    return false;
+  direct_io_ = false;
+  std::cerr << "[DISK] O_DIRECT I/O rejected for " << file_name_
+            << ", falling back to the page cache" << std::endl;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void DiskManager::ReadPages(std::vector<PageIO> &batch) {
+#ifndef _WIN32
+  if (GetIoEngine() == IoEngine::IO_URING && batch.size() > 1) {
+    std::vector<AsyncIoOp> ops;
+    ops.reserve(batch.size());
+    for (auto &io : batch) {
+      ops.push_back({false, io.data, static_cast<uint32_t>(PAGE_SIZE),
+                     static_cast<uint64_t>(io.page_id) * PAGE_SIZE, 0});
+    }
+    uring_->SubmitAndWait(db_fd_, ops);
+
+    for (size_t i = 0; i < batch.size(); i++) {
+      // Short reads (EOF on a never-written page) and errors go through the
+      // synchronous path, which zero-fills and reports
+      if (ops[i].result != PAGE_SIZE) {
+        ReadPage(batch[i].page_id, batch[i].data);
+      }
+      batch[i].ok = true;
+    }
+    return;
+  }
+#endif
+
+  for (auto &io : batch) {
+    ReadPage(io.page_id, io.data);
+    io.ok = true;
+  }
+}
+
+bool DiskManager::WritePages(std::vector<PageIO> &batch) {
+  bool all_ok = true;
+
+#ifndef _WIN32
+  if (GetIoEngine() == IoEngine::IO_URING && batch.size() > 1) {
+    std::vector<AsyncIoOp> ops;
+    ops.reserve(batch.size());
+    for (auto &io : batch) {
+      ops.push_back({true, io.data, static_cast<uint32_t>(PAGE_SIZE),
+                     static_cast<uint64_t>(io.page_id) * PAGE_SIZE, 0});
+    }
+    uring_->SubmitAndWait(db_fd_, ops);
+
+    for (size_t i = 0; i < batch.size(); i++) {
+      batch[i].ok = (ops[i].result == PAGE_SIZE) ||
+                    WritePage(batch[i].page_id, batch[i].data);
+      all_ok &= batch[i].ok;
+    }
+    return all_ok;
+  }
+#endif
+
+  for (auto &io : batch) {
+    io.ok = WritePage(io.page_id, io.data);
+    all_ok &= io.ok;
+  }
+  return all_ok;
+}
+
+// Append-only log writing
+void DiskManager::WriteLog(const char *log_data, int size, lsn_t first_lsn) {
   std::scoped_lock<std::mutex> lock(log_latch_);
 
+  if (!log_io_.is_open() || log_segment_bytes_ >= log_segment_size_) {
+    // Start the next segment. A fresh segment per run also keeps new
+    // records clear of a torn tail left by a crash. A segment already named
+    // after this LSN can only hold such a tail (recovery resumes the log
+    // where its valid records end), so it is overwritten.
+    if (log_io_.is_open()) {
+      log_io_.close();
+    }
+    log_io_.rdbuf()->pubsetbuf(nullptr, 0); // Disable buffering for safety
+    std::filesystem::path segment = log_dir_ / SegmentFileName(first_lsn);
+    log_io_.open(segment, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!log_io_.is_open()) {
+      std::cerr << "[DISK ERROR] Failed to open log segment " << segment
+                << std::endl;
+      return;
+    }
+    log_segment_bytes_ = std::filesystem::file_size(segment);
+  }
+
   log_io_.clear();
 
   // Write the chunk of memory
@@ -142,6 +406,85 @@ void DiskManager::WriteLog(const char *log_data, int size) {
   if (log_io_.fail()) {
     std::cerr << "[DISK ERROR] Write/Flush failed for Log" << std::endl;
   }
+  log_segment_bytes_ += size;
+}
+
+std::vector<LogSegment> DiskManager::GetLogSegments() {
+  std::vector<LogSegment> segments;
+  for (const auto &entry : std::filesystem::directory_iterator(log_dir_)) {
+    if (entry.path().extension() != ".seg") {
+      continue;
+    }
+    try {
+      lsn_t first_lsn =
+          static_cast<lsn_t>(std::stoll(entry.path().stem().string(), nullptr, 16));
+      segments.push_back({first_lsn, entry.path()});
+    } catch (const std::exception &) {
+      // Not one of ours
+    }
+  }
+  std::sort(segments.begin(), segments.end(),
+            [](const LogSegment &a, const LogSegment &b) {
+              return a.first_lsn < b.first_lsn;
+            });
+  return segments;
+}
+
+size_t DiskManager::RemoveLogSegmentsBefore(lsn_t lsn) {
+  std::scoped_lock<std::mutex> lock(log_latch_);
+  std::vector<LogSegment> segments = GetLogSegments();
+
+  // Segment i holds LSNs [first_lsn(i), first_lsn(i + 1))
+  size_t removed = 0;
+  for (size_t i = 0; i + 1 < segments.size(); i++) {
+    if (segments[i + 1].first_lsn > lsn) {
+      break;
+    }
+    std::error_code ec;
+    if (std::filesystem::remove(segments[i].path, ec)) {
+      removed++;
+    }
+  }
+  return removed;
+}
+
+void DiskManager::WriteLogMaster(const LogMaster &master) {
+  std::scoped_lock<std::mutex> lock(log_latch_);
+  std::filesystem::path master_name = log_dir_ / "master";
+  std::filesystem::path tmp_name = log_dir_ / "master.tmp";
+
+  {
+    std::ofstream out(tmp_name, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&LOG_MASTER_MAGIC),
+              sizeof(LOG_MASTER_MAGIC));
+    out.write(reinterpret_cast<const char *>(&master.checkpoint_lsn),
+              sizeof(lsn_t));
+    out.write(reinterpret_cast<const char *>(&master.start_lsn), sizeof(lsn_t));
+    out.flush();
+    if (out.fail()) {
+      std::cerr << "[DISK ERROR] Write failed for log master record"
+                << std::endl;
+      return;
+    }
+  }
+  std::filesystem::rename(tmp_name, master_name);
+}
+
+bool DiskManager::ReadLogMaster(LogMaster *master) {
+  std::scoped_lock<std::mutex> lock(log_latch_);
+  std::ifstream in(log_dir_ / "master", std::ios::binary);
+  uint32_t magic = 0;
+  LogMaster read_master;
+  if (!in.read(reinterpret_cast<char *>(&magic), sizeof(magic)) ||
+      magic != LOG_MASTER_MAGIC ||
+      !in.read(reinterpret_cast<char *>(&read_master.checkpoint_lsn),
+               sizeof(lsn_t)) ||
+      !in.read(reinterpret_cast<char *>(&read_master.start_lsn),
+               sizeof(lsn_t))) {
+    return false;
+  }
+  *master = read_master;
+  return true;
 }
 
 page_id_t DiskManager::AllocatePage() {
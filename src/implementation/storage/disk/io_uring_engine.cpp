@@ -0,0 +1,226 @@
+// io_uring_engine.cpp
+
+#include "storage/disk/io_uring_engine.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define TETODB_HAS_IO_URING 1
+#endif
+#endif
+
+#ifdef TETODB_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#endif
+
+namespace tetodb {
+
+#ifdef TETODB_HAS_IO_URING
+
+IoUringEngine::IoUringEngine(uint32_t queue_depth) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+
+  int fd = static_cast<int>(
+      ::syscall(__NR_io_uring_setup, queue_depth, &params));
+  if (fd < 0) {
+    std::cerr << "[DISK] io_uring unavailable (" << std::strerror(errno)
+              << "), using synchronous I/O" << std::endl;
+    return;
+  }
+  ring_fd_.store(fd);
+  sq_entries_ = params.sq_entries;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+
+  sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    Teardown();
+    return;
+  }
+
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      Teardown();
+      return;
+    }
+  }
+
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = nullptr;
+    Teardown();
+    return;
+  }
+
+  char *sq = static_cast<char *>(sq_ring_);
+  sq_tail_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+
+  char *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+}
+
+IoUringEngine::~IoUringEngine() { Teardown(); }
+
+void IoUringEngine::Teardown() {
+  if (sqes_ != nullptr)
+    ::munmap(sqes_, sqes_size_);
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+    ::munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != nullptr)
+    ::munmap(sq_ring_, sq_ring_size_);
+  sqes_ = cq_ring_ = sq_ring_ = nullptr;
+
+  int fd = ring_fd_.exchange(-1);
+  if (fd >= 0)
+    ::close(fd);
+}
+
+void IoUringEngine::SubmitAndWait(int fd, std::vector<AsyncIoOp> &ops) {
+  std::scoped_lock<std::mutex> lock(latch_);
+
+  auto *sqes = static_cast<io_uring_sqe *>(sqes_);
+  auto *cqes = static_cast<io_uring_cqe *>(cqes_);
+
+  size_t next = 0;
+  while (next < ops.size()) {
+    if (!IsAvailable()) {
+      for (size_t i = next; i < ops.size(); i++)
+        ops[i].result = -EIO;
+      return;
+    }
+
+    // 1. Fill the submission queue (we are its only producer)
+    uint32_t batch = static_cast<uint32_t>(
+        std::min<size_t>(sq_entries_, ops.size() - next));
+    uint32_t tail = *sq_tail_;
+    uint32_t mask = *sq_mask_;
+
+    for (uint32_t i = 0; i < batch; i++) {
+      AsyncIoOp &op = ops[next + i];
+      uint32_t idx = tail & mask;
+      io_uring_sqe *sqe = &sqes[idx];
+      std::memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = op.is_write ? IORING_OP_WRITE : IORING_OP_READ;
+      sqe->fd = fd;
+      sqe->addr = reinterpret_cast<uint64_t>(op.buf);
+      sqe->len = op.len;
+      sqe->off = op.offset;
+      sqe->user_data = next + i;
+      sq_array_[idx] = idx;
+      op.result = -EINPROGRESS;
+      tail++;
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    // 2. Submit and reap until every op in this batch has a completion
+    uint32_t submitted = 0;
+    uint32_t completed = 0;
+    auto reap = [&] {
+      uint32_t head = *cq_head_;
+      uint32_t cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      while (head != cq_tail) {
+        io_uring_cqe *cqe = &cqes[head & *cq_mask_];
+        ops[cqe->user_data].result = cqe->res;
+        head++;
+        completed++;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    };
+
+    while (completed < batch) {
+      uint32_t to_submit = batch - submitted;
+      int ret = static_cast<int>(
+          ::syscall(__NR_io_uring_enter, ring_fd_.load(), to_submit, 1,
+                    IORING_ENTER_GETEVENTS, nullptr, 0));
+      if (ret < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+          continue;
+
+        // Unrecoverable ring error. The kernel may still be reading or
+        // writing the buffers of what was submitted, and closing the ring
+        // does not wait for that, so every submitted op is reaped first.
+        // The caller redoes the rest synchronously.
+        std::cerr << "[DISK ERROR] io_uring_enter failed: "
+                  << std::strerror(errno) << std::endl;
+        reap();
+        while (completed < submitted) {
+          if (::syscall(__NR_io_uring_enter, ring_fd_.load(), 0,
+                        submitted - completed, IORING_ENTER_GETEVENTS,
+                        nullptr, 0) < 0 &&
+              errno != EINTR) {
+            // Cannot sleep on the ring either: poll its completion queue
+            std::this_thread::yield();
+          }
+          reap();
+        }
+        Teardown();
+        break;
+      }
+      submitted += static_cast<uint32_t>(ret);
+      reap();
+    }
+
+    for (uint32_t i = 0; i < batch; i++) {
+      if (ops[next + i].result == -EINPROGRESS)
+        ops[next + i].result = -EIO;
+    }
+    next += batch;
+  }
+}
+
+#else // !TETODB_HAS_IO_URING
+
+IoUringEngine::IoUringEngine(uint32_t /*queue_depth*/) {
+  std::cerr << "[DISK] io_uring is not supported on this platform, using "
+               "synchronous I/O"
+            << std::endl;
+}
+
+IoUringEngine::~IoUringEngine() = default;
+
+void IoUringEngine::Teardown() {}
+
+void IoUringEngine::SubmitAndWait(int /*fd*/, std::vector<AsyncIoOp> &ops) {
+  for (auto &op : ops)
+    op.result = -EIO;
+}
+
+#endif
+
+} // namespace tetodb
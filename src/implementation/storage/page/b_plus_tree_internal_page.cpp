@@ -55,7 +55,8 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(
  *****************************************************************************/
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(
-    BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager) {
+    BPlusTreeInternalPage *recipient,
+    [[maybe_unused]] BufferPoolManager *buffer_pool_manager) {
   uint32_t total_size = GetSize();
   uint32_t split_idx = total_size / 2;
   uint32_t move_count = total_size - split_idx;
@@ -65,19 +66,48 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(
 
   recipient->SetSize(move_count);
   SetSize(split_idx);
+}
 
-  // CRITICAL: We moved children to a new parent. Update their Parent ID.
-  // This part is I/O heavy but unavoidable.
-  for (uint32_t i = 0; i < move_count; i++) {
-    page_id_t child_page_id = recipient->ValueAt(i);
-    Page *child_page = buffer_pool_manager->FetchPage(child_page_id);
+/*****************************************************************************
+ * MERGE & REDISTRIBUTE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(
+    BPlusTreeInternalPage *recipient, const KeyType &middle_key,
+    [[maybe_unused]] BufferPoolManager *buffer_pool_manager) {
+  array_[0].first = middle_key;
+  std::copy(array_, array_ + GetSize(),
+            recipient->array_ + recipient->GetSize());
+
+  recipient->IncreaseSize(GetSize());
+  SetSize(0);
+}
 
-    if (child_page != nullptr) {
-      auto *b_node = new (child_page->GetData()) BPlusTreePage;
-      b_node->SetParentPageId(recipient->GetPageId());
-      buffer_pool_manager->UnpinPage(child_page_id, true);
-    }
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertAt(uint32_t index,
+                                              const MappingType &item) {
+  std::move_backward(array_ + index, array_ + GetSize(),
+                     array_ + GetSize() + 1);
+  array_[index] = item;
+  IncreaseSize(1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAt(uint32_t index) {
+  std::move(array_ + index + 1, array_ + GetSize(), array_ + index);
+  IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t
+B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  // Linear scan is fine here (Size ~ 200).
+  // Optimization: Buffer Pool pinning dominates cost, not this loop.
+  for (uint32_t i = 0; i < GetSize(); i++) {
+    if (ValueAt(i) == value)
+      return i;
   }
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -88,15 +118,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(
     const ValueType &old_value, const KeyType &new_key,
     const ValueType &new_value) {
   // 1. Find the index of the old_value
-  // Linear scan is fine here (Size ~ 200).
-  // Optimization: Buffer Pool pinning dominates cost, not this loop.
-  uint32_t index = GetSize(); // Default to invalid
-  for (uint32_t i = 0; i < GetSize(); i++) {
-    if (ValueAt(i) == old_value) {
-      index = i;
-      break;
-    }
-  }
+  uint32_t index = ValueIndex(old_value);
 
   // Safety check
   if (index == GetSize()) {
@@ -57,23 +57,43 @@ INDEX_TEMPLATE_ARGUMENTS
 uint32_t B_PLUS_TREE_LEAF_PAGE_TYPE::Remove(const KeyType &key,
                                             const ValueType &value,
                                             const KeyComparator &comparator) {
-  uint32_t target_idx = KeyIndex(key, comparator);
+  uint32_t idx = EntryIndex(key, value, comparator);
+  if (idx < GetSize())
+    RemoveAt(idx);
+  return GetSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t
+B_PLUS_TREE_LEAF_PAGE_TYPE::EntryIndex(const KeyType &key,
+                                       const ValueType &value,
+                                       const KeyComparator &comparator) const {
   uint32_t current_size = GetSize();
 
-  // --- DUPLICATE AWARE REMOVAL ---
+  // --- DUPLICATE AWARE LOOKUP ---
   // Loop through all duplicates of this key to find the exact matching RID
-  for (uint32_t i = target_idx; i < current_size; i++) {
-    if (comparator(array_[i].first, key) == 0) {
-      if (array_[i].second == value) { // Found the exact row!
-        std::move(array_ + i + 1, array_ + current_size, array_ + i);
-        IncreaseSize(-1);
-        break;
-      }
-    } else {
+  for (uint32_t i = KeyIndex(key, comparator); i < current_size; i++) {
+    if (comparator(array_[i].first, key) != 0)
       break; // Passed the duplicates, stop searching
-    }
+    if (array_[i].second == value)
+      return i; // Found the exact row!
   }
-  return GetSize();
+  return current_size;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAt(uint32_t index) {
+  std::move(array_ + index + 1, array_ + GetSize(), array_ + index);
+  IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::InsertAt(uint32_t index,
+                                          const MappingType &item) {
+  std::move_backward(array_ + index, array_ + GetSize(),
+                     array_ + GetSize() + 1);
+  array_[index] = item;
+  IncreaseSize(1);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
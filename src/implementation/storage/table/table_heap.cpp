@@ -18,6 +18,19 @@ TableHeap::TableHeap(BufferPoolManager *bpm, LogManager *log_manager,
 
   table_page->Init(first_page_id, PAGE_SIZE);
 
+  // Logged like any other new page: the page may be a freed B+ tree node,
+  // and redo has to format it before replaying the inserts
+  if (log_manager_ != nullptr) {
+    bool chained = txn != nullptr;
+    LogRecord page_log(chained ? txn->GetTransactionId() : INVALID_TRANSACTION_ID,
+                       chained ? txn->GetPrevLSN() : INVALID_LSN,
+                       LogRecordType::NEWPAGE, INVALID_PAGE_ID, first_page_id);
+    lsn_t page_lsn = log_manager_->AppendLogRecord(&page_log);
+    if (chained)
+      txn->SetPrevLSN(page_lsn);
+    table_page->SetLSN(page_lsn);
+  }
+
   guard.MarkDirty();
 
   first_page_id_ = first_page_id;
@@ -56,7 +69,8 @@ TableHeap::TableHeap(BufferPoolManager *bpm, page_id_t first_page_id,
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn,
-                            LockManager *lock_mgr) {
+                            LockManager *lock_mgr,
+                            BufferAccessStrategy *strategy) {
   if (tuple.GetSize() + 32 > PAGE_SIZE)
     return false;
 
@@ -76,7 +90,7 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn,
   // FSM confirms no page has space. Allocate a new page.
   if (target_page_id == INVALID_PAGE_ID) {
     page_id_t new_page_id;
-    Page *new_page = bpm_->NewPage(&new_page_id);
+    Page *new_page = bpm_->NewPage(&new_page_id, strategy);
     if (new_page == nullptr)
       return false;
 
@@ -149,7 +163,7 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn,
   }
 
   // FSM found a valid page. Use it.
-  Page *page = bpm_->FetchPage(target_page_id);
+  Page *page = bpm_->FetchPage(target_page_id, strategy);
   if (page == nullptr)
     return false;
 
@@ -195,8 +209,9 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn,
   return false;
 }
 
-bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
-  Page *page = bpm_->FetchPage(rid.GetPageId());
+bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn,
+                         BufferAccessStrategy *strategy) {
+  Page *page = bpm_->FetchPage(rid.GetPageId(), strategy);
   if (page == nullptr)
     return false;
 
@@ -277,8 +292,10 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, RID *rid, Transaction *txn,
       }
 
       if (txn != nullptr && log_manager_ != nullptr) {
-        LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
-                             LogRecordType::UPDATE, *rid, old_tuple, tuple);
+        // Only the changed bytes: redo/undo rebuild the other image from
+        // the one on the page
+        LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), *rid,
+                             TupleDelta::Diff(old_tuple, tuple));
         lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
         txn->SetPrevLSN(lsn);
         guard.As<TablePage>()->SetLSN(lsn);
@@ -6,13 +6,14 @@
 
 namespace tetodb {
 
-    TableIterator::TableIterator(TableHeap* table_heap, RID rid)
-        : table_heap_(table_heap), rid_(rid) {
+    TableIterator::TableIterator(TableHeap* table_heap, RID rid,
+                                 BufferAccessStrategy* strategy)
+        : table_heap_(table_heap), rid_(rid), strategy_(strategy) {
 
         // Valid start? Check if the specific RID is actually valid.
         if (rid_.GetPageId() != INVALID_PAGE_ID) {
             BufferPoolManager* bpm = table_heap_->GetBufferPoolManager();
-            Page* page = bpm->FetchPage(rid_.GetPageId());
+            Page* page = bpm->FetchPage(rid_.GetPageId(), strategy_);
 
             if (page != nullptr) {
                 ReadPageGuard guard(bpm, page);
@@ -41,7 +42,7 @@ namespace tetodb {
         // 3. Loop until we find a valid tuple or run out of pages
         while (rid_.GetPageId() != INVALID_PAGE_ID) {
 
-            Page* page = bpm->FetchPage(rid_.GetPageId());
+            Page* page = bpm->FetchPage(rid_.GetPageId(), strategy_);
             if (page == nullptr) {
                 rid_.Set(INVALID_PAGE_ID, 0);
                 return *this;
@@ -66,6 +67,7 @@ namespace tetodb {
             // End of Page reached. Jump to next page.
             page_id_t next_page_id = table_page->GetNextPageId();
             rid_.Set(next_page_id, 0);
+            bpm->ReadAhead(&read_ahead_, next_page_id);
 
             // Loop repeats. Next iteration starts checking at Slot 0.
         }
@@ -97,6 +97,15 @@ struct ViewMetadata {
   view_oid_t oid_;
 };
 
+// Index builds fill B+ tree nodes to this percentage by default, leaving
+// room for inserts before nodes split (SET index_fill_factor)
+constexpr uint32_t DEFAULT_INDEX_FILL_FACTOR = 90;
+constexpr uint32_t MIN_INDEX_FILL_FACTOR = 50;
+
+// Memory an index build sorts its entries in before spilling sorted runs
+// to temporary files
+constexpr size_t INDEX_BUILD_SORT_MEMORY = 16 * 1024 * 1024;
+
 /**
  * Catalog: The "Phonebook" of the database.
  */
@@ -141,9 +150,12 @@ public:
   ViewMetadata *GetView(view_oid_t view_oid);
   bool DropView(const std::string &view_name);
 
+  // Percentage of each B+ tree node that index builds fill
+  void SetIndexFillFactor(uint32_t percent) { index_fill_factor_ = percent; }
+  uint32_t GetIndexFillFactor() const { return index_fill_factor_; }
+
   void SaveCatalog(const std::string &file_path);
-  void LoadCatalog(const std::string &file_path,
-                   bool force_index_rebuild = false);
+  void LoadCatalog(const std::string &file_path);
 
 private:
   void PopulateIndex(TableMetadata *table_meta, IndexMetadata *index_meta,
@@ -169,6 +181,7 @@ private:
   std::unordered_map<std::string, view_oid_t> view_names_;
 
   bool is_loading_{false};
+  std::atomic<uint32_t> index_fill_factor_{DEFAULT_INDEX_FILL_FACTOR};
 };
 
 } // namespace tetodb
\ No newline at end of file
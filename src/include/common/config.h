@@ -9,13 +9,13 @@ namespace tetodb {
 	static constexpr int32_t PAGE_SIZE = 4096;
 	static constexpr int32_t INVALID_PAGE_ID = -1;
 	static constexpr int32_t INVALID_FRAME_ID = -1;
-	static constexpr int32_t INVALID_LSN = -1;
+	static constexpr int64_t INVALID_LSN = -1;
 	static constexpr int32_t INVALID_TRANSACTION_ID = -1;
 
 	// type aliases
 	using page_id_t = int32_t;	// identifier for page on disk
 	using frame_id_t = int32_t;	// identifier for page in RAM
 	using txn_id_t = int32_t;	// Transaction ID Type
-	using lsn_t = int32_t;		// Log Sequence Number Type
+	using lsn_t = int64_t;		// Log Sequence Number: byte position in the WAL
 
 } // namespace tetodb
\ No newline at end of file
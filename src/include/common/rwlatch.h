@@ -10,6 +10,7 @@ namespace tetodb {
 	public:
 		inline void WLock() { mutex_.lock(); }
 		inline void WUnlock() { mutex_.unlock(); }
+		inline bool TryWLock() { return mutex_.try_lock(); }
 		inline void RLock() { mutex_.lock_shared(); }
 		inline void RUnlock() { mutex_.unlock_shared(); }
 
@@ -68,8 +68,17 @@ public:
   inline IsolationLevel GetIsolationLevel() const { return isolation_level_; }
 
   // --- WAL (Write-Ahead Logging) LSN TRACKING ---
-  inline int32_t GetPrevLSN() const { return prev_lsn_; }
-  inline void SetPrevLSN(int32_t prev_lsn) { prev_lsn_ = prev_lsn; }
+  inline lsn_t GetPrevLSN() const { return prev_lsn_; }
+  inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
+  // While set (recovery undoing this transaction), its records are CLRs
+  // that resume undo at this LSN
+  inline lsn_t GetUndoNextLSN() const { return undo_next_lsn_; }
+  inline void SetUndoNextLSN(lsn_t lsn) { undo_next_lsn_ = lsn; }
+
+  // Off: Commit returns once the COMMIT record is appended and the flush
+  // thread makes it durable within LOG_FLUSH_INTERVAL
+  inline void SetSynchronousCommit(bool on) { synchronous_commit_ = on; }
+  inline bool IsSynchronousCommit() const { return synchronous_commit_; }
 
   // --- PAGE SET (Leaf/Internal Nodes) ---
   inline void AddIntoPageSet(Page *page) { page_set_.push_back(page); }
@@ -149,7 +158,9 @@ private:
   txn_id_t txn_id_;
 
   // --- WAL FIELDS ---
-  int32_t prev_lsn_{-1};
+  lsn_t prev_lsn_{INVALID_LSN};
+  lsn_t undo_next_lsn_{INVALID_LSN};
+  bool synchronous_commit_{true};
 
   // --- EXISTING FIELDS ---
   IsolationLevel isolation_level_;
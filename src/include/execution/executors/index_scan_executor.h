@@ -26,7 +26,6 @@ private:
 
   // Results from the B+ Tree Iterator
   std::unique_ptr<AbstractIndexIterator> iterator_;
-  Tuple search_key_;
   const Schema *index_key_schema_;
 };
 
@@ -7,6 +7,7 @@
 #include "storage/table/tuple.h"
 #include "catalog/catalog.h" 
 #include "execution/plans/insert_plan.h" // <-- The Blueprint
+#include "storage/buffer/buffer_access_strategy.h"
 
 namespace tetodb {
 
@@ -24,6 +25,8 @@ namespace tetodb {
         TableMetadata* table_info_;
         std::vector<IndexMetadata*> table_indexes_;
         size_t cursor_;
+        // Large multi-row inserts fill new heap pages in a private ring
+        std::unique_ptr<BufferAccessStrategy> strategy_;
     };
 
 } // namespace tetodb
\ No newline at end of file
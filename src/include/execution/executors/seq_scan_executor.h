@@ -4,6 +4,7 @@
 
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h" 
+#include "storage/buffer/buffer_access_strategy.h"
 #include "storage/table/table_iterator.h"
 
 namespace tetodb {
@@ -22,6 +23,8 @@ namespace tetodb {
         TableMetadata* metadata_;
         // Use unique_ptr for iterator to allow lazy initialization
         std::unique_ptr<TableIterator> iter_;
+        // Keeps a scan of a big table from flushing the shared pool
+        std::unique_ptr<BufferAccessStrategy> strategy_;
     };
 
 } // namespace tetodb
\ No newline at end of file
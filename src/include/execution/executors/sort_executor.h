@@ -23,6 +23,10 @@ namespace tetodb {
         const Schema* GetOutputSchema() override;
 
     private:
+        // Sorts sorted_tuples_ by one memcmp-ordered key per row; false if
+        // some ORDER BY column mixes types no one encoding orders
+        bool SortByNormalizedKeys(const Schema* schema);
+
         const SortPlanNode* plan_;
         std::unique_ptr<AbstractExecutor> child_executor_;
 
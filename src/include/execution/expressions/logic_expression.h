@@ -110,6 +110,8 @@ public:
 
   TypeId GetReturnType() const override { return TypeId::BOOLEAN; }
 
+  inline LogicType GetLogicType() const { return logic_type_; }
+
 private:
   LogicType logic_type_;
 };
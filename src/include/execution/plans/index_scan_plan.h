@@ -3,6 +3,7 @@
 #pragma once
 
 #include "execution/plans/abstract_plan.h"
+#include "index/index.h"
 #include "storage/table/tuple.h"
 #include <string>
 
@@ -12,36 +13,75 @@ namespace tetodb {
 
     class IndexScanPlanNode : public AbstractPlanNode {
     public:
+        // Equality scan: every key starting with the first `key_columns`
+        // key columns, held by `key_tuple`
         IndexScanPlanNode(const Schema* output_schema,
             index_oid_t index_oid,
             table_oid_t table_oid,
             Tuple key_tuple,
+            uint32_t key_columns = 1, // Leading key columns in key_tuple
             IndexType index_type = IndexType::BTREE) // Defaults to BTREE
             : AbstractPlanNode(output_schema, PlanType::IndexScan),
             index_oid_(index_oid),
             table_oid_(table_oid),
-            key_tuple_(std::move(key_tuple)),
+            lower_{key_tuple, key_columns, true},
+            upper_{std::move(key_tuple), key_columns, true},
+            is_range_(false),
+            index_type_(index_type) {
+        }
+
+        // Range scan: keys from `lower` to `upper` (either may be open)
+        IndexScanPlanNode(const Schema* output_schema,
+            index_oid_t index_oid,
+            table_oid_t table_oid,
+            IndexBound lower,
+            IndexBound upper,
+            IndexType index_type = IndexType::BTREE)
+            : AbstractPlanNode(output_schema, PlanType::IndexScan),
+            index_oid_(index_oid),
+            table_oid_(table_oid),
+            lower_(std::move(lower)),
+            upper_(std::move(upper)),
+            is_range_(true),
             index_type_(index_type) {
         }
 
         inline index_oid_t GetIndexOid() const { return index_oid_; }
         inline table_oid_t GetTableOid() const { return table_oid_; }
-        inline Tuple GetSearchKey() const { return key_tuple_; }
+        inline const IndexBound& GetLowerBound() const { return lower_; }
+        inline const IndexBound& GetUpperBound() const { return upper_; }
         inline IndexType GetIndexType() const { return index_type_; }
 
         std::string ToString() const override {
             std::string type_str = (index_type_ == IndexType::BTREE) ? "B+Tree" : "Hash";
+            std::string key_str;
+            if (!is_range_) {
+                key_str = ", Key Columns: " + std::to_string(lower_.key_columns);
+            } else {
+                key_str = ", Range: " + BoundToString(lower_, true) + ".." +
+                    BoundToString(upper_, false);
+            }
             return "IndexScan [Index OID: " + std::to_string(index_oid_) +
-                ", Table OID: " + std::to_string(table_oid_) +
+                ", Table OID: " + std::to_string(table_oid_) + key_str +
                 ", Type: " + type_str + "]";
         }
 
         std::vector<const AbstractPlanNode*> GetChildren() const override { return {}; }
 
     private:
+        // e.g. "[2 cols" for an inclusive lower bound on two key columns
+        static std::string BoundToString(const IndexBound& bound, bool is_lower) {
+            if (bound.key_columns == 0) return "open";
+            std::string cols = std::to_string(bound.key_columns) + " cols";
+            if (is_lower) return (bound.inclusive ? "[" : "(") + cols;
+            return cols + (bound.inclusive ? "]" : ")");
+        }
+
         index_oid_t index_oid_;
         table_oid_t table_oid_;
-        Tuple key_tuple_;
+        IndexBound lower_;
+        IndexBound upper_;
+        bool is_range_;
         IndexType index_type_;
     };
 }  // namespace tetodb
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <queue>
 #include <string>
 #include <vector>
@@ -11,6 +13,7 @@
 #include "storage/page/b_plus_tree_leaf_page.h"
 #include "storage/buffer/buffer_pool_manager.h"
 #include "concurrency/transaction.h"
+#include "recovery/log_manager.h"
 
 namespace tetodb {
 
@@ -23,11 +26,23 @@ namespace tetodb {
     class BPlusTree {
     public:
         // --- UPDATED CONSTRUCTOR ---
+        // With no root page, an empty root leaf is created. The root page
+        // keeps its id for the life of the tree. With a log manager, every
+        // change to the tree's pages is logged (see BTreeChange).
         explicit BPlusTree(std::string name, BufferPoolManager* buffer_pool_manager, const KeyComparator& comparator,
             uint32_t leaf_max_size = LEAF_PAGE_SIZE, uint32_t internal_max_size = INTERNAL_PAGE_SIZE,
-            page_id_t root_page_id = INVALID_PAGE_ID);
-
-        inline bool IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+            page_id_t root_page_id = INVALID_PAGE_ID, LogManager* log_manager = nullptr);
+
+        // Node sizes the catalog creates trees with: a node holds one entry
+        // over its max size just before it splits, which must still fit
+        static constexpr uint32_t DefaultLeafMaxSize() {
+            return (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, ValueType>) - 1;
+        }
+        static constexpr uint32_t DefaultInternalMaxSize() {
+            return (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, page_id_t>) - 1;
+        }
+
+        inline bool IsEmpty() const { return root_page_id_.load() == INVALID_PAGE_ID; }
         inline uint32_t GetDepth() { return depth_; }
         inline page_id_t GetRootPageId() const { return root_page_id_; } // <-- NEW
 
@@ -36,6 +51,23 @@ namespace tetodb {
         bool Remove(const KeyType& key, const ValueType& value, Transaction* transaction = nullptr);
         bool GetValue(const KeyType& key, std::vector<ValueType>* result, Transaction* transaction = nullptr);
 
+        // Online compaction: walks the leaves left to right and merges or
+        // refills every underfull node on the way, under the same latches as
+        // Remove(). Returns the number of pages taken out of the tree.
+        uint32_t Compact(Transaction* transaction);
+
+        // Builds the tree bottom-up from the entries `next` hands out in key
+        // order, until it returns false. Leaves and inner nodes are filled to
+        // `fill_percent` of their max size (kept between half and all of
+        // it), and the top node is copied into the root page. Only for an
+        // empty tree no one is using yet (index creation).
+        void BulkLoad(const std::function<bool(KeyType*, ValueType*)>& next, uint32_t fill_percent,
+            Transaction* transaction = nullptr);
+
+        // Pages in the tree. Walks it without latches, so only for a tree
+        // no one is changing (tests, benchmarks).
+        uint32_t GetPageCount();
+
         // Iterators
         INDEXITERATOR_TYPE Begin();
         INDEXITERATOR_TYPE Begin(const KeyType& key);
@@ -45,34 +77,132 @@ namespace tetodb {
         void Destroy();
 
     private:
+        using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+        using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
+
         // --- HELPER FUNCTIONS ---
 
-        void StartNewTree(const KeyType& key, const ValueType& value);
+        void StartNewTree(Transaction* transaction = nullptr);
 
         // Modified: Now accepts Transaction pointer
         bool InsertIntoLeaf(const KeyType& key, const ValueType& value, Transaction* transaction = nullptr);
 
-        // NEW: Helper to handle deletion logic (and future merging/redistribution)
+        // NEW: Helper to handle deletion logic (and merging/redistribution)
         bool RemoveFromLeaf(const KeyType& key, const ValueType& value, Transaction* transaction = nullptr);
 
+        // --- UNDERFLOW HANDLING ---
+
+        // Fixes `node` if it is underfull, then each parent it leaves
+        // underfull in turn. The parents are the latched pages at the back of
+        // the transaction's page set. The unchanged ones are released here,
+        // so the page set keeps only parents that changed, to be unpinned
+        // dirty. Returns whether anything changed.
+        bool Rebalance(BPlusTreePage* node, Transaction* transaction);
+
+        // Merges `node` with a sibling, or moves one entry over from it.
+        // False if there is no sibling to use.
+        bool CoalesceOrRedistribute(BPlusTreePage* node, InternalPage* parent, Transaction* transaction);
+
+        // Moves everything in `right` (entry `right_index` of `parent`) to
+        // `left` and takes `right` out of the parent
+        void Coalesce(BPlusTreePage* left, BPlusTreePage* right, InternalPage* parent,
+            uint32_t right_index, Transaction* transaction);
+
+        // Moves one entry from `right` to `left` (or back, if not `to_left`)
+        void Redistribute(BPlusTreePage* left, BPlusTreePage* right, InternalPage* parent,
+            uint32_t right_index, bool to_left, Transaction* transaction);
+
+        // The root keeps its page id: its only child moves up into it
+        void CollapseRoot(InternalPage* root, BPlusTreePage* child, Transaction* transaction);
+
+        // Frees the pages merges took out of the tree, once none is latched
+        void DeletePages(Transaction* transaction);
+
+        // Compact(): the first key of the first non-empty leaf after `leaf`
+        // that is greater than `*key` (any key, if `any`)
+        bool NextLeafKey(LeafPage* leaf, KeyType* key, bool any);
+
         void DestroyNode(page_id_t page_id);
 
+        // --- BULK LOADING ---
+
+        // Entries a bulk-loaded node of `max_size` gets at `fill_percent`
+        static uint32_t FillSize(uint32_t max_size, uint32_t fill_percent);
+
+        // Packs `children` (each child's first key and page id, in key order)
+        // into a level of new internal nodes and returns theirs
+        std::vector<std::pair<KeyType, page_id_t>> BuildInternalLevel(
+            const std::vector<std::pair<KeyType, page_id_t>>& children, uint32_t fill_percent,
+            Transaction* transaction);
+
+        // Logs a bulk-loaded node in full and unpins it
+        void FinishNode(BPlusTreePage* node, Transaction* transaction);
+
         template <typename N>
-        N* Split(N* node);
+        N* Split(N* node, Transaction* transaction = nullptr);
 
         void InsertIntoParent(BPlusTreePage* old_node, const KeyType& key, BPlusTreePage* new_node,
             Transaction* transaction = nullptr);
 
+        // Points every child of `node` back at it
+        void AdoptChildren(BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>* node,
+            Transaction* transaction);
+
+        // Points child `index` of `node` back at it
+        void AdoptChild(InternalPage* node, uint32_t index, Transaction* transaction);
+
+        // --- LOGGING HELPERS ---
+
+        // Appends a BTREE_* record on the transaction's chain (a system
+        // record without one) and stamps `node`, if given, with its LSN
+        void AppendLog(LogRecordType type, BTreeChange change, BPlusTreePage* node,
+            Transaction* transaction);
+
+        // Logs `node`'s bytes [offset, offset + length) as they are now
+        void LogBytes(BPlusTreePage* node, uint32_t offset, uint32_t length, Transaction* transaction);
+
+        // Logs `node`'s whole image as one that formats its page
+        void LogNode(BPlusTreePage* node, Transaction* transaction);
+
+        // Logs entry `index` of `node` as just inserted / about to be removed.
+        // A `moved` leaf entry (redistribution) names no tree: it stays in
+        // the tree, so undo leaves it alone.
+        void LogEntry(LogRecordType type, BPlusTreePage* node, uint32_t index, Transaction* transaction,
+            bool moved = false);
+
+        // Logs the key of entry `index` of `node` as it is now
+        void LogKey(InternalPage* node, uint32_t index, Transaction* transaction);
+
+        // Header plus entries: the part of the page in use
+        uint32_t UsedBytes(const BPlusTreePage* node) const;
+
         // Modified: Now accepts Operation Mode and Transaction
         // This is the heart of Latch Crabbing.
+        // READ descents try FindLeafPageOptimistic() first unless
+        // `optimistic` is false.
         Page* FindLeafPage(const KeyType& key, bool leftMost = false,
-            Operation op = Operation::READ, Transaction* transaction = nullptr);
+            Operation op = Operation::READ, Transaction* transaction = nullptr,
+            bool optimistic = true);
+
+        // One optimistic READ descent: inner nodes are read under version
+        // snapshots instead of latches. Returns the pinned leaf, R-latched if
+        // `latch_leaf`, otherwise with its version in `*leaf_version`. Sets
+        // `*restart` if a concurrent writer got in the way.
+        Page* FindLeafPageOptimistic(const KeyType& key, bool leftMost, bool latch_leaf,
+            uint64_t* leaf_version, bool* restart);
+
+        // GetValue with the leaf chain read under version snapshots too
+        bool GetValueOptimistic(const KeyType& key, std::vector<ValueType>* result, bool* restart);
+
+        // Optimistic attempts before falling back to latch crabbing
+        static constexpr int OPTIMISTIC_RETRIES = 4;
 
 
         // --- CONCURRENCY HELPERS ---
 
-        // Unlatch and Unpin all pages in the transaction's page_set_
-        void UnlockUnpinPages(Transaction* transaction);
+        // Unlatch and Unpin all pages in the transaction's page_set_,
+        // marking them dirty if `is_dirty`
+        void UnlockUnpinPages(Transaction* transaction, bool is_dirty = false);
 
         // Check if a node is "Safe" (won't split/merge)
         template <typename N>
@@ -81,11 +211,13 @@ namespace tetodb {
 
         // Members
         std::string index_name_;
-        page_id_t root_page_id_;
+        // Atomic so optimistic readers can find the root without root_latch_
+        std::atomic<page_id_t> root_page_id_;
         BufferPoolManager* buffer_pool_manager_;
         KeyComparator comparator_;
         uint32_t leaf_max_size_;
         uint32_t internal_max_size_;
+        LogManager* log_manager_;
 
 
         std::atomic<uint32_t> depth_ = 0;
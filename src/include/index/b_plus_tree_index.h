@@ -4,8 +4,10 @@
 
 #include "index/abstract_index_iterator.h"
 #include "index/b_plus_tree.h"
+#include "index/external_sorter.h"
 #include "index/generic_key.h"
 #include "index/index.h"
+#include <algorithm>
 #include <memory>
 
 
@@ -16,11 +18,14 @@ namespace tetodb {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndexIteratorWrapper : public AbstractIndexIterator {
 public:
-  // We take ownership of a live B+Tree Iterator and the search conditions
-  BPlusTreeIndexIteratorWrapper(INDEXITERATOR_TYPE iter, KeyType search_key,
+  // We take ownership of a live B+Tree Iterator and the search conditions:
+  // the scan ends after `upper_key` (compared by `comparator`, which may look
+  // at a key prefix only), or never if there is no upper bound
+  BPlusTreeIndexIteratorWrapper(INDEXITERATOR_TYPE iter, bool has_upper,
+                                KeyType upper_key, bool upper_inclusive,
                                 KeyComparator comparator)
-      : iter_(std::move(iter)), search_key_(search_key),
-        comparator_(comparator) {}
+      : iter_(std::move(iter)), has_upper_(has_upper), upper_key_(upper_key),
+        upper_inclusive_(upper_inclusive), comparator_(comparator) {}
 
   bool IsEnd() const override { return iter_.IsEnd(); }
 
@@ -28,17 +33,22 @@ public:
 
   RID GetCurrentRid() const override { return (*iter_).second; }
 
-  // Because the B+Tree is sorted ascending, if our current key is strictly >
-  // our target, we are out of bounds.
+  // Because the B+Tree is sorted ascending, if our current key is past the
+  // upper bound, we are out of bounds.
   bool IsPastSearchBound() const override {
     if (iter_.IsEnd())
       return true;
-    return comparator_((*iter_).first, search_key_) > 0;
+    if (!has_upper_)
+      return false;
+    int cmp = comparator_((*iter_).first, upper_key_);
+    return upper_inclusive_ ? cmp > 0 : cmp >= 0;
   }
 
 private:
   INDEXITERATOR_TYPE iter_;
-  KeyType search_key_;
+  bool has_upper_;
+  KeyType upper_key_;
+  bool upper_inclusive_;
   KeyComparator comparator_;
 };
 
@@ -48,48 +58,108 @@ public:
   BPlusTreeIndex(std::string name, BufferPoolManager *bpm,
                  const KeyComparator &comparator, uint32_t leaf_max,
                  uint32_t internal_max, std::unique_ptr<Schema> key_schema,
-                 page_id_t root_page_id = INVALID_PAGE_ID)
-      : name_(std::move(name)), key_schema_(std::move(key_schema)) {
+                 page_id_t root_page_id = INVALID_PAGE_ID,
+                 LogManager *log_manager = nullptr)
+      : name_(std::move(name)), key_schema_(std::move(key_schema)),
+        comparator_(comparator) {
     b_tree_ = std::make_unique<BPlusTree<KeyType, ValueType, KeyComparator>>(
-        name_, bpm, comparator, leaf_max, internal_max, root_page_id);
+        name_, bpm, comparator, leaf_max, internal_max, root_page_id,
+        log_manager);
   }
 
   void InsertEntry(const Tuple &key_tuple, RID rid, Transaction *txn) override {
-    KeyType index_key;
-    // Extract the Value from our isolated key tuple and use your existing
-    // method!
-    index_key.SetFromValue(key_tuple.GetValue(key_schema_.get(), 0));
+    KeyType index_key = MakeKey(key_tuple);
     b_tree_->Insert(index_key, rid, txn);
   }
 
   void DeleteEntry(const Tuple &key_tuple, RID rid, Transaction *txn) override {
-    KeyType index_key;
-    index_key.SetFromValue(key_tuple.GetValue(key_schema_.get(), 0));
+    KeyType index_key = MakeKey(key_tuple);
     b_tree_->Remove(index_key, rid, txn);
   }
 
   void ScanKey(const Tuple &key_tuple, std::vector<RID> *result,
                Transaction *txn) override {
-    KeyType index_key;
-    index_key.SetFromValue(key_tuple.GetValue(key_schema_.get(), 0));
+    KeyType index_key = MakeKey(key_tuple);
     b_tree_->GetValue(index_key, result, txn);
   }
 
   std::unique_ptr<AbstractIndexIterator>
-  GetBeginIterator(const Tuple &key_tuple) override {
-    KeyType index_key;
-    index_key.SetFromValue(key_tuple.GetValue(key_schema_.get(), 0));
-
-    // Create the raw B+Tree iterator
-    auto raw_iter = b_tree_->Begin(index_key);
+  GetRangeIterator(const IndexBound &lower, const IndexBound &upper) override {
+    uint32_t lower_columns =
+        std::min(lower.key_columns, comparator_.GetColumnCount());
+    uint32_t upper_columns =
+        std::min(upper.key_columns, comparator_.GetColumnCount());
+
+    // Create the raw B+Tree iterator, at the lowest key with the lower
+    // bound's prefix (the rest of the columns at their minimum)
+    KeyType lower_key;
+    if (lower_columns > 0) {
+      lower_key = MakePrefixKey(lower.key_tuple, lower_columns);
+    }
+    auto raw_iter =
+        lower_columns > 0 ? b_tree_->Begin(lower_key) : b_tree_->Begin();
+
+    // An exclusive bound also skips the keys with exactly that prefix
+    if (lower_columns > 0 && !lower.inclusive) {
+      KeyComparator lower_comparator = comparator_.Prefix(lower_columns);
+      while (!raw_iter.IsEnd() &&
+             lower_comparator((*raw_iter).first, lower_key) == 0) {
+        ++raw_iter;
+      }
+    }
+
+    KeyType upper_key;
+    if (upper_columns > 0) {
+      upper_key = MakePrefixKey(upper.key_tuple, upper_columns);
+    }
 
     // Package it into the type-erased wrapper and return
     return std::make_unique<
         BPlusTreeIndexIteratorWrapper<KeyType, ValueType, KeyComparator>>(
-        std::move(raw_iter), index_key,
-        KeyComparator(key_schema_->GetColumn(0).GetTypeId()));
+        std::move(raw_iter), upper_columns > 0, upper_key, upper.inclusive,
+        comparator_.Prefix(upper_columns));
+  }
+
+  void BulkLoad(const std::function<bool(Tuple *, RID *)> &next,
+                uint32_t fill_percent, size_t sort_memory,
+                Transaction *txn) override {
+    // Equal keys are kept in RID order, so the build is deterministic
+    struct SortEntry {
+      KeyType key;
+      ValueType value;
+    };
+    KeyComparator comparator = comparator_;
+    auto less = [comparator](const SortEntry &a, const SortEntry &b) {
+      int cmp = comparator(a.key, b.key);
+      if (cmp != 0)
+        return cmp < 0;
+      if (a.value.GetPageId() != b.value.GetPageId())
+        return a.value.GetPageId() < b.value.GetPageId();
+      return a.value.GetSlotId() < b.value.GetSlotId();
+    };
+
+    ExternalSorter<SortEntry, decltype(less)> sorter(sort_memory, less);
+    Tuple key_tuple;
+    RID rid;
+    while (next(&key_tuple, &rid)) {
+      sorter.Add({MakeKey(key_tuple), rid});
+    }
+    sorter.Finish();
+
+    b_tree_->BulkLoad(
+        [&sorter](KeyType *key, ValueType *value) {
+          SortEntry entry;
+          if (!sorter.Next(&entry))
+            return false;
+          *key = entry.key;
+          *value = entry.value;
+          return true;
+        },
+        fill_percent, txn);
   }
 
+  uint32_t Compact(Transaction *txn) override { return b_tree_->Compact(txn); }
+
   // Add to public section of BPlusTreeIndex:
   void Destroy() override { b_tree_->Destroy(); }
 
@@ -98,8 +168,40 @@ public:
   page_id_t GetRootPageId() const override { return b_tree_->GetRootPageId(); }
 
 private:
+  // Encodes every key column of `key_tuple` into its slot
+  KeyType MakeKey(const Tuple &key_tuple) const {
+    KeyType index_key;
+    for (uint32_t i = 0; i < comparator_.GetColumnCount(); i++) {
+      index_key.SetColumn(comparator_.GetColumn(i),
+                          key_tuple.GetValue(key_schema_.get(), i));
+    }
+    return index_key;
+  }
+
+  // Encodes the first `key_columns` key columns, held alone in
+  // `key_tuple`, and sets the rest to their minimum: the lowest key with
+  // that prefix
+  KeyType MakePrefixKey(const Tuple &key_tuple, uint32_t key_columns) const {
+    std::vector<Column> prefix_columns(key_schema_->GetColumns().begin(),
+                                       key_schema_->GetColumns().begin() +
+                                           key_columns);
+    Schema prefix_schema(prefix_columns);
+
+    KeyType index_key;
+    for (uint32_t i = 0; i < comparator_.GetColumnCount(); i++) {
+      if (i < key_columns) {
+        index_key.SetColumn(comparator_.GetColumn(i),
+                            key_tuple.GetValue(&prefix_schema, i));
+      } else {
+        index_key.SetColumnMin(comparator_.GetColumn(i));
+      }
+    }
+    return index_key;
+  }
+
   std::string name_;
   std::unique_ptr<Schema> key_schema_;
+  KeyComparator comparator_;
   std::unique_ptr<BPlusTree<KeyType, ValueType, KeyComparator>> b_tree_;
 };
 
@@ -0,0 +1,142 @@
+// external_sorter.h
+
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace tetodb {
+
+// Sorts a stream of fixed-size, trivially copyable items in bounded memory.
+// Items are buffered up to `memory_bytes`; a full buffer is sorted and
+// written out as a run to an anonymous temporary file, and the runs are
+// merged as they are read back. Input that fits is sorted in memory only.
+//
+// Add() every item, then Finish(), then Next() until it returns false.
+template <typename T, typename Less> class ExternalSorter {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "runs are written as raw bytes");
+
+public:
+  ExternalSorter(size_t memory_bytes, Less less)
+      : capacity_(std::max<size_t>(memory_bytes / sizeof(T), 1)),
+        less_(less) {}
+
+  ~ExternalSorter() {
+    for (Run &run : runs_)
+      std::fclose(run.file);
+  }
+
+  ExternalSorter(const ExternalSorter &) = delete;
+  ExternalSorter &operator=(const ExternalSorter &) = delete;
+
+  void Add(const T &item) {
+    buffer_.push_back(item);
+    if (buffer_.size() >= capacity_)
+      SpillRun();
+  }
+
+  void Finish() {
+    if (runs_.empty()) {
+      std::sort(buffer_.begin(), buffer_.end(), less_);
+      return;
+    }
+    SpillRun();
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+
+    // The memory is shared out between the runs' read buffers
+    size_t per_run =
+        std::max<size_t>(capacity_ / runs_.size(), RUN_READ_ITEMS);
+    for (size_t i = 0; i < runs_.size(); i++) {
+      Run &run = runs_[i];
+      std::rewind(run.file);
+      run.items.resize(per_run);
+      if (Refill(&run))
+        heap_.push(i);
+    }
+  }
+
+  bool Next(T *item) {
+    if (runs_.empty()) {
+      if (next_ == buffer_.size())
+        return false;
+      *item = buffer_[next_++];
+      return true;
+    }
+
+    if (heap_.empty())
+      return false;
+    size_t i = heap_.top();
+    heap_.pop();
+    Run &run = runs_[i];
+    *item = run.items[run.pos++];
+    if (run.pos < run.count || Refill(&run))
+      heap_.push(i);
+    return true;
+  }
+
+  // Runs written to disk (0 if the input was sorted in memory)
+  size_t GetRunCount() const { return runs_.size(); }
+
+private:
+  // Smallest read buffer a run gets during the merge
+  static constexpr size_t RUN_READ_ITEMS = 256;
+
+  struct Run {
+    std::FILE *file;
+    std::vector<T> items; // read buffer
+    size_t count = 0;     // items in the buffer
+    size_t pos = 0;       // next one to hand out
+  };
+
+  // Orders the heap of run indexes by each run's current item, smallest
+  // on top
+  struct RunGreater {
+    const ExternalSorter *sorter;
+    bool operator()(size_t a, size_t b) const {
+      const Run &ra = sorter->runs_[a];
+      const Run &rb = sorter->runs_[b];
+      return sorter->less_(rb.items[rb.pos], ra.items[ra.pos]);
+    }
+  };
+
+  void SpillRun() {
+    if (buffer_.empty())
+      return;
+    std::sort(buffer_.begin(), buffer_.end(), less_);
+
+    std::FILE *file = std::tmpfile();
+    if (file == nullptr)
+      throw std::runtime_error("External sort: cannot create a run file");
+    runs_.push_back(Run{file, {}, 0, 0});
+    if (std::fwrite(buffer_.data(), sizeof(T), buffer_.size(), file) !=
+        buffer_.size())
+      throw std::runtime_error("External sort: failed to write a run");
+    buffer_.clear();
+  }
+
+  bool Refill(Run *run) {
+    run->count =
+        std::fread(run->items.data(), sizeof(T), run->items.size(), run->file);
+    if (run->count == 0 && std::ferror(run->file))
+      throw std::runtime_error("External sort: failed to read a run");
+    run->pos = 0;
+    return run->count > 0;
+  }
+
+  size_t capacity_; // items held in memory before a run is written
+  Less less_;
+  std::vector<T> buffer_;
+  size_t next_ = 0; // Next(), when nothing was spilled
+
+  std::vector<Run> runs_;
+  std::priority_queue<size_t, std::vector<size_t>, RunGreater> heap_{
+      RunGreater{this}};
+};
+
+} // namespace tetodb
@@ -1,15 +1,32 @@
 #pragma once
 
+#include "type/key_encoding.h"
 #include "type/type_id.h"
 #include "type/value.h"
 #include <algorithm>
+#include <array>
 #include <cstring>
+#include <vector>
 
 namespace tetodb {
 
+/**
+ * Where one column of a key lives in the key bytes. A composite key holds
+ * its columns side by side, each in a slot as wide as the column.
+ */
+struct KeyColumn {
+  TypeId type_id_{TypeId::INVALID};
+  uint16_t offset_{0};
+  uint16_t length_{0};
+};
+
+// Columns a composite key can have
+static constexpr size_t MAX_KEY_COLUMNS = 8;
+
 /**
  * GenericKey is a fixed-size container for indexing.
- * It flattens a Value object into a raw byte array for the B+ Tree.
+ * It flattens one Value, or one per key column, into a raw byte array for
+ * the B+ Tree.
  */
 template <size_t KeySize> class GenericKey {
 public:
@@ -20,56 +37,25 @@ public:
 
   // -----------------------------------------------------------------------
   // CONVERT VALUE -> GENERIC KEY
-  // This extracts the raw bytes from your Value class based on its TypeId.
+  // The whole key is one column of the value's type.
   // -----------------------------------------------------------------------
   inline void SetFromValue(const Value &val) {
     memset(data_, 0, KeySize);
+    SetColumn({val.GetTypeId(), 0, static_cast<uint16_t>(KeySize)}, val);
+  }
 
-    switch (val.GetTypeId()) {
-    case TypeId::BOOLEAN: {
-      bool v = val.GetAsBoolean();
-      memcpy(data_, &v, 1);
-      break;
-    }
-    case TypeId::TINYINT: {
-      // Your Value class stores everything in the union.
-      // We cast down to ensure we only grab the relevant byte.
-      int8_t v = static_cast<int8_t>(val.GetAsInteger());
-      memcpy(data_, &v, 1);
-      break;
-    }
-    case TypeId::SMALLINT: {
-      int16_t v = static_cast<int16_t>(val.GetAsInteger());
-      memcpy(data_, &v, 2);
-      break;
-    }
-    case TypeId::INTEGER: {
-      int32_t v = val.GetAsInteger();
-      memcpy(data_, &v, 4);
-      break;
-    }
-    case TypeId::BIGINT: {
-      int64_t v = val.GetAsBigInt();
-      memcpy(data_, &v, 8);
-      break;
-    }
-    case TypeId::DECIMAL: {
-      double v = val.GetAsDecimal();
-      memcpy(data_, &v, 8);
-      break;
-    }
-    case TypeId::VARCHAR:
-    case TypeId::CHAR: {
-      // Truncate string if it's longer than the index key size
-      std::string s = val.GetAsString();
-      size_t len = std::min(s.length(), KeySize);
-      memcpy(data_, s.c_str(), len);
-      break;
-    }
-    default:
-      // TIMESTAMP or INVALID: Default to 0
-      break;
-    }
+  // Writes `val` into the slot of `column`, converted to the column's type
+  // and encoded so that keys order bytewise (see key_encoding.h)
+  inline void SetColumn(const KeyColumn &column, const Value &val) {
+    key_encoding::EncodeKeyValue(column.type_id_, val, data_ + column.offset_,
+                                 column.length_);
+  }
+
+  // Writes the smallest key of the column's type into its slot: a key with
+  // only its leading columns set this way sorts before every key that
+  // shares them. Every type's smallest encoding is all zeros.
+  inline void SetColumnMin(const KeyColumn &column) {
+    memset(data_ + column.offset_, 0, column.length_);
   }
 
   // Equality operator (Memcmp is fast)
@@ -79,72 +65,64 @@ public:
 };
 
 /**
- * GenericComparator uses the TypeId to decide HOW to compare the bytes.
- * This ensures INTEGER/BIGINT/DECIMAL are sorted numerically,
- * and CHAR/VARCHAR are sorted lexicographically.
+ * GenericComparator compares keys with a plain memcmp: each column is
+ * encoded in an order-preserving form, and the columns sit in key order,
+ * so the bytes order the same way as the column values (INTEGER/BIGINT/
+ * DECIMAL/TIMESTAMP numerically, CHAR/VARCHAR lexicographically). The
+ * column layout is kept for encoding keys and for the WAL.
  */
 template <size_t KeySize> class GenericComparator {
 public:
-  TypeId type_id_;
+  // The whole key is one column of `type`
+  explicit GenericComparator(TypeId type)
+      : column_count_(1), compare_length_(KeySize),
+        columns_{{KeyColumn{type, 0, static_cast<uint16_t>(KeySize)}}} {}
 
-  explicit GenericComparator(TypeId type) : type_id_(type) {}
+  explicit GenericComparator(const std::vector<KeyColumn> &columns)
+      : column_count_(static_cast<uint32_t>(
+            std::min(columns.size(), MAX_KEY_COLUMNS))) {
+    std::copy(columns.begin(), columns.begin() + column_count_,
+              columns_.begin());
+    compare_length_ = PrefixLength(column_count_);
+  }
+
+  // A comparator that looks at the first `count` columns only: keys that
+  // agree on them compare equal
+  inline GenericComparator Prefix(uint32_t count) const {
+    GenericComparator prefix(*this);
+    prefix.column_count_ = std::min(count, column_count_);
+    prefix.compare_length_ = prefix.PrefixLength(prefix.column_count_);
+    return prefix;
+  }
+
+  inline uint32_t GetColumnCount() const { return column_count_; }
+  inline const KeyColumn &GetColumn(uint32_t index) const {
+    return columns_[index];
+  }
+  inline std::vector<KeyColumn> GetColumns() const {
+    return std::vector<KeyColumn>(columns_.begin(),
+                                  columns_.begin() + column_count_);
+  }
 
   inline int operator()(const GenericKey<KeySize> &lhs,
                         const GenericKey<KeySize> &rhs) const {
-    switch (type_id_) {
-    case TypeId::BOOLEAN:
-    case TypeId::TINYINT: {
-      int8_t l, r;
-      std::memcpy(&l, lhs.data_, sizeof(int8_t));
-      std::memcpy(&r, rhs.data_, sizeof(int8_t));
-      if (l < r) return -1;
-      if (l > r) return 1;
-      return 0;
-    }
-    case TypeId::SMALLINT: {
-      int16_t l, r;
-      std::memcpy(&l, lhs.data_, sizeof(int16_t));
-      std::memcpy(&r, rhs.data_, sizeof(int16_t));
-      if (l < r) return -1;
-      if (l > r) return 1;
-      return 0;
-    }
-    case TypeId::INTEGER: {
-      int32_t l, r;
-      std::memcpy(&l, lhs.data_, sizeof(int32_t));
-      std::memcpy(&r, rhs.data_, sizeof(int32_t));
-      if (l < r) return -1;
-      if (l > r) return 1;
-      return 0;
-    }
-    case TypeId::BIGINT: {
-      int64_t l, r;
-      std::memcpy(&l, lhs.data_, sizeof(int64_t));
-      std::memcpy(&r, rhs.data_, sizeof(int64_t));
-      if (l < r)
-        return -1;
-      if (l > r)
-        return 1;
-      return 0;
-    }
-    case TypeId::DECIMAL: {
-      double l, r;
-      std::memcpy(&l, lhs.data_, sizeof(double));
-      std::memcpy(&r, rhs.data_, sizeof(double));
-      if (l < r)
-        return -1;
-      if (l > r)
-        return 1;
-      return 0;
-    }
-    case TypeId::VARCHAR:
-    case TypeId::CHAR:
-    default: {
-      // String comparison (lexicographical)
-      return memcmp(lhs.data_, rhs.data_, KeySize);
-    }
+    return memcmp(lhs.data_, rhs.data_, compare_length_);
+  }
+
+private:
+  // Bytes the first `count` columns span
+  inline size_t PrefixLength(uint32_t count) const {
+    size_t length = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      length = std::max(length, static_cast<size_t>(columns_[i].offset_ +
+                                                    columns_[i].length_));
     }
+    return std::min(length, KeySize);
   }
+
+  uint32_t column_count_;
+  size_t compare_length_;
+  std::array<KeyColumn, MAX_KEY_COLUMNS> columns_{};
 };
 
 } // namespace tetodb
\ No newline at end of file
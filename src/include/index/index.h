@@ -6,11 +6,20 @@
 #include "concurrency/transaction.h"
 #include "index/abstract_index_iterator.h"
 #include "storage/table/tuple.h"
+#include <functional>
 #include <memory>
 #include <string>
 
 namespace tetodb {
 
+// One end of an index range: a tuple of the first `key_columns` key
+// columns. With no key columns, the range is open at that end.
+struct IndexBound {
+  Tuple key_tuple;
+  uint32_t key_columns{0};
+  bool inclusive{true};
+};
+
 class Index {
 public:
   virtual ~Index() = default;
@@ -25,9 +34,32 @@ public:
   virtual void ScanKey(const Tuple &key_tuple, std::vector<RID> *result,
                        Transaction *txn) = 0;
 
-  // Expose the raw BPlusTree Iterator for Latch Crabbing during execution
+  // Expose the raw BPlusTree Iterator for Latch Crabbing during execution.
+  // The iterator visits the entries from `lower` on, in key order, and is
+  // past its search bound after `upper`. A bound on fewer key columns than
+  // the index has applies to that prefix of each key.
   virtual std::unique_ptr<AbstractIndexIterator>
-  GetBeginIterator(const Tuple &key_tuple) = 0;
+  GetRangeIterator(const IndexBound &lower, const IndexBound &upper) = 0;
+
+  // Every entry whose key starts with the first `key_columns` key columns,
+  // held by `key_tuple`
+  std::unique_ptr<AbstractIndexIterator>
+  GetBeginIterator(const Tuple &key_tuple, uint32_t key_columns) {
+    IndexBound bound{key_tuple, key_columns, true};
+    return GetRangeIterator(bound, bound);
+  }
+
+  // Fills an empty index with the entries `next` hands out, one (key
+  // tuple, RID) per call, until it returns false. They are sorted first,
+  // spilling sorted runs to temporary files past `sort_memory` bytes, and
+  // the index is then built bottom-up with its nodes `fill_percent` full.
+  virtual void BulkLoad(const std::function<bool(Tuple *, RID *)> &next,
+                        uint32_t fill_percent, size_t sort_memory,
+                        Transaction *txn) = 0;
+
+  // Online compaction (REINDEX): merges or refills underfull nodes while
+  // the index stays in use. Returns the number of pages freed.
+  virtual uint32_t Compact(Transaction *txn) = 0;
 
   virtual void Destroy() = 0;
 
@@ -37,7 +37,8 @@ public:
   // Move constructor — transfer ownership of the latched page
   IndexIterator(IndexIterator &&other) noexcept
       : buffer_pool_manager_(other.buffer_pool_manager_), page_(other.page_),
-        leaf_(other.leaf_), index_(other.index_) {
+        leaf_(other.leaf_), index_(other.index_),
+        read_ahead_(other.read_ahead_) {
     other.page_ = nullptr;
     other.leaf_ = nullptr;
     other.index_ = 0;
@@ -55,6 +56,7 @@ public:
       page_ = other.page_;
       leaf_ = other.leaf_;
       index_ = other.index_;
+      read_ahead_ = other.read_ahead_;
       other.page_ = nullptr;
       other.leaf_ = nullptr;
       other.index_ = 0;
@@ -106,28 +108,34 @@ public:
   }
 
 private:
+  // Moves to the first entry of the next non-empty leaf. The next leaf is
+  // latched before this one is let go: a merge needs both, so it cannot
+  // free the next leaf, or move entries past us, in between. A leaf left
+  // underfull (or the root) may still be empty.
   inline void Advance() {
-    page_id_t next_page_id = leaf_->GetNextPageId();
+    do {
+      page_id_t next_page_id = leaf_->GetNextPageId();
+      buffer_pool_manager_->ReadAhead(&read_ahead_, next_page_id);
 
-    page_->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+      Page *next_page = next_page_id == INVALID_PAGE_ID
+                            ? nullptr
+                            : buffer_pool_manager_->FetchPage(next_page_id);
+      if (next_page != nullptr)
+        next_page->RLatch();
 
-    if (next_page_id == INVALID_PAGE_ID) {
-      page_ = nullptr;
-      leaf_ = nullptr;
+      page_->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+
+      page_ = next_page;
       index_ = 0;
-    } else {
-      page_ = buffer_pool_manager_->FetchPage(next_page_id);
-      if (page_ != nullptr) {
-        page_->RLatch();
-        leaf_ = reinterpret_cast<
-            BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(
-            page_->GetData());
-        index_ = 0;
-      } else {
+      if (page_ == nullptr) {
         leaf_ = nullptr;
+        return;
       }
-    }
+      leaf_ = reinterpret_cast<
+          BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(
+          page_->GetData());
+    } while (leaf_->GetSize() == 0);
   }
 
 private:
@@ -135,6 +143,7 @@ private:
   Page *page_ = nullptr;
   BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf_ = nullptr;
   uint32_t index_ = 0;
+  ReadAheadState read_ahead_; // Sequential leaf-chain detection
 };
 
 } // namespace tetodb
\ No newline at end of file
@@ -24,6 +24,9 @@ enum class ASTNodeType {
   TRANSACTION_STATEMENT,
   EXPLAIN_STATEMENT,
   SAVEPOINT_STATEMENT,
+  SET_STATEMENT,
+  SHOW_STATEMENT,
+  REINDEX_STATEMENT,
   COLUMN_REF,
   CONSTANT,
   BINARY_EXPR,
@@ -475,6 +478,23 @@ struct DropIndexStatement : public ASTNode {
   }
 };
 
+// REINDEX INDEX name / REINDEX TABLE name: compacts the index, or every
+// index on the table, in place
+struct ReindexStatement : public ASTNode {
+  bool is_table_;
+  std::string name_;
+
+  ReindexStatement(bool is_table, std::string name)
+      : is_table_(is_table), name_(std::move(name)) {
+    type_ = ASTNodeType::REINDEX_STATEMENT;
+  }
+
+  std::string ToString(int indent = 0) const override {
+    return Indent(indent) + (is_table_ ? "Reindex Table: " : "Reindex Index: ") +
+           name_ + "\n";
+  }
+};
+
 struct CreateIndexStatement : public ASTNode {
   std::string index_name_;
   std::string table_name_;
@@ -643,4 +663,32 @@ struct SavepointStatement : public ASTNode {
   }
 };
 
+// E.g., SET buffer_pool_size = '256MB';
+struct SetStatement : public ASTNode {
+  std::string name_;  // lower-cased setting name
+  std::string value_; // raw value text (number + unit, string, or word)
+
+  SetStatement(std::string name, std::string value)
+      : name_(std::move(name)), value_(std::move(value)) {
+    type_ = ASTNodeType::SET_STATEMENT;
+  }
+
+  std::string ToString(int indent = 0) const override {
+    return Indent(indent) + "[[ SET " + name_ + " = " + value_ + " ]]\n";
+  }
+};
+
+// E.g., SHOW buffer_pool_stats;
+struct ShowStatement : public ASTNode {
+  std::string name_; // lower-cased setting or statistics name
+
+  explicit ShowStatement(std::string name) : name_(std::move(name)) {
+    type_ = ASTNodeType::SHOW_STATEMENT;
+  }
+
+  std::string ToString(int indent = 0) const override {
+    return Indent(indent) + "[[ SHOW " + name_ + " ]]\n";
+  }
+};
+
 } // namespace tetodb
\ No newline at end of file
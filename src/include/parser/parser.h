@@ -25,6 +25,9 @@ struct CreateViewStatement;
 struct DropTableStatement;
 struct DropIndexStatement;
 struct DropViewStatement;
+struct SetStatement;
+struct ShowStatement;
+struct ReindexStatement;
 
 class Parser {
 public:
@@ -60,6 +63,9 @@ private:
   std::unique_ptr<DropTableStatement> ParseDropTable(); // <-- ADDED
   std::unique_ptr<DropIndexStatement> ParseDropIndex();
   std::unique_ptr<DropViewStatement> ParseDropView();
+  std::unique_ptr<ReindexStatement> ParseReindex();
+  std::unique_ptr<SetStatement> ParseSet();
+  std::unique_ptr<ShowStatement> ParseShow();
 
   // --- Token Helpers ---
   const Token &Peek(int offset = 0) const;
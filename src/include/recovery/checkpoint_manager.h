@@ -8,15 +8,17 @@
 #include <chrono>
 
 #include "storage/buffer/buffer_pool_manager.h"
-#include "concurrency/transaction_manager.h"
 #include "recovery/log_manager.h"
 
 namespace tetodb {
 
+    // Fuzzy ARIES checkpoints: BEGIN_CHECKPOINT, then END_CHECKPOINT
+    // record(s) carrying the active transaction table and the buffer pool's
+    // dirty page table. Neither transactions nor the buffer pool are stopped.
     class CheckpointManager {
     public:
-        CheckpointManager(TransactionManager* txn_manager, LogManager* log_manager, BufferPoolManager* bpm)
-            : txn_manager_(txn_manager), log_manager_(log_manager), bpm_(bpm), enable_checkpointer_(false) {
+        CheckpointManager(LogManager* log_manager, BufferPoolManager* bpm)
+            : log_manager_(log_manager), bpm_(bpm), enable_checkpointer_(false) {
         }
 
         ~CheckpointManager() {
@@ -46,8 +48,10 @@ namespace tetodb {
 
         void PerformCheckpoint();
 
+        // ATT + DPT entries per END_CHECKPOINT record (8 bytes each)
+        static constexpr size_t CHECKPOINT_ENTRIES_PER_RECORD = 512;
+
     private:
-        TransactionManager* txn_manager_;
         LogManager* log_manager_;
         BufferPoolManager* bpm_;
 
@@ -0,0 +1,42 @@
+// log_compression.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tetodb {
+
+// With compression on, the log flush thread writes each flush buffer as one
+// block framed as
+//   magic (4) | raw size (4) | compressed size (4) | compressed bytes
+// The magic is larger than any record size, so a reader can tell a block
+// from a plain record at any record boundary; the two may be mixed.
+constexpr uint32_t LOG_BLOCK_MAGIC = 0xB10CC0DE;
+constexpr uint32_t LOG_BLOCK_HEADER_SIZE = 3 * sizeof(uint32_t);
+
+// Buffers smaller than this are written plain
+constexpr size_t LOG_BLOCK_MIN_SIZE = 256;
+
+// A small LZ77 codec in the spirit of LZ4: a sequence of (literal run,
+// back-reference) pairs found through a hash table of 4-byte prefixes.
+// Fast enough for the flush thread, and log records (repeated headers,
+// RIDs, neighbouring tuples) compress well with it.
+class LogCompression {
+public:
+  // Appends the compressed form of `src` to `dest`
+  static void Compress(const char *src, size_t size, std::vector<char> *dest);
+
+  // Decompresses exactly `raw_size` bytes, appending them to `dest`.
+  // Returns false on malformed input.
+  static bool Decompress(const char *src, size_t size, size_t raw_size,
+                         std::string *dest);
+
+  // Turns the contents of a log segment file (plain records and compressed
+  // blocks) into plain records. Stops at the first torn record or block.
+  static std::string ExpandSegment(const std::string &file_bytes);
+};
+
+} // namespace tetodb
@@ -2,49 +2,173 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
 
 namespace tetodb {
 
-constexpr uint32_t LOG_BUFFER_SIZE = 32 * 1024;
+// Default size of the in-memory log ring
+constexpr size_t LOG_BUFFER_SIZE = 1024 * 1024;
+constexpr size_t MIN_LOG_BUFFER_SIZE = 64 * 1024;
+// Positions in reserved_ are 32 bits wide, so the ring stays well below
+// 2^31 bytes
+constexpr size_t MAX_LOG_BUFFER_SIZE = 1024 * 1024 * 1024;
 
+// Without a flush request, the flush thread still writes the buffer this
+// often
+constexpr std::chrono::milliseconds LOG_FLUSH_INTERVAL{30};
+
+// Group commit: the flush thread may hold a requested write for a short
+// window while transactions are still running, so their COMMIT records
+// share it. The window adapts between 0 and the maximum: it doubles while
+// waiting gains commits and halves while it does not.
+constexpr std::chrono::microseconds GROUP_COMMIT_MIN_WINDOW{20};
+constexpr std::chrono::microseconds GROUP_COMMIT_MAX_WINDOW{2000};
+
+// A record's LSN is its byte position in the log: the WAL is one byte
+// stream, split into segment files named by the LSN they start at.
+//
+// Appending is lock-free. A record reserves its byte range (and so its LSN)
+// and a sequence number, together, from one atomic word, and is then
+// serialized into a ring buffer with no lock held. The flush thread writes
+// out the ring in order, waiting for any range that is reserved but not yet
+// filled. A record too big for the ring is kept in its own buffer until
+// written.
 class LogManager {
 public:
-  explicit LogManager(DiskManager *disk_manager);
+  // `buffer_size` bytes of ring (at least MIN_LOG_BUFFER_SIZE). With
+  // `compress`, each flush is written as one compressed block (see
+  // log_compression.h).
+  explicit LogManager(DiskManager *disk_manager,
+                      size_t buffer_size = LOG_BUFFER_SIZE,
+                      bool compress = false);
   ~LogManager();
 
   lsn_t AppendLogRecord(LogRecord *log_record);
+
+  // Returns once everything appended so far is on disk
   void Flush();
   void RunFlushThread();
   void StopFlushThread();
-  void SetNextLSN(lsn_t next_lsn) { next_lsn_ = next_lsn; }
+
+  // The log is `next_lsn` bytes long and all on disk (set by recovery,
+  // before anything is appended)
+  void SetNextLSN(lsn_t next_lsn);
+  // The LSN the next record will get: the end of the log so far
+  lsn_t GetNextLSN() const;
+  // Every record with an LSN up to this one is on disk
+  lsn_t GetPersistentLSN() const { return persistent_lsn_; }
+  size_t GetBufferSize() const { return capacity_; }
+
+  // Bytes of records flushed, and bytes they took on disk
+  uint64_t GetBytesLogged() const { return bytes_logged_; }
+  uint64_t GetBytesWritten() const { return bytes_written_; }
+
+  // Returns once every record up to `lsn` is on disk, without waiting for
+  // anything appended later. Commit waits for its COMMIT record this way;
+  // the buffer pool waits for a page's last change (WAL rule).
+  void WaitForLSN(lsn_t lsn);
+
+  std::chrono::microseconds GetGroupCommitWindow() const {
+    return std::chrono::microseconds(group_commit_window_us_.load());
+  }
+
+  // Appends BEGIN_CHECKPOINT and copies the active transaction table (every
+  // transaction with records but no COMMIT/ABORT yet, with its last LSN)
+  // into `att`. Every record before BEGIN_CHECKPOINT is reflected in it.
+  // `*oldest_lsn` is set to the first LSN of the oldest of them, or
+  // INVALID_LSN if there are none.
+  lsn_t AppendBeginCheckpoint(ActiveTxnTable *att, lsn_t *oldest_lsn);
+
+  // Points the master record at the durable checkpoint that began at
+  // `checkpoint_lsn`, then deletes the segments holding only records older
+  // than `start_lsn`
+  void TruncateLog(lsn_t checkpoint_lsn, lsn_t start_lsn);
 
 private:
+  // Where one reserved record stands. `seq` is stored last: once it
+  // matches, the record is filled and `end` / `spill` are valid.
+  struct LogSlot {
+    std::atomic<uint32_t> seq{UINT32_MAX};
+    uint64_t end = 0;      // log position just past the record
+    char *spill = nullptr; // the record itself if it bypassed the ring
+  };
+
+  // Active transactions, sharded by txn_id:
+  // txn_id -> (first LSN, last LSN)
+  struct TxnShard {
+    std::mutex latch;
+    std::unordered_map<txn_id_t, std::pair<lsn_t, lsn_t>> txns;
+  };
+  static constexpr size_t TXN_SHARDS = 16;
+
+  // Updates the active transaction table for a record just reserved
+  void TrackTransaction(const LogRecord &log_record);
+
+  // Writes every record reserved so far, in LSN order
+  void FlushReserved();
+
+  // Writes records starting at `first_lsn`, compressed if enabled
+  void WriteBlock(const char *data, size_t size, lsn_t first_lsn);
+
+  // Flush thread, before a requested write: holds it for the group-commit
+  // window, then adapts the window to whether holding gained commits
+  void GroupCommitWait(std::unique_lock<std::mutex> &lock);
+
   DiskManager *disk_manager_;
 
-  std::atomic<lsn_t> next_lsn_{0};
+  // Ring of capacity_ bytes: log position p lives at ring_[p % capacity_].
+  // Records bigger than max_ring_record_ are spilled instead.
+  size_t capacity_;
+  size_t max_ring_record_;
+  std::unique_ptr<char[]> ring_;
+  std::unique_ptr<char[]> staging_; // Flush thread: contiguous copy to write
+
+  bool compress_;
+  std::vector<char> compressed_; // Flush thread: block being built
+  std::atomic<uint64_t> bytes_logged_{0};
+  std::atomic<uint64_t> bytes_written_{0};
+
+  // One slot per record in flight (reserved, not yet written), indexed by
+  // sequence number; a power of two, so the index survives wrap-around
+  size_t slot_count_;
+  std::unique_ptr<LogSlot[]> slots_;
+
+  // Next sequence number (high 32 bits) and next log position (low 32
+  // bits, taken relative to flushed_pos_), advanced together by
+  // compare-and-swap
+  std::atomic<uint64_t> reserved_{0};
+  std::atomic<uint64_t> flushed_pos_{0};  // Set by the flush thread
+  std::atomic<uint32_t> flushed_seq_{0};  // Next sequence number to write
   std::atomic<lsn_t> persistent_lsn_{INVALID_LSN};
 
-  std::unique_ptr<char[]> log_buffer_;
-  std::unique_ptr<char[]> flush_buffer_;
-  uint32_t log_buffer_offset_{0};
-  uint32_t flush_buffer_offset_{0};
+  std::array<TxnShard, TXN_SHARDS> txn_shards_;
+  std::atomic<int64_t> active_txn_count_{0};
+  std::atomic<uint64_t> commits_appended_{0};
+  uint64_t commits_flushed_{0}; // Flush thread only
 
+  // latch_ is only for sleeping and waking: appenders that found the ring
+  // full, committers waiting for the disk, and the flush thread
   std::mutex latch_;
-  std::condition_variable cv_; // Wakes the background thread
-  std::condition_variable
-      append_cv_; // Blocks appending threads if active buffer is full
-  std::condition_variable
-      flush_cv_; // FIX: Blocks committing threads until disk I/O finishes
+  std::condition_variable cv_;        // Wakes the background thread
+  std::condition_variable append_cv_; // Ring space was freed
+  std::condition_variable flush_cv_;  // Records reached the disk
+  bool flush_requested_{false};       // someone is waiting on the log
+
+  std::atomic<int64_t> group_commit_window_us_{0}; // Set by the flush thread
 
   std::thread flush_thread_;
   std::atomic<bool> enable_logging_{false};
 };
 
-} // namespace tetodb
\ No newline at end of file
+} // namespace tetodb
@@ -4,8 +4,11 @@
 
 #include "common/config.h" // Assuming txn_id_t is here
 #include "common/record_id.h"
+#include "index/generic_key.h"
 #include "storage/table/tuple.h"
 #include <string>
+#include <utility>
+#include <vector>
 
 
 namespace tetodb {
@@ -24,7 +27,76 @@ enum class LogRecordType {
   COMMIT,
   ABORT,
   NEWPAGE,
-  CHECKPOINT // <-- NEW!
+  CHECKPOINT, // Legacy sharp checkpoint marker; ignored by recovery
+  BEGIN_CHECKPOINT,
+  END_CHECKPOINT, // Carries (part of) the ATT and DPT, see below
+  UPDATE_DELTA,   // In-place update logged as the byte ranges that changed
+  BTREE_WRITE,    // B+ tree page bytes overwritten (see BTreeChange)
+  BTREE_INSERT,   // B+ tree entry inserted at a slot
+  BTREE_DELETE    // B+ tree entry removed from a slot
+};
+
+// size (4) + lsn (8) + txn_id (4) + prev_lsn (8) + type (4) + is_clr (4) +
+// undo_next_lsn (8)
+static constexpr uint32_t LOG_RECORD_HEADER_SIZE = 40;
+
+using ActiveTxnTable = std::vector<std::pair<txn_id_t, lsn_t>>;   // txn -> lastLSN
+using DirtyPageTable = std::vector<std::pair<page_id_t, lsn_t>>;  // page -> recLSN
+
+/**
+ * The difference between two images of a tuple: each range replaces
+ * `old_bytes` at `offset` (in the old image) with `new_bytes`. Ranges are
+ * sorted and do not overlap; bytes outside them are the same in both images.
+ */
+struct TupleDelta {
+  struct Range {
+    uint32_t offset{0};
+    std::vector<char> old_bytes;
+    std::vector<char> new_bytes;
+  };
+
+  uint32_t old_size{0};
+  uint32_t new_size{0};
+  std::vector<Range> ranges;
+
+  // Same-size images give one range per run of changed bytes (runs closer
+  // than a range header are merged); otherwise one range spans everything
+  // between the common prefix and the common suffix
+  static TupleDelta Diff(const Tuple &old_tuple, const Tuple &new_tuple);
+
+  // Rebuilds the new image from the old one. Returns false if `old_tuple`
+  // is not the image this delta was taken from.
+  bool Apply(const Tuple &old_tuple, Tuple *new_tuple) const;
+
+  // The delta that takes the new image back to the old one
+  TupleDelta Inverse() const;
+
+  uint32_t SerializedSize() const;
+};
+
+/**
+ * A change to one B+ tree page. BTREE_WRITE overwrites the page with
+ * `bytes` from byte `offset` on. BTREE_INSERT / BTREE_DELETE insert /
+ * remove the entry `bytes` at slot `offset`, shifting the entries after it.
+ *
+ * Leaf entries also name their tree (its root page, which never moves, and
+ * key columns): undo takes them back out through the tree, since later splits
+ * may have moved them to another page. For every other change
+ * `root_page_id` is INVALID_PAGE_ID, and undo leaves it alone.
+ *
+ * A BTREE_WRITE that `formats` the page carries a node's whole image (a new,
+ * rebuilt or collapsed node). Redo applies it whatever the page holds: the
+ * page may have been a heap page, whose LSN sits at another offset.
+ */
+struct BTreeChange {
+  page_id_t page_id{INVALID_PAGE_ID};
+  uint32_t offset{0};
+  page_id_t root_page_id{INVALID_PAGE_ID};
+  std::vector<KeyColumn> key_columns;
+  std::vector<char> bytes;
+  bool formats{false};
+
+  uint32_t SerializedSize() const;
 };
 
 /**
@@ -61,6 +133,30 @@ public:
     target_rid_ = RID(page_id, 0); // Re-use RID to store the new page ID
   }
 
+  // --- Constructor 5: END_CHECKPOINT ---
+  // A large checkpoint is split over several END_CHECKPOINT records; each
+  // points back at its BEGIN_CHECKPOINT through prev_lsn, and only the last
+  // one has `is_last` set.
+  LogRecord(lsn_t begin_checkpoint_lsn, ActiveTxnTable active_txns,
+            DirtyPageTable dirty_pages, bool is_last)
+      : txn_id_(INVALID_TRANSACTION_ID), prev_lsn_(begin_checkpoint_lsn),
+        log_record_type_(LogRecordType::END_CHECKPOINT),
+        active_txns_(std::move(active_txns)),
+        dirty_pages_(std::move(dirty_pages)),
+        is_last_checkpoint_record_(is_last ? 1 : 0) {}
+
+  // --- Constructor 6: UPDATE_DELTA ---
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, const RID &rid, TupleDelta delta)
+      : txn_id_(txn_id), prev_lsn_(prev_lsn),
+        log_record_type_(LogRecordType::UPDATE_DELTA), target_rid_(rid),
+        delta_(std::move(delta)) {}
+
+  // --- Constructor 7: BTREE_WRITE / BTREE_INSERT / BTREE_DELETE ---
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
+            BTreeChange change)
+      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type),
+        btree_change_(std::move(change)) {}
+
   // --- Getters ---
   inline lsn_t GetLSN() const { return lsn_; }
   inline void SetLSN(lsn_t lsn) { lsn_ = lsn; }
@@ -77,6 +173,8 @@ public:
   inline RID GetTargetRID() const { return target_rid_; }
   inline Tuple GetOldTuple() const { return old_tuple_; }
   inline Tuple GetNewTuple() const { return new_tuple_; }
+  inline const TupleDelta &GetDelta() const { return delta_; }
+  inline const BTreeChange &GetBTreeChange() const { return btree_change_; }
 
   // We will need size to know how many bytes to write to the disk!
   inline uint32_t GetSize() const { return size_; }
@@ -84,6 +182,15 @@ public:
 
   inline page_id_t GetPrevPageId() const { return prev_page_id_; }
 
+  inline const ActiveTxnTable &GetActiveTxns() const { return active_txns_; }
+  inline const DirtyPageTable &GetDirtyPages() const { return dirty_pages_; }
+  inline bool IsLastCheckpointRecord() const {
+    return is_last_checkpoint_record_ != 0;
+  }
+
+  // Exact serialized size of this record, checkpoint tables included
+  uint32_t ComputeSize() const;
+
   /**
    * Flattens this LogRecord into a raw byte array.
    * @return The total number of bytes written.
@@ -122,6 +229,17 @@ private:
   Tuple new_tuple_; // The data AFTER the change (Used for REDO)
 
   page_id_t prev_page_id_{INVALID_PAGE_ID};
+
+  // UPDATE_DELTA only
+  TupleDelta delta_;
+
+  // BTREE_* only
+  BTreeChange btree_change_;
+
+  // END_CHECKPOINT only
+  ActiveTxnTable active_txns_;
+  DirtyPageTable dirty_pages_;
+  uint32_t is_last_checkpoint_record_{0};
 };
 
 } // namespace tetodb
\ No newline at end of file
@@ -4,8 +4,9 @@
 
 #include <filesystem>
 #include <fstream>
-#include <string>
+#include <sstream>
 #include <unordered_map>
+#include <vector>
 
 #include "recovery/log_manager.h"
 #include "recovery/log_record.h"
@@ -18,53 +19,90 @@ namespace tetodb {
 
 class RecoveryManager {
 public:
+  // `redo_threads` workers replay the log; 1 replays it on the calling
+  // thread
   RecoveryManager(DiskManager *disk_manager, BufferPoolManager *bpm,
-                  LogManager *log_mgr, const std::string &db_file_name)
-      : disk_manager_(disk_manager), bpm_(bpm), log_mgr_(log_mgr) {
-
-    // Reconstruct the log file name from the DB name
-    std::filesystem::path path(db_file_name);
-    path.replace_extension(".log");
-    log_file_name_ = path.string();
-  }
+                  LogManager *log_mgr, size_t redo_threads = 1)
+      : disk_manager_(disk_manager), bpm_(bpm), log_mgr_(log_mgr),
+        redo_threads_(redo_threads) {}
 
   ~RecoveryManager() = default;
 
   /**
-   * Phase 1 & 2: Analyzes the log and replays it from start to finish.
-   * Restores the exact physical state of the database at the moment of the
-   * crash.
+   * Phase 1 & 2: Analyzes the WAL from the checkpoint the master record
+   * points at (or from its first segment) and replays it from the oldest
+   * recLSN in the dirty page table. Restores the exact physical state of
+   * the database at the moment of the crash. Analysis runs on the calling
+   * thread; replay is spread over the redo threads by page, which keeps
+   * each page's records in log order.
    */
   void Redo();
 
   /**
    * Phase 3: Reverts the changes made by transactions that never committed.
-   * Uses the Active Transaction Table built during Redo.
+   * Uses the Active Transaction Table built during Redo, and follows each
+   * loser's prevLSN chain by seeking straight to every record: an LSN is
+   * the record's byte position in the log.
    */
   void Undo();
 
 private:
+  // One segment of the log: it holds the LSNs [begin, end). Positions
+  // count plain record bytes, as if no block of the segment were
+  // compressed.
+  struct SegmentRange {
+    std::filesystem::path path;
+    lsn_t begin; // LSN of the segment's first record
+    lsn_t end;   // next segment's begin; INT64_MAX for the last
+  };
+
+  // Reads the record at the file's current position. False at the end of
+  // the segment, or at a torn/corrupt record left by a crash.
+  bool ReadLogRecord(std::istream &log_file, LogRecord *log_record,
+                     uint32_t *record_size);
+
+  // A segment's records, with compressed blocks expanded
+  static std::istringstream OpenSegment(const std::filesystem::path &path);
+
+  // Reads the record with LSN `lsn`
+  bool ReadLogRecordAt(lsn_t lsn, LogRecord *log_record);
+
+  // Calls `visit` on every record at or after `lsn`, in log order. Each
+  // segment ends at its first torn record: a restart always begins a new
+  // segment. Returns the LSN just past the last record read, where the log
+  // continues.
+  template <typename F> lsn_t ScanLog(lsn_t lsn, F &&visit);
+
+  // Pages a redoable record touches (NEWPAGE touches two)
+  static std::vector<page_id_t> PagesTouched(const LogRecord &log_record);
+
+  // Whether `page_id` may be missing the record's change
+  bool NeedsRedo(const LogRecord &log_record, page_id_t page_id) const;
+
+  // Re-applies one record to one of the pages it touches
+  void RedoRecord(const LogRecord &log_record, page_id_t page_id);
+
+  // Replays every record from `lsn` on, on redo_threads_ workers
+  void RedoFrom(lsn_t lsn);
+
   DiskManager *disk_manager_;
   BufferPoolManager *bpm_;
   LogManager *log_mgr_;
-  std::string log_file_name_;
+  size_t redo_threads_;
+
+  std::vector<SegmentRange> segments_;
+  std::istringstream read_file_; // ReadLogRecordAt's open segment
+  size_t read_segment_ = 0; // its index + 1, 0 if none
 
   // --- ACTIVE TRANSACTION TABLE (ATT) ---
   // Tracks transactions that were running when the crash happened.
   // Maps txn_id -> the LSN of their most recent log record.
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
 
-  // --- LSN TO OFFSET MAPPING ---
-  // Maps an LSN to its physical byte offset in the log file.
-  // This allows us to instantly jump backwards through the file during the Undo
-  // phase.
-  std::unordered_map<lsn_t, uint32_t> lsn_mapping_;
-
-  // Tracks whether any recovery work was performed (log records replayed)
-  bool did_work_ = false;
-
-public:
-  bool DidWork() const { return did_work_; }
+  // --- DIRTY PAGE TABLE (DPT) ---
+  // page_id -> recLSN: records older than that are already in the page on
+  // disk. Seeded from the last checkpoint, extended by the analysis pass.
+  std::unordered_map<page_id_t, lsn_t> dirty_pages_;
 };
 
 } // namespace tetodb
\ No newline at end of file
@@ -12,17 +12,21 @@
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/buffer/buffer_pool_manager.h"
-#include "storage/buffer/two_queue_replacer.h"
+#include "storage/buffer/page_cleaner.h"
 #include "storage/disk/disk_manager.h"
 
 namespace tetodb {
 
+struct SetStatement;
+struct ShowStatement;
+
 // Represents a single client's connection state
 struct ClientSession {
   Transaction *active_txn = nullptr;
   bool is_poisoned = false;
   std::unordered_map<std::string, std::string> prepared_statements;
   std::vector<Value> current_parameters;
+  bool synchronous_commit = true; // SET synchronous_commit
 };
 
 struct QueryResult {
@@ -34,25 +38,61 @@ struct QueryResult {
   bool is_error = false;
 };
 
+// Most redo workers recovery starts, however many are asked for
+constexpr size_t MAX_RECOVERY_THREADS = 16;
+
+// Startup knobs, set from the teto_main command line
+struct InstanceOptions {
+  size_t buffer_pool_frames = 4096; // 16 MB of PAGE_SIZE frames
+  size_t buffer_pool_partitions = 0; // 0 = pick from core count and pool size
+  IoEngine io_engine = IoEngine::SYNC;
+  bool direct_io = false;
+  ReplacerPolicy replacer = ReplacerPolicy::TWO_QUEUE;
+  size_t log_buffer_size = LOG_BUFFER_SIZE; // bytes of WAL ring
+  bool wal_compression = false;
+  size_t recovery_threads = 0; // redo workers; 0 = one per core, at most
+                               // MAX_RECOVERY_THREADS either way
+};
+
 class TetoDBInstance {
 public:
   // Boots the database, runs ARIES recovery, and starts background threads
-  TetoDBInstance(const std::string &db_file_name);
+  TetoDBInstance(const std::string &db_file_name,
+                 InstanceOptions options = InstanceOptions());
 
   // Flushes buffers, stops threads, and cleanly shuts down
   ~TetoDBInstance();
 
   QueryResult ExecuteQuery(const std::string &sql, ClientSession &session);
 
+  // Parses a buffer pool size given as bytes with an optional K/KB/M/MB/G/GB
+  // suffix ("256MB"), or as a percentage of physical RAM ("25%"). Returns the
+  // size in frames; throws std::invalid_argument on malformed input.
+  static size_t ParseBufferPoolSize(const std::string &spec);
+
+  // Parses a WAL buffer size given as bytes with an optional K/KB/M/MB/G/GB
+  // suffix ("4MB"). Returns the size in bytes; throws std::invalid_argument
+  // on malformed input or a size outside [MIN_LOG_BUFFER_SIZE,
+  // MAX_LOG_BUFFER_SIZE].
+  static size_t ParseWalBufferSize(const std::string &spec);
+
 private:
+  // Applies a SET <name> = <value> statement
+  void ApplySetting(const SetStatement &stmt, ClientSession &session,
+                    QueryResult &res);
+
+  // Answers SHOW <name> with a result set
+  void ShowSetting(const ShowStatement &stmt, const ClientSession &session,
+                   QueryResult &res);
+
   std::unique_ptr<DiskManager> disk_manager_;
-  std::unique_ptr<TwoQueueReplacer> replacer_;
   std::unique_ptr<BufferPoolManager> bpm_;
   std::unique_ptr<LogManager> log_mgr_;
   std::unique_ptr<LockManager> lock_mgr_;
   std::unique_ptr<TransactionManager> txn_mgr_;
   std::unique_ptr<Catalog> catalog_;
   std::unique_ptr<CheckpointManager> checkpoint_mgr_;
+  std::unique_ptr<PageCleaner> page_cleaner_;
 
   std::shared_mutex ddl_latch_; // Protects against concurrent DDL/DML conflicts
 };
@@ -0,0 +1,57 @@
+// buffer_access_strategy.h
+
+// Role: Scan resistance. Gives a bulk operation (large sequential scan, index
+//       build, bulk load) a small private ring of frames that it recycles,
+//       instead of cycling its pages through the shared pool.
+// Exposes: Pass a strategy to `BufferPoolManager::FetchPage/NewPage`.
+// Consumes: BufferPoolManager.
+
+#pragma once
+
+#include <vector>
+
+#include "storage/buffer/buffer_pool_manager.h"
+
+namespace tetodb {
+
+    enum class AccessStrategyType {
+        BULK_READ,  // sequential scans, index builds
+        BULK_WRITE  // bulk inserts
+    };
+
+    // Owned by the operation for its whole run, and used by one thread.
+    //
+    // The ring only kicks in once the operation has touched more than a
+    // quarter of the pool, so small tables stay cached as usual. From then
+    // on its misses reuse the ring's frames (writing them back first if
+    // dirty), and its hits do not make pages look hot to the replacer. A
+    // ring page that another session hits joins the shared pool.
+    class BufferAccessStrategy {
+        friend class BufferPoolManager;
+
+    public:
+        BufferAccessStrategy(BufferPoolManager* bpm, AccessStrategyType type);
+        ~BufferAccessStrategy(); // Ring pages stay cached, as normal pool pages
+
+        BufferAccessStrategy(const BufferAccessStrategy&) = delete;
+        BufferAccessStrategy& operator=(const BufferAccessStrategy&) = delete;
+
+        inline AccessStrategyType GetType() const { return type_; }
+
+        static constexpr size_t BULK_READ_RING_PAGES = 64;   // 256 KB
+        static constexpr size_t BULK_WRITE_RING_PAGES = 512; // 2 MB
+
+    private:
+        // Null until the operation counts as large
+        BufferRing* RingFor(page_id_t page_id, size_t partition);
+
+        BufferPoolManager* bpm_;
+        AccessStrategyType type_;
+        std::vector<BufferRing> rings_; // one per pool partition
+
+        size_t activate_after_;         // distinct pages before the ring is used
+        size_t pages_seen_ = 0;
+        page_id_t last_page_id_ = INVALID_PAGE_ID;
+    };
+
+} // namespace tetodb
@@ -0,0 +1,193 @@
+// buffer_pool_instance.h
+
+// Role: One partition of the cache. Owns its frames, page table, free list and
+//       replacer behind its own latch.
+// Exposes: `FetchPage(page_id)`, `NewPage(page_id)`, `UnpinPage(page_id, is_dirty)`, `FlushPage(page_id)`.
+// Consumes: DiskManager, a Replacer (2Q or CLOCK). Page ids are allocated by the
+//           BufferPoolManager that routes to this instance.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <list>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "storage/page/page.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/buffer/replacer.h"
+
+
+namespace tetodb {
+
+    class LogManager;
+
+    struct AlignedDeleter {
+        void operator()(char* ptr) const {
+        #ifdef _WIN32
+            _aligned_free(ptr);
+        #else
+            free(ptr); // on Linux, posix_memalign pointers can be freed with free()
+        #endif
+        }
+    };
+
+
+    struct BufferPoolStats {
+        uint64_t fetch_hits = 0;           // FetchPage calls served from the pool
+        uint64_t fetch_misses = 0;         // FetchPage calls that read the page
+        uint64_t pages_cleaned = 0;        // written ahead of eviction by the page cleaner
+        uint64_t sync_eviction_writes = 0; // evictions that had to write their victim first
+        uint64_t pages_prefetched = 0;     // loaded by PrefetchPages (including read-ahead)
+    };
+
+
+    // A bulk operation's private frames in one partition (see
+    // BufferAccessStrategy). Once `capacity` frames are taken, each miss
+    // recycles the next frame in turn instead of evicting from the pool.
+    struct BufferRing {
+        size_t capacity = 0;
+        std::vector<frame_id_t> frames;
+        size_t next = 0;
+    };
+
+
+    class BufferPoolInstance {
+    
+
+    public:
+        // A null `replacer` makes the instance create and own one of the
+        // given `policy`.
+        BufferPoolInstance(size_t pool_size, DiskManager* disk_manager, Replacer* replacer,
+                           ReplacerPolicy policy = ReplacerPolicy::TWO_QUEUE);
+        ~BufferPoolInstance();
+
+        // With a `ring`, a miss is served from the ring's frames and hits do
+        // not count as accesses for the replacer.
+        Page* FetchPage(page_id_t page_id, BufferRing* ring = nullptr);
+        Page* NewPage(page_id_t page_id, BufferRing* ring = nullptr); // page_id is already allocated
+        bool UnpinPage(page_id_t page_id, bool is_dirty);
+        bool FlushPage(page_id_t page_id);
+        // False if pinned: the page is then dropped, and its id deallocated,
+        // on the last unpin. Otherwise the caller deallocates the id.
+        bool DeletePage(page_id_t page_id);
+        void FlushAllPages();
+
+        // Loads every listed page that is not already cached with one batched
+        // read, leaving them unpinned and first in line for eviction. Ids that
+        // were never allocated are skipped. Stops early if the pool is full
+        // of pinned pages.
+        void PrefetchPages(const std::vector<page_id_t>& page_ids);
+
+        // Grows or shrinks the pool to `new_pool_size` frames without a
+        // restart. Growing adds fresh frames to the free list. Shrinking
+        // writes back and drops frames from the tail; it stops early at a
+        // pinned frame. Returns the pool size actually reached.
+        size_t Resize(size_t new_pool_size);
+        size_t GetPoolSize();
+
+        // Writes up to `max_pages` dirty, unpinned frames in page_id order,
+        // leaving them cached and clean. Frames dirty for at least `max_age`
+        // qualify; once more than `dirty_ratio` of the pool is dirty, every
+        // dirty frame does. Returns the number of pages written.
+        size_t CleanDirtyPages(double dirty_ratio, std::chrono::milliseconds max_age,
+                               size_t max_pages);
+        BufferPoolStats GetStats() const;
+
+        // Hands the ring's frames back to the shared pool, cached and
+        // evictable. The ring can be reused afterwards.
+        void ReleaseRing(BufferRing* ring);
+
+        // With a log manager set, frames track recLSNs and every write first
+        // makes the log durable up to the page's last change (WAL rule).
+        void SetLogManager(LogManager* log_manager);
+
+        // (page_id, recLSN) for every page whose cached copy may be newer
+        // than disk: dirty, being written, or pinned (and so possibly being
+        // changed right now). Appended to `out`.
+        void GetDirtyPageTable(std::vector<std::pair<page_id_t, lsn_t>>* out);
+        
+
+
+    private:
+        // May drop and re-take `lock` to write back a dirty victim; callers
+        // must re-check the page table afterwards.
+        bool GetFreeFrame(std::unique_lock<std::mutex>& lock, frame_id_t* frame_id);
+        void AddFrames(size_t count); // Caller holds latch_ (or is the ctor)
+
+        // Writes the given frames with `lock` released. Dirty bits are
+        // cleared up front and restored for pages whose write failed.
+        bool WriteBack(std::unique_lock<std::mutex>& lock,
+                       const std::vector<frame_id_t>& frames,
+                       std::vector<bool>* written);
+
+        // Sleeps (latch released) until no read, write or eviction is in
+        // flight on page
+        void WaitForIo(std::unique_lock<std::mutex>& lock, Page* page);
+
+        // Like GetFreeFrame, but recycles the ring's next frame when it can.
+        // The frame returned is owned by the ring and not in the replacer.
+        bool GetRingFrame(std::unique_lock<std::mutex>& lock, BufferRing* ring, frame_id_t* frame_id);
+        bool RecycleRingFrame(std::unique_lock<std::mutex>& lock, BufferRing* ring, frame_id_t frame_id);
+        void DisownRingFrame(frame_id_t frame_id); // back to the shared pool
+
+        // Pins `page` once more, noting where the log was on a first pin
+        void Pin(Page* page);
+
+        // Takes an unpinned, idle frame's page out of the pool and puts the
+        // frame on the free list
+        void DropFrame(frame_id_t frame_id);
+        lsn_t NextLSN() const;
+
+        // When a dirty victim has to be written, up to this many of the next
+        // dirty victims are written in the same batch (io_uring engine only)
+        static constexpr size_t WRITEBACK_BATCH = 16;
+
+    private:
+        // Protects everything below, including each frame's pin count, dirty
+        // bit and I/O flags. It is never held across disk I/O: a frame being
+        // read is marked is_loading_ (and pinned), a frame being written is
+        // marked in_writeback_, and whoever needs that frame waits on io_cv_.
+        std::mutex latch_;
+        std::condition_variable io_cv_;
+
+        std::atomic<uint64_t> fetch_hits_{0};
+        std::atomic<uint64_t> fetch_misses_{0};
+        std::atomic<uint64_t> pages_cleaned_{0};
+        std::atomic<uint64_t> sync_eviction_writes_{0};
+        std::atomic<uint64_t> pages_prefetched_{0};
+
+        // Frame memory comes in one aligned chunk per grow. pages_ is a deque
+        // so that growing/shrinking at the end never moves a live Page.
+        using ChunkPtr = std::unique_ptr<char[], AlignedDeleter>;
+        struct FrameChunk {
+            size_t first_frame;
+            size_t num_frames;
+            ChunkPtr data;
+        };
+        std::vector<FrameChunk> data_chunks_;
+        std::deque<Page> pages_;
+
+        std::unordered_map<page_id_t, frame_id_t> page_table_;
+        std::list<frame_id_t> free_list_;
+
+        DiskManager* disk_manager_;
+        std::atomic<LogManager*> log_manager_{nullptr};
+        Replacer* replacer_;
+        std::unique_ptr<Replacer> owned_replacer_;
+
+        size_t pool_size_;
+
+    };
+
+
+
+} // namespace tetodb
\ No newline at end of file
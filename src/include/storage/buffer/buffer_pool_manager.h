@@ -2,72 +2,140 @@
 
 // Role: The Cache. Moves pages from Disk <-> Memory.
 // Exposes: `FetchPage(page_id)`, `NewPage(page_id*)`, `UnpinPage(page_id, is_dirty)`, `FlushPage(page_id)`.
-// Consumes: DiskManager, LRUKReplacer.
+// Consumes: DiskManager, BufferPoolInstance (one per partition).
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
-#include <unordered_map>
-#include <list>
 
-#ifdef _WIN32
-#include <malloc.h>
-#endif
-
-#include "storage/page/page.h"
-#include "storage/disk/disk_manager.h"
-#include "storage/buffer/two_queue_replacer.h"
+#include "storage/buffer/buffer_pool_instance.h"
 
 
 namespace tetodb {
 
-    struct AlignedDeleter {
-        void operator()(char* ptr) const {
-        #ifdef _WIN32
-            _aligned_free(ptr);
-        #else
-            free(ptr); // on Linux, posix_memalign pointers can be freed with free()
-        #endif
-        }
-    };
+    class BufferAccessStrategy;
 
+    // Per-scan read-ahead bookkeeping. Owned by the iterator walking a page
+    // chain and handed to BufferPoolManager::ReadAhead on every hop.
+    struct ReadAheadState {
+        page_id_t last_page_id = INVALID_PAGE_ID;
+        int64_t stride = 0;                          // id delta of the last hop
+        uint32_t run = 0;                            // consecutive hops with that stride
+        uint32_t window = 0;                         // pages requested per batch (K)
+        page_id_t prefetched_until = INVALID_PAGE_ID; // furthest page already requested
+    };
 
+    // The pool is split into independent partitions (BufferPoolInstance),
+    // each with its own latch, page table, free list and replacer. A page
+    // always lives in partition `page_id % num_partitions`, so sessions that
+    // touch different pages rarely meet on the same latch.
     class BufferPoolManager {
-    
+
 
     public:
-        BufferPoolManager(size_t pool_size, DiskManager* disk_manager, TwoQueueReplacer* replacer);
+        // Single partition driven by a caller-provided replacer.
+        BufferPoolManager(size_t pool_size, DiskManager* disk_manager, Replacer* replacer);
+
+        // `num_partitions` partitions splitting `pool_size` frames between
+        // them; each partition owns a replacer of the given `policy`.
+        BufferPoolManager(size_t pool_size, DiskManager* disk_manager, size_t num_partitions,
+                          ReplacerPolicy policy = ReplacerPolicy::TWO_QUEUE);
+
         ~BufferPoolManager();
 
-        Page* FetchPage(page_id_t page_id);
-        Page* NewPage(page_id_t* page_id);
+        // A `strategy` keeps a bulk operation inside its own small ring of
+        // frames (see BufferAccessStrategy).
+        Page* FetchPage(page_id_t page_id, BufferAccessStrategy* strategy = nullptr);
+        Page* NewPage(page_id_t* page_id, BufferAccessStrategy* strategy = nullptr);
         bool UnpinPage(page_id_t page_id, bool is_dirty);
         bool FlushPage(page_id_t page_id);
+        // False if the page is still pinned; it is then freed, id and all,
+        // when the last pin is released
         bool DeletePage(page_id_t page_id);
         void FlushAllPages();
-        
+
+        // Loads every listed page that is not already cached with one batched
+        // read, leaving them unpinned and first in line for eviction. Ids that
+        // were never allocated are skipped. Stops early if the pool is full
+        // of pinned pages.
+        void PrefetchPages(const std::vector<page_id_t>& page_ids);
+
+        // Prefetch hint for scans that follow a next-page chain (heap pages,
+        // B+ tree leaves). Call it with each page the scan moves to. Once the
+        // hops show a steady stride, the next K pages along that stride are
+        // queued for a background PrefetchPages. K starts small, doubles each
+        // time the scan catches up with the prefetched pages, and never
+        // exceeds 1/8 of the pool, so a scan cannot push out the hot set.
+        // Never blocks on I/O.
+        void ReadAhead(ReadAheadState* state, page_id_t page_id);
+
+        // Grows or shrinks the pool to `new_pool_size` frames without a
+        // restart. Growing adds fresh frames to the free list. Shrinking
+        // writes back and drops frames from the tail; it stops early at a
+        // pinned frame. Returns the pool size actually reached.
+        size_t Resize(size_t new_pool_size);
+        size_t GetPoolSize();
+
+        // Background writeback, see BufferPoolInstance::CleanDirtyPages.
+        // `max_pages` is shared out between the partitions.
+        size_t CleanDirtyPages(double dirty_ratio, std::chrono::milliseconds max_age,
+                               size_t max_pages);
+        BufferPoolStats GetStats() const; // summed over all partitions
+
+        // Turns on recLSN tracking and the WAL rule in every partition
+        void SetLogManager(LogManager* log_manager);
+
+        // Dirty page table for a fuzzy checkpoint, see
+        // BufferPoolInstance::GetDirtyPageTable. Takes each partition latch
+        // briefly, one at a time.
+        std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable();
+
+        inline size_t GetNumPartitions() const { return partitions_.size(); }
+
+        // Called by ~BufferAccessStrategy
+        void ReleaseStrategy(BufferAccessStrategy* strategy);
 
 
-    private:
-        bool GetFreeFrame(frame_id_t* frame_id);
 
     private:
-        std::mutex latch_;
+        inline size_t PartitionIndex(page_id_t page_id) const {
+            return static_cast<size_t>(page_id) % partitions_.size();
+        }
+        inline BufferPoolInstance* PartitionFor(page_id_t page_id) {
+            return partitions_[PartitionIndex(page_id)].get();
+        }
 
-        std::unique_ptr<char[], AlignedDeleter> data_pool_;
-        std::vector<Page> pages_;
+        // Frames partition `index` gets when `pool_size` is split evenly
+        inline size_t PartitionShare(size_t pool_size, size_t index) const {
+            size_t n = partitions_.size();
+            return pool_size / n + (index < pool_size % n ? 1 : 0);
+        }
 
-        std::unordered_map<page_id_t, frame_id_t> page_table_;
-        std::list<frame_id_t> free_list_;
+        void ReadAheadLoop();
 
+        static constexpr uint32_t READ_AHEAD_TRIGGER = 2;      // hops before prefetching
+        static constexpr uint32_t READ_AHEAD_MIN_PAGES = 4;
+        static constexpr uint32_t READ_AHEAD_MAX_PAGES = 64;
+        static constexpr size_t READ_AHEAD_MAX_QUEUED = 16;    // requests; extra hints are dropped
+
+    private:
+        std::vector<std::unique_ptr<BufferPoolInstance>> partitions_;
         DiskManager* disk_manager_;
-        TwoQueueReplacer* replacer_;
 
-        size_t pool_size_;
+        // Read-ahead worker, started on the first hint
+        std::mutex read_ahead_latch_;
+        std::condition_variable read_ahead_cv_;
+        std::deque<std::vector<page_id_t>> read_ahead_queue_;
+        std::thread read_ahead_thread_;
+        bool read_ahead_stop_ = false;
 
     };
 
 
 
-} // namespace tetodb
\ No newline at end of file
+} // namespace tetodb
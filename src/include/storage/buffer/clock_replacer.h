@@ -0,0 +1,54 @@
+// clock_replacer.h
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "common/config.h"
+#include "storage/buffer/replacer.h"
+
+namespace tetodb {
+
+    // Generalized CLOCK over flat per-frame arrays. Each tracked frame has a
+    // small usage count: a new frame starts cold at 0 and every further
+    // access bumps it (up to MAX_USAGE). The sweeping hand decrements counts
+    // and evicts the first evictable frame it finds at 0, so pages touched
+    // once go before pages that keep getting hit, as with 2Q.
+    //
+    // RecordAccess, SetEvictable and Remove only touch atomics; the latch
+    // serializes the hand (Evict, EvictionCandidates) and Resize. Resize
+    // reallocates the arrays, so it must not race with the other calls.
+    class ClockReplacer : public Replacer {
+    public:
+        explicit ClockReplacer(size_t num_frames);
+        ~ClockReplacer() override = default;
+
+        bool Evict(frame_id_t* frame_id) override;
+        void RecordAccess(frame_id_t frame_id) override;
+        void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+        void Remove(frame_id_t frame_id) override;
+        size_t Size() override;
+        void Resize(size_t num_frames) override;
+        std::vector<frame_id_t> EvictionCandidates(size_t max_count) override;
+
+        static constexpr uint8_t MAX_USAGE = 3;
+
+    private:
+        enum FrameState : uint8_t { ABSENT = 0, PINNED = 1, EVICTABLE = 2 };
+
+        bool InRange(frame_id_t frame_id) const {
+            return frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_;
+        }
+
+        size_t num_frames_;
+        std::unique_ptr<std::atomic<uint8_t>[]> state_;
+        std::unique_ptr<std::atomic<uint8_t>[]> usage_;
+        std::atomic<size_t> curr_size_{ 0 };
+
+        std::mutex latch_;
+        size_t hand_{ 0 };
+    };
+
+} // namespace tetodb
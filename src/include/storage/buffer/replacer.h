@@ -0,0 +1,48 @@
+// replacer.h
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "common/config.h"
+
+namespace tetodb {
+
+    enum class ReplacerPolicy { TWO_QUEUE, CLOCK };
+
+    // Frame replacement policy used by a BufferPoolInstance. Frame ids are
+    // dense (0..num_frames-1). The buffer pool calls every method with its
+    // own latch held, but implementations must still be safe on their own.
+    class Replacer {
+    public:
+        virtual ~Replacer() = default;
+
+        // Picks an evictable frame and stops tracking it
+        virtual bool Evict(frame_id_t* frame_id) = 0;
+
+        // Notes a use of the frame; starts tracking it (not evictable) if new
+        virtual void RecordAccess(frame_id_t frame_id) = 0;
+
+        // No-op for frames that are not tracked
+        virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
+
+        // Stops tracking an evictable frame; no-op if pinned or absent
+        virtual void Remove(frame_id_t frame_id) = 0;
+
+        // Number of evictable frames
+        virtual size_t Size() = 0;
+
+        // Adjusts capacity after a buffer pool resize. Frames that went away
+        // must already have been Remove()d.
+        virtual void Resize(size_t num_frames) = 0;
+
+        // Up to `max_count` evictable frames, in the order Evict() would
+        // pick them. Nothing is removed; the BPM uses this to clean the next
+        // few victims in the same batch as the current one.
+        virtual std::vector<frame_id_t> EvictionCandidates(size_t max_count) = 0;
+    };
+
+    std::unique_ptr<Replacer> MakeReplacer(ReplacerPolicy policy, size_t num_frames);
+
+} // namespace tetodb
@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include <vector>
 #include "common/config.h"
+#include "storage/buffer/replacer.h"
 
 namespace tetodb {
 
@@ -19,16 +20,18 @@ namespace tetodb {
         std::list<frame_id_t>::iterator iter_;
     };
 
-    class TwoQueueReplacer {
+    class TwoQueueReplacer : public Replacer {
     public:
         explicit TwoQueueReplacer(size_t num_frames);
-        ~TwoQueueReplacer() = default;
-
-        bool Evict(frame_id_t* frame_id);
-        void RecordAccess(frame_id_t frame_id);
-        void SetEvictable(frame_id_t frame_id, bool set_evictable);
-        void Remove(frame_id_t frame_id);
-        size_t Size();
+        ~TwoQueueReplacer() override = default;
+
+        bool Evict(frame_id_t* frame_id) override;
+        void RecordAccess(frame_id_t frame_id) override;
+        void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+        void Remove(frame_id_t frame_id) override;
+        size_t Size() override;
+        void Resize(size_t num_frames) override;
+        std::vector<frame_id_t> EvictionCandidates(size_t max_count) override;
 
     private:
         size_t replacer_size_;
@@ -3,24 +3,95 @@
 #pragma once
 
 #include "common/config.h"
+#include "storage/disk/io_uring_engine.h"
 #include <atomic>
 #include <filesystem>
 #include <fstream>
+#include <memory>
 #include <mutex>
 #include <stack>
 #include <string>
+#include <vector>
 
 
 namespace tetodb {
+
+// Which backend serves the batched ReadPages / WritePages calls.
+enum class IoEngine { SYNC, IO_URING };
+
+struct DiskOptions {
+  IoEngine io_engine = IoEngine::SYNC;
+  // Open the .db file with O_DIRECT so pages are cached once (in the buffer
+  // pool) instead of twice. Falls back to buffered I/O where refused.
+  bool direct_io = false;
+  // A new WAL segment is started once the current one reaches this size
+  size_t log_segment_size = 16 * 1024 * 1024;
+};
+
+// One WAL segment file. Segments live in <db>.wal/ and are named after the
+// first LSN they hold; a record never spans two segments.
+struct LogSegment {
+  lsn_t first_lsn;
+  std::filesystem::path path;
+};
+
+// Where recovery starts, kept in <db>.wal/master. Rewritten after every
+// durable checkpoint.
+struct LogMaster {
+  lsn_t checkpoint_lsn = INVALID_LSN; // BEGIN_CHECKPOINT of that checkpoint
+  lsn_t start_lsn = INVALID_LSN;      // oldest record recovery may need
+};
+
+// One page in a batched read or write. `ok` is set per page on return.
+struct PageIO {
+  page_id_t page_id;
+  char *data;
+  bool ok = false;
+};
+
 class DiskManager {
 public:
-  explicit DiskManager(std::filesystem::path db_file);
+  explicit DiskManager(std::filesystem::path db_file,
+                       DiskOptions options = DiskOptions());
   ~DiskManager();
   bool WritePage(page_id_t page_id, const char *page_data);
   void ReadPage(page_id_t page_id, char *page_data);
 
-  // NEW: Write a raw byte buffer to the sequential log file
-  void WriteLog(const char *log_data, int size);
+  // Batched page I/O. With the io_uring engine the whole batch is queued and
+  // submitted together; otherwise (or for any page the ring could not serve)
+  // it falls back to one synchronous call per page.
+  void ReadPages(std::vector<PageIO> &batch);
+  bool WritePages(std::vector<PageIO> &batch); // true if every page was written
+
+  // The engine actually in use (IO_URING falls back to SYNC if setup failed
+  // or the ring later broke)
+  inline IoEngine GetIoEngine() const {
+    return uring_ != nullptr && uring_->IsAvailable() ? IoEngine::IO_URING
+                                                      : IoEngine::SYNC;
+  }
+
+  // Whether .db I/O is actually bypassing the OS page cache
+  inline bool IsDirectIo() const { return direct_io_.load(); }
+
+  // Number of pages ever handed out; ids at or above this were never written
+  inline page_id_t GetNumPages() const { return next_page_id_.load(); }
+
+  // Appends whole log records, the first of which has LSN `first_lsn`.
+  // The first write after opening, and the first once the current segment
+  // is full, starts a new segment.
+  void WriteLog(const char *log_data, int size, lsn_t first_lsn);
+
+  // Existing WAL segments, oldest first
+  std::vector<LogSegment> GetLogSegments();
+
+  // Deletes the segments that hold only records older than `lsn`. The
+  // newest segment is always kept. Returns the number deleted.
+  size_t RemoveLogSegmentsBefore(lsn_t lsn);
+
+  // The master record is replaced atomically (write, then rename). Reading
+  // returns false if there is none yet.
+  void WriteLogMaster(const LogMaster &master);
+  bool ReadLogMaster(LogMaster *master);
 
   page_id_t AllocatePage();
   void DeallocatePage(page_id_t page_id);
@@ -30,12 +101,32 @@ public:
   }
 
 private:
+  // Drops O_DIRECT on the open descriptor after an EINVAL from the kernel.
+  // Returns true if the caller should retry the I/O: also when another
+  // session already dropped it, since the EINVAL may predate that. A caller
+  // retries once at most.
+  bool DisableDirectIo();
+
   std::filesystem::path file_name_;
+
+#ifdef _WIN32
   std::fstream db_io_;
+#else
+  // POSIX backend: positional pread/pwrite on a raw descriptor. There is
+  // no shared file offset, so concurrent page I/O needs no latch at all.
+  int db_fd_{-1};
+#endif
+  std::atomic<bool> direct_io_{false};
 
-  // NEW: Dedicated path and stream for the log file
-  std::filesystem::path log_name_;
-  std::fstream log_io_;
+  // Only set when DiskOptions asked for io_uring and the ring came up
+  std::unique_ptr<IoUringEngine> uring_;
+
+  // WAL directory and the segment being appended to (not open until the
+  // first WriteLog)
+  std::filesystem::path log_dir_;
+  std::ofstream log_io_;
+  size_t log_segment_size_;
+  size_t log_segment_bytes_{0};
 
   std::stack<page_id_t> free_list_;
 
@@ -43,24 +134,32 @@ private:
   // LOCK ORDERING CONTRACT
   // ================================================================
   // External callers (BPM) hold their own latch BEFORE calling into
-  // DiskManager. To prevent deadlocks, DiskManager uses three
-  // INDEPENDENT mutexes that never depend on each other:
+  // DiskManager. To prevent deadlocks, DiskManager uses INDEPENDENT
+  // mutexes that never depend on each other:
   //
-  //   io_latch_    — protects db_io_   (ReadPage / WritePage)
-  //   log_latch_   — protects log_io_  (WriteLog)
+  //   io_latch_    — protects db_io_   (ReadPage / WritePage, Windows only)
+  //   log_latch_   — protects log_io_ and the WAL directory
   //   alloc_latch_ — protects free_list_ (AllocatePage / DeallocatePage)
+  //   direct_io_latch_ — serializes the O_DIRECT fallback (DisableDirectIo)
+  //
+  // On POSIX, ReadPage / WritePage take no lock: pread/pwrite carry their
+  // own offset, so misses from different sessions overlap in the kernel.
   //
   // None of these locks are ever nested. The allowed acquisition
   // order from any external caller is:
   //   BPM::latch_ → alloc_latch_   (NewPage, DeletePage)
   //   BPM::latch_ → io_latch_      (eviction writeback, FetchPage read)
+  //   BPM::latch_ → direct_io_latch_ (the same, on an O_DIRECT EINVAL)
   //   (independent) → log_latch_   (WAL writes from LogManager)
   // ================================================================
+#ifdef _WIN32
   std::mutex io_latch_;
+#endif
   std::mutex log_latch_;
   std::mutex alloc_latch_;
+  std::mutex direct_io_latch_;
 
   std::atomic<page_id_t> next_page_id_;
 };
 
-} // namespace tetodb
\ No newline at end of file
+} // namespace tetodb
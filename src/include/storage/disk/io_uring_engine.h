@@ -0,0 +1,74 @@
+// io_uring_engine.h
+
+// Role: Batched asynchronous page I/O for the DiskManager.
+// Exposes: `IsAvailable()`, `SubmitAndWait(fd, ops)`.
+// Consumes: The raw io_uring syscalls (Linux only; no liburing dependency).
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace tetodb {
+
+// One read or write in a batch. `result` is filled in on completion with the
+// number of bytes transferred, or -errno if the kernel rejected the request.
+struct AsyncIoOp {
+  bool is_write;
+  char *buf;
+  uint32_t len;
+  uint64_t offset;
+  int32_t result;
+};
+
+class IoUringEngine {
+public:
+  // Sets up a ring with room for `queue_depth` in-flight requests. If the
+  // kernel (or a seccomp profile) refuses, the engine stays unavailable and
+  // the DiskManager keeps using synchronous I/O.
+  explicit IoUringEngine(uint32_t queue_depth);
+  ~IoUringEngine();
+
+  IoUringEngine(const IoUringEngine &) = delete;
+  IoUringEngine &operator=(const IoUringEngine &) = delete;
+
+  // False once setup failed, or after an unrecoverable ring error
+  inline bool IsAvailable() const { return ring_fd_.load() >= 0; }
+
+  // Queues every op against `fd`, submits them with as few syscalls as the
+  // ring depth allows, and blocks until all of them have completed. Ops that
+  // could not be submitted come back with a negative `result`.
+  void SubmitAndWait(int fd, std::vector<AsyncIoOp> &ops);
+
+private:
+  void Teardown();
+
+  std::atomic<int> ring_fd_{-1}; // Read without latch_ by IsAvailable()
+  uint32_t sq_entries_{0};
+
+  // mmap'd ring regions (kept as raw pointers so this header does not pull
+  // in <linux/io_uring.h>)
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+
+  uint32_t *sq_tail_{nullptr};
+  uint32_t *sq_mask_{nullptr};
+  uint32_t *sq_array_{nullptr};
+  uint32_t *cq_head_{nullptr};
+  uint32_t *cq_tail_{nullptr};
+  uint32_t *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+
+  // A single ring has one submission queue; batches from different sessions
+  // take turns on it.
+  std::mutex latch_;
+};
+
+} // namespace tetodb
@@ -9,7 +9,7 @@ namespace tetodb {
 
 	// Internal Page maps Keys to PageIDs (Traffic Directors)
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
+#define INTERNAL_PAGE_HEADER_SIZE 32
 #define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(MappingType))
 
 	INDEX_TEMPLATE_ARGUMENTS
@@ -31,6 +31,11 @@ namespace tetodb {
 
 		inline ValueType ValueAt(uint32_t index) const { return array_[index].second; }
 
+		inline const MappingType& ItemAt(uint32_t index) const { return array_[index]; }
+
+		// Index of the child `value`, or GetSize() if it is not one
+		uint32_t ValueIndex(const ValueType& value) const;
+
 		// --- SEARCH LOGIC ---
 		// Returns the PageID of the child that handles the given key.
 		ValueType Lookup(const KeyType& key, const KeyComparator& comparator) const;
@@ -39,14 +44,22 @@ namespace tetodb {
 		void PopulateNewRoot(const ValueType& old_value, const KeyType& new_key, const ValueType& new_value);
 
 		// --- SPLIT & MERGE UTILS ---
-		// Move half of keys to recipient (during Split)
+		// Move half of keys to recipient (during Split). The caller re-parents
+		// the moved children.
 		void MoveHalfTo(BPlusTreeInternalPage* recipient, BufferPoolManager* buffer_pool_manager);
 
-		// Move all keys to recipient (during Merge)
+		// Move all keys to recipient (during Merge). `middle_key` is the
+		// parent's key for this page; it becomes the key of our first child.
+		// The caller re-parents the moved children.
 		void MoveAllTo(BPlusTreeInternalPage* recipient, const KeyType& middle_key, BufferPoolManager* buffer_pool_manager);
 
 
 		void InsertNodeAfter(const ValueType& old_value, const KeyType& new_key, const ValueType& new_value);
+
+		// Puts `item` at `index` / takes entry `index` out, shifting the
+		// entries after it (during Redistribute and Merge)
+		void InsertAt(uint32_t index, const MappingType& item);
+		void RemoveAt(uint32_t index);
 	private:
 		// Flexible Array Member
 		// MappingType is pair<KeyType, page_id_t>
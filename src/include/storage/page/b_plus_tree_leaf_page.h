@@ -9,7 +9,7 @@
 namespace tetodb {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
+#define LEAF_PAGE_HEADER_SIZE 36
 #define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
 
     INDEX_TEMPLATE_ARGUMENTS
@@ -38,6 +38,13 @@ namespace tetodb {
             // --- UPDATED: Now requires ValueType (RID) to safely delete duplicates ---
             uint32_t Remove(const KeyType& key, const ValueType& value, const KeyComparator& comparator);
 
+            // Index of the entry (key, value), or GetSize() if there is none
+            uint32_t EntryIndex(const KeyType& key, const ValueType& value, const KeyComparator& comparator) const;
+            void RemoveAt(uint32_t index);
+
+            // Puts `item` at `index`, shifting the entries from there on
+            void InsertAt(uint32_t index, const MappingType& item);
+
             void MoveHalfTo(BPlusTreeLeafPage* recipient, BufferPoolManager* buffer_pool_manager);
             void MoveAllTo(BPlusTreeLeafPage* recipient);
 
@@ -23,15 +23,17 @@ namespace tetodb {
     /**
      * Both Internal and Leaf pages inherit from this.
      *
-     * Header Format (size in byte, 24 bytes total):
+     * Header Format (size in byte, 32 bytes total):
      * ----------------------------------------------------------------------------
-     * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) | PageId (4) |
+     * | PageType (4) | (padding) (4) | LSN (8) | CurrentSize (4) | MaxSize (4) |
+     * | ParentPageId (4) | PageId (4) |
      * ----------------------------------------------------------------------------
      */
     class BPlusTreePage {
     public:
         // --- Metadata Getters/Setters (Implicitly Inline) ---
 
+        inline IndexPageType GetPageType() const { return page_type_; }
         inline bool IsLeafPage() const { return page_type_ == IndexPageType::LEAF_PAGE; }
         inline bool IsRootPage() const { return parent_page_id_ == INVALID_PAGE_ID; }
         inline void SetPageType(IndexPageType page_type) { page_type_ = page_type; }
@@ -56,8 +58,12 @@ namespace tetodb {
         inline page_id_t GetPageId() const { return page_id_; }
         inline void SetPageId(page_id_t page_id) { page_id_ = page_id; }
 
+        inline lsn_t GetLSN() const { return lsn_; }
         inline void SetLSN(lsn_t lsn = INVALID_LSN) { lsn_ = lsn; }
 
+        // Byte offset of the parent page id, for logging a change of parent
+        static constexpr uint32_t OFFSET_PARENT_PAGE_ID = 24;
+
     private:
         // Member variables
         IndexPageType page_type_ [[maybe_unused]];
@@ -68,4 +74,7 @@ namespace tetodb {
         page_id_t page_id_ [[maybe_unused]];
     };
 
+    // INTERNAL_PAGE_HEADER_SIZE / LEAF_PAGE_HEADER_SIZE are derived from this
+    static_assert(sizeof(BPlusTreePage) == 32, "B+ tree page header layout changed");
+
 }  // namespace tetodb
\ No newline at end of file
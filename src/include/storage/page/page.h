@@ -1,7 +1,7 @@
 // page.h
 
 // Role: A wrapper that points a 4KB block in buffer.
-// Exposes: GetData(), GetPageId(), RLatch(), WLatch().
+// Exposes: GetData(), GetPageId(), RLatch(), WLatch(), GetVersion().
 
 #pragma once
 
@@ -9,14 +9,18 @@
 #include "common/rwlatch.h"
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstring>
 #include <iostream>
 
 
 namespace tetodb {
 
+struct BufferRing;
+
 class Page {
-  friend class BufferPoolManager;
+  friend class BufferPoolInstance;
 
 public:
   Page() = default;
@@ -54,19 +58,75 @@ public:
       memset(data_, 0, PAGE_SIZE);
   }
 
-  inline void WLatch() { rwlatch_.WLock(); }
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  // Writers make the version odd for as long as they hold the latch
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.store(version_.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  inline void WUnlatch() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
+  // WLatch() if no one holds the latch; false, without waiting, otherwise
+  inline bool TryWLatch() {
+    if (!rwlatch_.TryWLock())
+      return false;
+    version_.store(version_.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+  }
   inline void RLatch() { rwlatch_.RLock(); }
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  // Optimistic reads: snapshot the version, read the page without latching,
+  // then CheckVersion(). An odd snapshot means a writer is active; anything
+  // read under a snapshot that no longer checks out must be thrown away.
+  inline uint64_t GetVersion() const {
+    return version_.load(std::memory_order_acquire);
+  }
+  inline bool CheckVersion(uint64_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (version & 1) == 0 &&
+           version_.load(std::memory_order_relaxed) == version;
+  }
+
 protected:
   // meta data
   page_id_t page_id_{INVALID_PAGE_ID};
   int32_t pin_count_{0};
   bool is_dirty_{0};
+  // When the page last went from clean to dirty (drives the page cleaner)
+  std::chrono::steady_clock::time_point dirty_since_{};
+
+  // Log positions for fuzzy checkpoints and the WAL rule. rec_lsn_ is no
+  // later than the first change not yet on disk; pin_lsn_ is the next LSN
+  // when the page was last pinned from 0; last_lsn_ covers every change
+  // made so far. INVALID_LSN when unknown or clean.
+  lsn_t rec_lsn_{INVALID_LSN};
+  lsn_t pin_lsn_{INVALID_LSN};
+  lsn_t last_lsn_{INVALID_LSN};
+
+  // In-flight I/O, set by the buffer pool while its latch is released
+  bool is_loading_{false};   // contents are being read from disk
+  bool in_writeback_{false}; // contents are being written to disk
+  bool is_evicting_{false};  // claimed by an eviction that may be sleeping
+
+  // Deleted while pinned: the page is dropped and its id deallocated on
+  // the last unpin
+  bool is_deleted_{false};
+
+  // Set while the frame belongs to a bulk operation's private ring; such
+  // frames are kept out of the replacer
+  BufferRing *ring_{nullptr};
 
   // RWLatch
   ReaderWriterLatch rwlatch_;
+  // Bumped by WLatch()/WUnlatch(); odd while a writer holds the latch
+  std::atomic<uint64_t> version_{0};
 
   // actual data address
   char *data_{
@@ -11,12 +11,12 @@
 namespace tetodb {
 
 static constexpr size_t OFFSET_PAGE_ID = 0;
-static constexpr size_t OFFSET_LSN = 4;
-static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
-static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
-static constexpr size_t OFFSET_FREE_SPACE = 16;
-static constexpr size_t OFFSET_SLOT_COUNT = 20;
-static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+static constexpr size_t OFFSET_LSN = 4; // 8 bytes
+static constexpr size_t OFFSET_PREV_PAGE_ID = 12;
+static constexpr size_t OFFSET_NEXT_PAGE_ID = 16;
+static constexpr size_t OFFSET_FREE_SPACE = 20;
+static constexpr size_t OFFSET_SLOT_COUNT = 24;
+static constexpr size_t SIZE_TABLE_PAGE_HEADER = 28;
 static constexpr size_t SIZE_SLOT = 8;
 
 // Bitmask to flag a tuple as logically deleted without destroying its size
@@ -106,9 +106,11 @@ public:
 
   inline BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
-  inline TableIterator Begin(Transaction *txn = nullptr) {
+  // Pass a BULK_READ strategy for scans that may cover a large table
+  inline TableIterator Begin(Transaction *txn = nullptr,
+                             BufferAccessStrategy *strategy = nullptr) {
     RID first_rid(first_page_id_, 0);
-    return TableIterator(this, first_rid);
+    return TableIterator(this, first_rid, strategy);
   }
 
   inline TableIterator End() {
@@ -119,9 +121,11 @@ public:
   inline page_id_t GetFirstPageId() { return first_page_id_; }
 
   bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn = nullptr,
-                   LockManager *lock_mgr = nullptr);
+                   LockManager *lock_mgr = nullptr,
+                   BufferAccessStrategy *strategy = nullptr);
 
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn = nullptr);
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn = nullptr,
+                BufferAccessStrategy *strategy = nullptr);
 
   bool MarkDelete(const RID &rid, Transaction *txn = nullptr);
 
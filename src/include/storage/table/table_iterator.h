@@ -2,6 +2,7 @@
 #pragma once
 
 #include "common/record_id.h"
+#include "storage/buffer/buffer_pool_manager.h"
 
 namespace tetodb {
 
@@ -10,7 +11,8 @@ namespace tetodb {
     class TableIterator {
     public:
         // Constructor: Points to a specific position (RID)
-        TableIterator(TableHeap* table_heap, RID rid);
+        TableIterator(TableHeap* table_heap, RID rid,
+                      BufferAccessStrategy* strategy = nullptr);
 
         // We remove operator* and operator-> because we no longer cache the tuple.
         // Instead, we just expose the current RID.
@@ -38,6 +40,8 @@ namespace tetodb {
     private:
         TableHeap* table_heap_;
         RID rid_;
+        ReadAheadState read_ahead_; // Sequential page-chain detection
+        BufferAccessStrategy* strategy_; // Not owned; may be null
 
         // REMOVED: Tuple tuple_;
     };
@@ -0,0 +1,139 @@
+// key_encoding.h
+
+#pragma once
+
+#include "type/type_id.h"
+#include "type/value.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace tetodb {
+
+/**
+ * Order-preserving ("normalized") key encodings: two encoded values compare
+ * with a plain memcmp the way the values themselves compare.
+ *
+ * - Integers and TIMESTAMP: big-endian, with the sign bit flipped
+ * - DECIMAL: the IEEE-754 bits, all flipped if negative and only the sign
+ *   bit flipped otherwise (-0.0 is encoded as 0.0)
+ * - BOOLEAN: one byte, 0 or 1
+ * - CHAR / VARCHAR: the bytes, with 0x00 escaped as 0x01 0x01 and 0x01 as
+ *   0x01 0x02, then a 0x00 terminator. Every byte of the string is then
+ *   above the terminator, so a string sorts before any longer string that
+ *   starts with it. In a fixed-size key the zero padding is the terminator.
+ *
+ * The smallest encoding of every type is all zero bytes.
+ */
+namespace key_encoding {
+
+// Bytes a fixed-size type encodes to; 0 for strings
+inline uint32_t FixedWidth(TypeId type) {
+  switch (type) {
+  case TypeId::BOOLEAN:
+  case TypeId::TINYINT:
+    return 1;
+  case TypeId::SMALLINT:
+    return 2;
+  case TypeId::INTEGER:
+    return 4;
+  case TypeId::BIGINT:
+  case TypeId::TIMESTAMP:
+  case TypeId::DECIMAL:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
+// The low `width` bytes of `bits`, most significant first
+inline void PutBigEndian(uint64_t bits, uint32_t width, char *dst) {
+  for (uint32_t i = 0; i < width; i++) {
+    dst[i] = static_cast<char>(bits >> (8 * (width - 1 - i)));
+  }
+}
+
+inline uint64_t OrderedInteger(int64_t v, uint32_t width) {
+  return static_cast<uint64_t>(v) ^ (uint64_t{1} << (8 * width - 1));
+}
+
+inline uint64_t OrderedDouble(double d) {
+  if (d == 0.0)
+    d = 0.0;
+  uint64_t bits;
+  std::memcpy(&bits, &d, sizeof(bits));
+  const uint64_t sign = uint64_t{1} << 63;
+  return (bits & sign) ? ~bits : (bits | sign);
+}
+
+// Writes `val` as a value of `type` into `FixedWidth(type)` bytes at `dst`
+inline void EncodeFixed(TypeId type, const Value &val, char *dst) {
+  uint32_t width = FixedWidth(type);
+  switch (type) {
+  case TypeId::BOOLEAN:
+    dst[0] = val.GetAsBoolean() ? 1 : 0;
+    break;
+  case TypeId::TINYINT:
+  case TypeId::SMALLINT:
+  case TypeId::INTEGER:
+  case TypeId::BIGINT:
+  case TypeId::TIMESTAMP:
+    PutBigEndian(OrderedInteger(val.CastAsBigInt(), width), width, dst);
+    break;
+  case TypeId::DECIMAL:
+    PutBigEndian(OrderedDouble(val.CastAsDouble()), width, dst);
+    break;
+  default:
+    break;
+  }
+}
+
+// Calls `put(byte)` for each byte of the escaped string (no terminator)
+template <typename Put> inline void EscapeString(const std::string &s, Put put) {
+  for (char c : s) {
+    if (c == '\0' || c == '\x01') {
+      put('\x01');
+      put(static_cast<char>(c + 1));
+    } else {
+      put(c);
+    }
+  }
+}
+
+// Writes `val` as a value of `type` into the `width` bytes at `dst`, zero
+// padded. A string too long for them is cut short.
+inline void EncodeKeyValue(TypeId type, const Value &val, char *dst,
+                           uint32_t width) {
+  std::memset(dst, 0, width);
+  uint32_t fixed = FixedWidth(type);
+  if (fixed != 0) {
+    if (fixed <= width)
+      EncodeFixed(type, val, dst);
+    return;
+  }
+  if (type != TypeId::VARCHAR && type != TypeId::CHAR)
+    return;
+
+  uint32_t used = 0;
+  EscapeString(val.GetAsString(), [&](char c) {
+    if (used < width)
+      dst[used++] = c;
+  });
+}
+
+// Appends `val`, as a value of `type`, to a variable-length key. Strings
+// carry their terminator, so keys of several values can be concatenated.
+inline void AppendKeyValue(TypeId type, const Value &val, std::string *out) {
+  uint32_t fixed = FixedWidth(type);
+  if (fixed != 0) {
+    char buf[8];
+    EncodeFixed(type, val, buf);
+    out->append(buf, fixed);
+    return;
+  }
+  EscapeString(val.GetAsString(), [out](char c) { out->push_back(c); });
+  out->push_back('\0');
+}
+
+} // namespace key_encoding
+} // namespace tetodb
@@ -68,10 +68,14 @@ public:
 
   // 5. Strings (Varchar)
   Value(TypeId type, std::string s)
-      : type_id_(type), is_null_(false), str_value_(std::move(s)) {}
+      : type_id_(type), is_null_(false), str_value_(std::move(s)) {
+    memset(&val_, 0, sizeof(Val));
+  }
 
   Value(TypeId type, const char *s)
-      : type_id_(type), is_null_(false), str_value_(s) {}
+      : type_id_(type), is_null_(false), str_value_(s) {
+    memset(&val_, 0, sizeof(Val));
+  }
 
   // --- Copy / Move Semantics ---
 
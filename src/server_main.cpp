@@ -6,33 +6,116 @@
 #include <filesystem>
 #include <iostream>
 #include <thread>
+#include <vector>
 
 using namespace tetodb;
 
 int main(int argc, char *argv[]) {
   std::string db_name = "mydb";
   int port = 5432;
+  InstanceOptions options;
 
-  // Parse command-line args: teto_main [db_name] [port]
-  if (argc >= 2)
-    db_name = argv[1];
-  if (argc >= 3)
-    port = std::stoi(argv[2]);
+  // Parse command-line args:
+  //   teto_main [--buffer-pool=<bytes>[KB|MB|GB] | --buffer-pool=<n>%]
+  //             [--buffer-pool-partitions=<n>]
+  //             [--io-engine=sync|io_uring] [--direct-io]
+  //             [--replacer=2q|clock] [--wal-buffers=<bytes>[KB|MB|GB]]
+  //             [--wal-compression] [--recovery-threads=<n>]
+  //             [db_name] [port]
+  std::vector<std::string> positional;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.rfind("--buffer-pool=", 0) == 0) {
+      try {
+        options.buffer_pool_frames = TetoDBInstance::ParseBufferPoolSize(
+            arg.substr(std::string("--buffer-pool=").size()));
+      } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+      }
+    } else if (arg.rfind("--buffer-pool-partitions=", 0) == 0) {
+      std::string value =
+          arg.substr(std::string("--buffer-pool-partitions=").size());
+      try {
+        options.buffer_pool_partitions = std::stoul(value);
+      } catch (const std::exception &) {
+        std::cerr << "Invalid buffer pool partition count '" << value
+                  << "'\n";
+        return 1;
+      }
+    } else if (arg.rfind("--wal-buffers=", 0) == 0) {
+      try {
+        options.log_buffer_size = TetoDBInstance::ParseWalBufferSize(
+            arg.substr(std::string("--wal-buffers=").size()));
+      } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+      }
+    } else if (arg.rfind("--recovery-threads=", 0) == 0) {
+      std::string value = arg.substr(std::string("--recovery-threads=").size());
+      try {
+        options.recovery_threads = std::stoul(value);
+      } catch (const std::exception &) {
+        std::cerr << "Invalid recovery thread count '" << value << "'\n";
+        return 1;
+      }
+      if (options.recovery_threads > MAX_RECOVERY_THREADS) {
+        std::cerr << "[SYSTEM] --recovery-threads capped at "
+                  << MAX_RECOVERY_THREADS << "\n";
+        options.recovery_threads = MAX_RECOVERY_THREADS;
+      }
+    } else if (arg == "--wal-compression") {
+      options.wal_compression = true;
+    } else if (arg == "--direct-io") {
+      options.direct_io = true;
+    } else if (arg.rfind("--replacer=", 0) == 0) {
+      std::string policy = arg.substr(std::string("--replacer=").size());
+      if (policy == "clock") {
+        options.replacer = ReplacerPolicy::CLOCK;
+      } else if (policy == "2q") {
+        options.replacer = ReplacerPolicy::TWO_QUEUE;
+      } else {
+        std::cerr << "Unknown replacer '" << policy
+                  << "' (expected 2q or clock)\n";
+        return 1;
+      }
+    } else if (arg.rfind("--io-engine=", 0) == 0) {
+      std::string engine = arg.substr(std::string("--io-engine=").size());
+      if (engine == "io_uring") {
+        options.io_engine = IoEngine::IO_URING;
+      } else if (engine == "sync") {
+        options.io_engine = IoEngine::SYNC;
+      } else {
+        std::cerr << "Unknown I/O engine '" << engine
+                  << "' (expected sync or io_uring)\n";
+        return 1;
+      }
+    } else {
+      positional.push_back(arg);
+    }
+  }
+  if (positional.size() >= 1)
+    db_name = positional[0];
+  if (positional.size() >= 2)
+    port = std::stoi(positional[1]);
 
   std::cout << "===================================================\n";
   std::cout << "             TETODB SERVER KERNEL\n";
   std::cout << "===================================================\n";
-  std::cout << "Database: " << db_name << "  |  Port: " << port << "\n\n";
+  std::cout << "Database: " << db_name << "  |  Port: " << port
+            << "  |  Buffer pool: "
+            << options.buffer_pool_frames * PAGE_SIZE / (1024 * 1024)
+            << " MB\n\n";
 
   try {
     // Create a dedicated directory for this database
     std::filesystem::path db_dir = "data_" + db_name;
     std::filesystem::create_directories(db_dir);
 
-    // All files go inside: data_<name>/<name>.db, .log, .freelist, .catalog
+    // All files go inside: data_<name>/<name>.db, .wal/, .freelist, .catalog
     std::string db_file = (db_dir / (db_name + ".db")).string();
 
-    TetoDBInstance db(db_file);
+    TetoDBInstance db(db_file, options);
     TcpServer server(&db, port);
 
     server.Start();
@@ -15,9 +15,9 @@ protected:
     if (std::filesystem::exists(data_dir)) {
       std::filesystem::remove_all(data_dir);
     }
-    for (auto &ext : {".catalog", ".log"}) {
+    for (auto &ext : {".catalog", ".wal"}) {
       auto f = std::filesystem::path("test_savepoint" + std::string(ext));
-      if (std::filesystem::exists(f)) std::filesystem::remove(f);
+      if (std::filesystem::exists(f)) std::filesystem::remove_all(f);
     }
     db_ = std::make_unique<TetoDBInstance>(TEST_DB);
   }
@@ -28,9 +28,9 @@ protected:
     if (std::filesystem::exists(data_dir)) {
       std::filesystem::remove_all(data_dir);
     }
-    for (auto &ext : {".catalog", ".log"}) {
+    for (auto &ext : {".catalog", ".wal"}) {
       auto f = std::filesystem::path("test_savepoint" + std::string(ext));
-      if (std::filesystem::exists(f)) std::filesystem::remove(f);
+      if (std::filesystem::exists(f)) std::filesystem::remove_all(f);
     }
   }
 